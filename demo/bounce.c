@@ -121,7 +121,7 @@ list_t *make_star(size_t num_corners, double corner_base_len,
 }
 
 typedef struct state {
-  list_t *star;
+  polygon_t *star;
   vector_t vel;
 } state_t;
 
@@ -137,18 +137,19 @@ vector_t check_collision(state_t *state) {
   int dpixel = 5; // number of pixels to shift star into boundaries if collided
 
   for (size_t i = 0; i < NUM_CORNERS; i++) {
-    vector_t *p = list_get(state->star, 2 * i + 1); // star corner point
+    // star corner point
+    vector_t *p = &polygon_vertices(state->star)[2 * i + 1];
 
     // Check if star is too far left or too far right, if so shift polygon into
     // boundaries and signal to flip x velocity
     if (p->x <= 0) {
       vector_t translation = {-p->x + dpixel, 0};
-      polygon_translate(state->star, translation);
+      polygon_translate_packed(state->star, translation);
 
       flip.x = 1;
     } else if (p->x >= WINDOW.x) {
       vector_t translation = {WINDOW.x - p->x - dpixel, 0};
-      polygon_translate(state->star, translation);
+      polygon_translate_packed(state->star, translation);
 
       flip.x = 1;
     }
@@ -156,12 +157,12 @@ vector_t check_collision(state_t *state) {
     // Do the same to the y-axis
     if (p->y <= 0) {
       vector_t translation = {0, -p->y + dpixel};
-      polygon_translate(state->star, translation);
+      polygon_translate_packed(state->star, translation);
 
       flip.y = 1;
     } else if (p->y >= WINDOW.y) {
       vector_t translation = {0, WINDOW.y - p->y - dpixel};
-      polygon_translate(state->star, translation);
+      polygon_translate_packed(state->star, translation);
 
       flip.y = 1;
     }
@@ -188,17 +189,22 @@ state_t *emscripten_init() {
     // manually
     double proportional_height_len =
         BASE_LEN * tan(deg_to_rad(360 / NUM_CORNERS)) / 2;
-    state->star = make_star(NUM_CORNERS, BASE_LEN, proportional_height_len);
+    list_t *star = make_star(NUM_CORNERS, BASE_LEN, proportional_height_len);
+    state->star = polygon_from_list(star);
+    list_free(star);
   } else {
-    state->star = make_star(NUM_CORNERS, BASE_LEN, HEIGHT_LEN);
+    list_t *star = make_star(NUM_CORNERS, BASE_LEN, HEIGHT_LEN);
+    state->star = polygon_from_list(star);
+    list_free(star);
   }
 
   // Set the state
   state->vel = (vector_t){-1, 2};
 
   // Translate and initial position and rotate to initial angle
-  polygon_translate(state->star, INITIAL_POS);
-  polygon_rotate(state->star, INITIAL_ANGLE, polygon_centroid(state->star));
+  polygon_translate_packed(state->star, INITIAL_POS);
+  polygon_rotate_packed(state->star, INITIAL_ANGLE,
+                        polygon_centroid_packed(state->star));
 
   return state;
 }
@@ -220,8 +226,9 @@ void emscripten_main(state_t *state) {
   double rotation = deg_to_rad(ANG_VEL) * time_factor;
 
   // translate_star(state, translation);
-  polygon_translate(state->star, translation);
-  polygon_rotate(state->star, rotation, polygon_centroid(state->star));
+  polygon_translate_packed(state->star, translation);
+  polygon_rotate_packed(state->star, rotation,
+                        polygon_centroid_packed(state->star));
 
   vector_t flip = check_collision(state);
 
@@ -240,6 +247,6 @@ void emscripten_main(state_t *state) {
  * Free memory allocated to the state and contents within.
  */
 void emscripten_free(state_t *state) {
-  list_free(state->star);
-  free(state->star);
+  polygon_free(state->star);
+  free(state);
 }
\ No newline at end of file
@@ -85,20 +85,18 @@ double deg_to_rad(double deg) { return deg * M_PI / 180; }
 /**
  * Create a brick shaped object to be drawn to the screen.
  *
+ * @param brick_shape the shape of every brick, which is copied
  * @param initial_pos initial position for the brick
  * @param brick_color color of the brick
  * @return a pointer to the body at the brickcolor
  */
 
-body_t *make_brick_body(vector_t initial_pos, rgb_color_t brick_color) {
-  double brick_width = WINDOW.x / ARRAY_BRICKS.x - BRICK_SPACE;
-
-  // Initialize the brick shape
-  list_t *brick_shape = make_rect_shape(brick_width, BRICK_HEIGHT);
-
+body_t *make_brick_body(polygon_t *brick_shape, vector_t initial_pos,
+                        rgb_color_t brick_color) {
   // Initialize body
-  body_t *brick_body = body_init_with_info(brick_shape, BRICK_MASS, brick_color,
-                                           make_type_info(BRICK), free);
+  body_t *brick_body = body_init_with_polygon(
+      polygon_copy(brick_shape), BRICK_MASS, brick_color,
+      make_type_info(BRICK), free, NULL);
   body_set_centroid(brick_body, initial_pos);
 
   return brick_body;
@@ -279,6 +277,9 @@ void add_bricks(scene_t *scene) {
   vector_t spawn_window = {WINDOW.x / ARRAY_BRICKS.x,
                            BRICK_HEIGHT + BRICK_SPACE};
   double dh = TOTAL_CIRCLE_ANGLE / ARRAY_BRICKS.x;
+  // Every brick is a copy of one shape, so its centroid is only computed once
+  double brick_width = WINDOW.x / ARRAY_BRICKS.x - BRICK_SPACE;
+  polygon_t *brick_shape = make_rect_polygon(brick_width, BRICK_HEIGHT);
   for (size_t c = 0; c < ARRAY_BRICKS.x; c++) {
     double h = c * dh;
     rgb_color_t color = hsv_to_rgb(h, 1, 1);
@@ -286,9 +287,10 @@ void add_bricks(scene_t *scene) {
       vector_t initial_pos = {c * spawn_window.x + spawn_window.x / 2,
                               WINDOW.y -
                                   (r * spawn_window.y + spawn_window.y / 2)};
-      scene_add_body(scene, make_brick_body(initial_pos, color));
+      scene_add_body(scene, make_brick_body(brick_shape, initial_pos, color));
     }
   }
+  polygon_free(brick_shape);
 }
 
 /**
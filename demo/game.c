@@ -3,16 +3,21 @@
 #include "../include/collision.h"
 #include "../include/connection.h"
 #include "../include/forces.h"
+#include "../include/input_journal.h"
+#include "../include/level.h"
 #include "../include/platform.h"
 #include "../include/polygon.h"
 #include "../include/portal.h"
 #include "../include/scene.h"
 #include "../include/sdl_wrapper.h"
 #include "../include/shapes.h"
+#include <assert.h>
 #include <emscripten.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 
 // Window constants
 const vector_t WINDOW = (vector_t){.x = 1024, .y = 704};
@@ -25,6 +30,10 @@ const size_t GAME_WON_SCREEN_IDX = 7;
 const size_t LEVEL_SCREEN_IDX = 8;
 const size_t RULES_SCREEN_IDX = 9;
 
+// Physics steps at a fixed rate, however long each frame takes
+const double PHYSICS_DT = 1.0 / 60;
+const size_t MAX_PHYSICS_SUBSTEPS = 8;
+
 // Wall constants
 const double WALL_THICKNESS = 64;
 const rgb_color_t WALL_COLOR = {0.75, 0.75, 0.75};
@@ -111,17 +120,44 @@ const bool USE_PORTAL_IMAGES = false;
 const char *PORTAL_GUN_SOUND_PATH = "assets/sounds/portal_gun.wav";
 const char *BACKGROUND_MUSIC_FILE_PATH = "assets/sounds/background_music.wav";
 
-// Gravitaion constants
-// g: 983 m/s^2
-const double G = 6.67E-9; // N m^2 / kg^2
-const double M = 6E24;    // kg
-const double R = 6.38E6;  // m
+// The layout of each playable level, as text or binary level files
+const char *LEVEL_PATH_FORMAT = "assets/levels/level_%zu.lvl";
+
+// Environment variables naming a file to record the input to,
+// or to play input back from with no window or sound
+const char *RECORD_ENV_VAR = "GAME_RECORD";
+const char *REPLAY_ENV_VAR = "GAME_REPLAY";
+
+// Acceleration due to gravity, in px / s^2
+const vector_t GRAVITY_ACCEL = {0, -983.2};
+
+/**
+ * What a level looked like right after it was built,
+ * so that restarting it only has to copy these values back.
+ */
+typedef struct level_start {
+  scene_snapshot_t *scene;
+  double timer;
+  image_t *player_image;
+  // Whether each portal had been placed, and which way it faced
+  bool has_portal1;
+  bool has_portal2;
+  vector_t portal1_direction;
+  vector_t portal2_direction;
+  // One value per entry of the state's lists, in the same order
+  double *platform_motion_times;
+  bool *platforms_moving;
+  double *button_motion_times;
+  bool *boxes_connected;
+} level_start_t;
 
 /**
  * A struct to represent the current state of the program.
  */
 typedef struct state {
   list_t *scenes;
+  // The layout of each playable level, read once at startup
+  list_t *levels;
 
   size_t curr_level;
 
@@ -138,8 +174,8 @@ typedef struct state {
   portal_t *portal1;
   portal_t *portal2;
 
-  SDL_Texture *player_left_image;
-  SDL_Texture *player_right_image;
+  image_t *player_left_image;
+  image_t *player_right_image;
 
   vector_t mouse_pos;
 
@@ -152,6 +188,18 @@ typedef struct state {
 
   double timer;
   double last_time;
+
+  // Set while a level is being played
+  level_start_t *level_start;
+
+  // The number of frames run so far
+  uint32_t frame;
+  // At most one of these is set, if input is being recorded or replayed
+  input_recorder_t *recorder;
+  input_player_t *player;
+  // Draws nothing while replaying
+  render_backend_t *headless_backend;
+  clock_t replay_start;
 } state_t;
 
 // -----------------------  HELPER FUNCTIONS  -----------------------
@@ -167,6 +215,7 @@ scene_t *get_curr_scene(state_t *state) {
 }
 
 void init_new_level(state_t *state);
+void restart_level(state_t *state);
 
 /**
  * Checks if the current level has ended. If so, go to next level/screen.
@@ -176,7 +225,7 @@ void init_new_level(state_t *state);
 void check_end_level(state_t *state) {
   // Check if out of time, if so restart level
   if (state->timer <= 0) {
-    init_new_level(state);
+    restart_level(state);
     return;
   }
 
@@ -193,7 +242,7 @@ void check_end_level(state_t *state) {
 
   // Reset level if fall out of screen
   if (player_centroid.y <= 0) {
-    init_new_level(state);
+    restart_level(state);
   }
 
   // Check if inside exit box
@@ -245,14 +294,140 @@ void rotate_portal_gun(state_t *state) {
  */
 void display_timer(state_t *state) {
   if (trunc(state->timer) != state->last_time) {
-    // Generate text texture
+    // Draw the text from the font's cached glyphs
     char timer_text[50];
     sprintf(timer_text, "Time left: %d", (int)state->timer);
-    SDL_Texture *timer_texture =
-        sdl_load_text(timer_text, TIMER_COLOR, TIMER_FONT_PATH, TIMER_FONTSIZE);
+    font_t *timer_font = sdl_get_font(TIMER_FONT_PATH, TIMER_FONTSIZE);
+    body_set_label(state->timer_body, timer_text, timer_font, TIMER_COLOR);
+    state->last_time = trunc(state->timer);
+  }
+}
+
+/**
+ * Releases the memory allocated for a level's starting state.
+ *
+ * @param level_start a pointer to a level start
+ */
+void level_start_free(level_start_t *level_start) {
+  scene_snapshot_free(level_start->scene);
+  free(level_start->platform_motion_times);
+  free(level_start->platforms_moving);
+  free(level_start->button_motion_times);
+  free(level_start->boxes_connected);
+  free(level_start);
+}
 
-    body_set_text(state->timer_body, timer_texture);
+/**
+ * Saves the state of the level that was just built,
+ * so restart_level() can return to it.
+ *
+ * @param state a pointer to a state
+ */
+void save_level_start(state_t *state) {
+  level_start_t *start = malloc(sizeof(level_start_t));
+  assert(start);
+  size_t num_platforms = list_size(state->platforms);
+  size_t num_buttons = list_size(state->buttons);
+  size_t num_boxes = list_size(state->box_connections);
+  *start = (level_start_t){
+      .scene = scene_snapshot(get_curr_scene(state)),
+      .timer = state->timer,
+      .player_image = body_get_image(state->player_body),
+      .has_portal1 = state->portal1 != NULL,
+      .has_portal2 = state->portal2 != NULL,
+      .platform_motion_times = malloc(num_platforms * sizeof(double)),
+      .platforms_moving = malloc(num_platforms * sizeof(bool)),
+      .button_motion_times = malloc(num_buttons * sizeof(double)),
+      .boxes_connected = malloc(num_boxes * sizeof(bool))};
+  assert(start->platform_motion_times && start->platforms_moving);
+  assert(start->button_motion_times && start->boxes_connected);
+
+  if (state->portal1) {
+    start->portal1_direction = portal_get_direction(state->portal1);
+  }
+  if (state->portal2) {
+    start->portal2_direction = portal_get_direction(state->portal2);
   }
+  for (size_t i = 0; i < num_platforms; i++) {
+    platform_t *platform = list_get(state->platforms, i);
+    start->platform_motion_times[i] = platform_get_motion_time(platform);
+    start->platforms_moving[i] = platform_get_is_moving(platform);
+  }
+  for (size_t i = 0; i < num_buttons; i++) {
+    start->button_motion_times[i] =
+        button_get_motion_time(list_get(state->buttons, i));
+  }
+  for (size_t i = 0; i < num_boxes; i++) {
+    start->boxes_connected[i] =
+        connection_get_is_connected(list_get(state->box_connections, i));
+  }
+  state->level_start = start;
+}
+
+/**
+ * Puts a portal back the way it was at the start of a level.
+ * A portal placed since then has already lost its body,
+ * so it is released.
+ *
+ * @param portal a pointer to the state's pointer to the portal
+ * @param existed whether the portal had been placed at the start
+ * @param direction the direction the portal faced at the start
+ */
+void restore_portal(portal_t **portal, bool existed, vector_t direction) {
+  if (!*portal) {
+    return;
+  }
+  if (existed) {
+    portal_set_direction(*portal, direction);
+  } else {
+    portal_free(*portal);
+    *portal = NULL;
+  }
+}
+
+/**
+ * Restarts the current level. The level's bodies and objects are put back
+ * the way they were when it was built, which is much cheaper than
+ * building it again. If that is impossible (because a body the level
+ * started with has been freed), the level is built again instead.
+ *
+ * @param state a pointer to a state
+ */
+void restart_level(state_t *state) {
+  level_start_t *start = state->level_start;
+  if (!start || !scene_restore(get_curr_scene(state), start->scene)) {
+    init_new_level(state);
+    return;
+  }
+
+  restore_portal(&state->portal1, start->has_portal1,
+                 start->portal1_direction);
+  restore_portal(&state->portal2, start->has_portal2,
+                 start->portal2_direction);
+  for (size_t i = 0; i < list_size(state->platforms); i++) {
+    platform_t *platform = list_get(state->platforms, i);
+    platform_set_motion_time(platform, start->platform_motion_times[i]);
+    platform_change_is_moving(platform, start->platforms_moving[i]);
+  }
+  for (size_t i = 0; i < list_size(state->buttons); i++) {
+    button_set_motion_time(list_get(state->buttons, i),
+                           start->button_motion_times[i]);
+  }
+  for (size_t i = 0; i < list_size(state->box_connections); i++) {
+    connection_t *box_connection = list_get(state->box_connections, i);
+    if (connection_get_is_connected(box_connection) !=
+        start->boxes_connected[i]) {
+      connection_toggle(box_connection);
+    }
+  }
+
+  body_set_image(state->player_body, start->player_image);
+  state->portal_projectile_body = NULL;
+  *(state->is_jumping) = false;
+  *(state->is_player_teleporting) = false;
+  *(state->is_box_teleporting) = false;
+  state->timer = start->timer;
+  state->last_time = 0;
 }
 
 /**
@@ -263,6 +438,10 @@ void display_timer(state_t *state) {
 void reset_level(state_t *state) {
   // Reset scene
   scene_free(get_curr_scene(state));
+  if (state->level_start) {
+    level_start_free(state->level_start);
+    state->level_start = NULL;
+  }
 
   // Reset buttons
   if (state->buttons) {
@@ -299,6 +478,8 @@ void reset_level(state_t *state) {
 
   // Initialize values
   list_set(state->scenes, scene_init(), state->curr_level);
+  scene_set_fixed_timestep(get_curr_scene(state), PHYSICS_DT,
+                           MAX_PHYSICS_SUBSTEPS);
   state->player_body = NULL;
   state->exit_body = NULL;
   state->timer_body = NULL;
@@ -327,25 +508,19 @@ void reset_level(state_t *state) {
 bool is_colliding_with_other_bodies(state_t *state, body_t *portal_body) {
   scene_t *scene = get_curr_scene(state);
 
-  list_t *portal_shape = body_get_shape(portal_body);
-
   size_t num_collided_bodies = 0;
   for (size_t i = 0; i < scene_bodies(scene); i++) {
     body_t *body = scene_get_body(scene, i);
     if (body != portal_body) {
-      list_t *shape = body_get_shape(body);
-      if (find_collision(portal_shape, shape).collided) {
+      if (find_body_collision(portal_body, body).collided) {
         num_collided_bodies += 1;
       }
-      list_free(shape);
       if (num_collided_bodies > 3) { // allowed to collide with portal surface,
                                      // portal projectile, and background
-        list_free(portal_shape);
         return true;
       }
     }
   }
-  list_free(portal_shape);
 
   return false;
 }
@@ -369,7 +544,6 @@ void check_portal_projectile_collisions(state_t *state) {
   }
 
   body_t *portal_projectile_body = state->portal_projectile_body;
-  list_t *portal_projectile_shape = body_get_shape(portal_projectile_body);
 
   // Get the portal number
   size_t portal_num = 0;
@@ -383,9 +557,8 @@ void check_portal_projectile_collisions(state_t *state) {
     body_t *body = scene_get_body(scene, i);
 
     if (body != portal_projectile_body) {
-      list_t *shape = body_get_shape(body);
       collision_info_t collision_info =
-          find_collision(shape, portal_projectile_shape);
+          find_body_collision(body, portal_projectile_body);
 
       if (collision_info.collided) {
         if (get_type(body) == PORTAL_SURFACE) {
@@ -415,10 +588,8 @@ void check_portal_projectile_collisions(state_t *state) {
           state->portal_projectile_body = NULL;
         }
       }
-      list_free(shape);
     }
   }
-  list_free(portal_projectile_shape);
 }
 
 /**
@@ -442,14 +613,17 @@ void restrict_player_speed(state_t *state) {
 }
 
 /**
- * Executes a tick of every body, portal, platfor
- * in a scene over a small time interval.
+ * Runs the game logic that has to keep pace with the physics:
+ * teleporting through portals, moving platforms, pressing buttons
+ * and counting down the timer.
+ * Called by scene_advance() before every physics tick, so it always sees
+ * the fixed tick length and a fast body can't skip over a thin portal.
  *
- * @param state a pointer to a state
- * @param dt the number of seconds elapsed since the last tick
+ * @param aux a pointer to a state
+ * @param dt the length of the coming physics tick, in seconds
  */
-void tick_all(state_t *state, double dt) {
-  scene_t *scene = get_curr_scene(state);
+void step_game_logic(void *aux, double dt) {
+  state_t *state = aux;
   portal_t *portal1 = state->portal1;
   portal_t *portal2 = state->portal2;
   body_t *player_body = state->player_body;
@@ -497,11 +671,20 @@ void tick_all(state_t *state, double dt) {
   }
   list_free(pressing_bodies);
 
-  // Scene
-  scene_tick(scene, dt);
-
   // Decrement timer
   state->timer -= dt;
+}
+
+/**
+ * Advances the current level by one frame: steps the game logic and
+ * the physics in fixed ticks (see step_game_logic()),
+ * then updates what only depends on the frame being drawn.
+ *
+ * @param state a pointer to a state
+ * @param dt the number of seconds elapsed since the last frame
+ */
+void tick_all(state_t *state, double dt) {
+  scene_advance(get_curr_scene(state), dt, step_game_logic, state);
 
   // Rotate portal gun
   if (state->portal_gun_connection) {
@@ -573,22 +756,27 @@ void create_stick_force(scene_t *scene, connection_t *connection) {
 // -----------------------  ADD BODIES  -----------------------
 
 /**
- * Adds a body to a scene that applied a gravitational force to each other body.
+ * Determines whether gravity acts on a body.
+ * Only the player and boxes fall; projectiles and the gun move on their own.
+ *
+ * @param body a pointer to a body
+ * @return whether the body should be pulled down by gravity
+ */
+bool is_affected_by_gravity(body_t *body) {
+  body_type_t type = get_type(body);
+  return type == PLAYER || type == BOX;
+}
+
+/**
+ * Adds a uniform gravitational field to a scene.
+ * Must be added before the player and boxes, so that their normal forces
+ * see the gravitational force.
  *
  * @param state a pointer to a state
  */
-void add_gravity_body(state_t *state) {
+void add_gravity(state_t *state) {
   scene_t *scene = get_curr_scene(state);
-
-  // Will be offscreen, so shape is irrelevant
-  list_t *gravity_ball = make_rect_shape(1, 1);
-  body_t *body = body_init_with_info(gravity_ball, M, WALL_COLOR,
-                                     make_type_info(GRAVITY), free);
-
-  // Move a distance R below the scene
-  vector_t gravity_center = {CENTER.x, -R};
-  body_set_centroid(body, gravity_center);
-  scene_add_body(scene, body);
+  create_filtered_uniform_field(scene, GRAVITY_ACCEL, is_affected_by_gravity);
 }
 
 /**
@@ -635,9 +823,6 @@ void add_player_body(state_t *state, vector_t player_initial_pos) {
       player_shape, PLAYER_MASS, PLAYER_COLOR, make_type_info(PLAYER), free);
   body_set_centroid(player_body, player_initial_pos);
 
-  state->player_left_image = sdl_load_image(PLAYER_LEFT_IMG_PATH);
-  state->player_right_image = sdl_load_image(PLAYER_RIGHT_IMG_PATH);
- 
   // Add force creators with other bodies
   for (size_t i = 0; i < scene_bodies(scene); i++) {
     body_t *body = scene_get_body(scene, i);
@@ -655,9 +840,6 @@ void add_player_body(state_t *state, vector_t player_initial_pos) {
       create_jump_force(scene, PLAYER_JUMP_SPEED, player_body, body,
                         state->is_jumping);
       break;
-    case GRAVITY:
-      create_newtonian_gravity(scene, G, player_body, body);
-      break;
     case JUMPABLE:
       create_physics_collision(scene, JUMPABLE_ELASTICITY, body, player_body);
       create_normal_force(scene, player_body, body, NULL);
@@ -899,9 +1081,6 @@ void add_box(state_t *state, vector_t pos) {
                                       state->is_box_teleporting);
       create_normal_force(scene, box_body, body, state->is_box_teleporting);
       break;
-    case GRAVITY:
-      create_newtonian_gravity(scene, G, box_body, body);
-      break;
     case JUMPABLE:
       create_physics_collision(scene, JUMPABLE_ELASTICITY, body, box_body);
       create_normal_force(scene, box_body, body, NULL);
@@ -1025,7 +1204,7 @@ void add_portal_surfaces(state_t *state, size_t n, vector_t positions[],
  * @param state a pointer to a state
  * @param image_path a pointer to an image path containing the background
  */
-void add_background(state_t *state, char *image_path) {
+void add_background(state_t *state, const char *image_path) {
   scene_t *scene = get_curr_scene(state);
 
   list_t *shape = make_rect_shape(WINDOW.x, WINDOW.y);
@@ -1064,7 +1243,7 @@ void start_screen_init(state_t *state) {
 void start_screen_main(state_t *state, double dt) {
   scene_t *scene = get_curr_scene(state);
   scene_tick(scene, dt);
-  sdl_render_scene(scene);
+  render_scene(scene);
 }
 
 // -------------------  GAME WON SCREEN  -------------------
@@ -1094,7 +1273,7 @@ void game_won_screen_init(state_t *state) {
 void game_won_screen_main(state_t *state, double dt) {
   scene_t *scene = get_curr_scene(state);
   scene_tick(scene, dt);
-  sdl_render_scene(scene);
+  render_scene(scene);
 }
 
 // -------------------  LEVEL SCREEN  -------------------
@@ -1123,7 +1302,7 @@ void level_screen_init(state_t *state) {
 void level_screen_main(state_t *state, double dt) {
   scene_t *scene = get_curr_scene(state);
   scene_tick(scene, dt);
-  sdl_render_scene(scene);
+  render_scene(scene);
 }
 
 // -------------------  RULES SCREEN  -------------------
@@ -1153,742 +1332,182 @@ void rules_screen_init(state_t *state) {
 void rules_screen_main(state_t *state, double dt) {
   scene_t *scene = get_curr_scene(state);
   scene_tick(scene, dt);
-  sdl_render_scene(scene);
+  render_scene(scene);
 }
 
-// -----------------------  LEVEL 0  -----------------------
+// -----------------------  LEVELS  -----------------------
 
 /**
- * Adds all of the physical platforms to level 0
+ * Gets a vector from two consecutive values of a level record.
  *
- * @param state a pointer to a state
+ * @param values a pointer to the x value, followed by the y value
+ * @return the vector
  */
-void add_level_0_platforms(state_t *state) {
-  scene_t *scene = get_curr_scene(state);
-
-  size_t num_platforms = 2;
-
-  vector_t platform_positions[num_platforms];
-  platform_positions[0] = (vector_t){448, 416};
-  platform_positions[1] = (vector_t){576, 392};
-
-  float platform_motion_times[num_platforms];
-  platform_motion_times[0] = 2;
-  platform_motion_times[1] = 2;
-
-  float platform_rotations[num_platforms];
-  platform_rotations[0] = deg_to_rad(-25);
-  platform_rotations[1] = 0;
-
-  vector_t platform_translations[num_platforms];
-  platform_translations[0] = (vector_t){38, 23};
-  platform_translations[1] = (vector_t){0, 48};
-
-  vector_t platform_points_of_rotations[num_platforms];
-  platform_points_of_rotations[0] = (vector_t){447, 340};
-  platform_points_of_rotations[1] = (vector_t){598, 340};
-
-  for (size_t i = 0; i < num_platforms; i++) {
-    vector_t platform_pos = platform_positions[i];
-    float platform_motion_time = platform_motion_times[i];
-    float platform_rotation = platform_rotations[i];
-    vector_t platform_translation = platform_translations[i];
-    vector_t platform_points_of_rotation = platform_points_of_rotations[i];
-
-    body_t *platform_body = body_init_with_info(
-        make_rect_shape(PLATFORM_DIMS.x, PLATFORM_DIMS.y), INFINITY,
-        PLATFORM_COLOR, make_type_info(PLATFORM), free);
-    body_set_centroid(platform_body, platform_pos);
-    body_set_rotation(platform_body, platform_rotation);
-    scene_add_body(scene, platform_body);
-
-    platform_t *platform =
-        platform_init(platform_body, platform_motion_time, -platform_rotation,
-                      platform_translation, platform_points_of_rotation);
-    list_add(state->platforms, platform);
-  }
-}
-
-/**
- * Initializes the scene and level layout for level 0.
- *
- * @param state a pointer to a state
- */
-void level_0_init(state_t *state) {
-  state->timer = 60;
-  reset_level(state);
-  state->is_portal_restricted = false;
-
-  vector_t player_initial_pos = {100, PLAYER_DIMS.y / 2 + WALL_THICKNESS};
-
-  vector_t portal1_pos = {WINDOW.x - PORTAL_DIMS.x / 2 - WALL_THICKNESS,
-                          PORTAL_DIMS.y / 2 + WALL_THICKNESS};
-  vector_t portal2_pos = {PORTAL_DIMS.x / 2 + WALL_THICKNESS,
-                          PORTAL_DIMS.y / 2 + 7 * 64};
-  vector_t portal1_dir = {-1, 0};
-  vector_t portal2_dir = {1, 0};
-
-  vector_t box_pos = {224, 7 * 64 + BOX_DIMS.y / 2};
-
-  vector_t button_pos = {CENTER.x, WALL_THICKNESS};
-
-  vector_t exit_pos = {WINDOW.x - 2 * 64 - EXIT_BOX_DIMS.x / 2,
-                       WINDOW.y - 3 * 64 - EXIT_BOX_DIMS.y / 2};
-
-  size_t num_walls = 7;
-  vector_t wall_positions[num_walls];
-  wall_positions[0] = (vector_t){32.0, 624.0};
-  wall_positions[1] = (vector_t){24.0, 496.0};
-  wall_positions[2] = (vector_t){32.0, 224.0};
-  wall_positions[3] = (vector_t){992.0, 32.0};
-  wall_positions[4] = (vector_t){1000.0, 112.0};
-  wall_positions[5] = (vector_t){992.0, 432.0};
-  wall_positions[6] = (vector_t){512.0, 672.0};
-  vector_t wall_dims[num_walls];
-  wall_dims[0] = (vector_t){64.0, 160.0};
-  wall_dims[1] = (vector_t){48.0, 96.0};
-  wall_dims[2] = (vector_t){64.0, 448.0};
-  wall_dims[3] = (vector_t){64.0, 64.0};
-  wall_dims[4] = (vector_t){48.0, 96.0};
-  wall_dims[5] = (vector_t){64.0, 544.0};
-  wall_dims[6] = (vector_t){896.0, 64.0};
-
-  size_t num_standing_surfaces = 6;
-  vector_t standing_surface_positions[num_standing_surfaces];
-  standing_surface_positions[0] = (vector_t){224.0, 416.0};
-  standing_surface_positions[1] = (vector_t){352.0, 352.0};
-  standing_surface_positions[2] = (vector_t){512.0, 288.0};
-  standing_surface_positions[3] = (vector_t){672.0, 352.0};
-  standing_surface_positions[4] = (vector_t){800.0, 416.0};
-  standing_surface_positions[5] = (vector_t){512.0, 32.0};
-  vector_t standing_surface_dims[num_standing_surfaces];
-  standing_surface_dims[0] = (vector_t){320.0, 64.0};
-  standing_surface_dims[1] = (vector_t){64.0, 64.0};
-  standing_surface_dims[2] = (vector_t){384.0, 64.0};
-  standing_surface_dims[3] = (vector_t){64.0, 64.0};
-  standing_surface_dims[4] = (vector_t){320.0, 64.0};
-  standing_surface_dims[5] = (vector_t){896.0, 64.0};
-
-  size_t num_portal_surfaces = 2;
-  vector_t portal_surface_positions[num_portal_surfaces];
-  portal_surface_positions[0] = (vector_t){56.0, 496.0};
-  portal_surface_positions[1] = (vector_t){968.0, 112.0};
-  vector_t portal_surface_dims[num_portal_surfaces];
-  portal_surface_dims[0] = (vector_t){16.0, 96.0};
-  portal_surface_dims[1] = (vector_t){16.0, 96.0};
-
-  char *bg_filepath = "assets/images/level_0.png";
-  add_background(state, bg_filepath);
-
-  add_gravity_body(state);
-  add_walls(state, num_walls, wall_positions, wall_dims, false);
-  add_portal(state, portal1_pos, portal1_dir, 1);
-  add_portal(state, portal2_pos, portal2_dir, 2);
-  add_level_exit(state, exit_pos, false);
-  add_standing_surfaces(state, num_standing_surfaces,
-                        standing_surface_positions, standing_surface_dims,
-                        false);
-  add_portal_surfaces(state, num_portal_surfaces, portal_surface_positions,
-                      portal_surface_dims, false);
-  add_level_0_platforms(state);
-
-  list_t *button_platforms = list_init(2, NULL);
-  list_add(button_platforms, list_get(state->platforms, 0));
-  list_add(button_platforms, list_get(state->platforms, 1));
-  add_button(state, button_pos, button_platforms);
-
-  add_player_body(state, player_initial_pos);
-  body_set_image(state->player_body, state->player_right_image);
-  add_box(state, box_pos);
-
-  add_timer(state, false);
+vector_t level_vector(const double *values) {
+  return (vector_t){values[0], values[1]};
 }
 
 /**
- * Run level 0.
+ * Adds a platform that moves when a button is pressed to a scene.
  *
  * @param state a pointer to a state
+ * @param pos a vector corresponding to the platform's centroid
+ * @param rotation the angle the platform starts at, in radians
+ * @param motion_time the number of seconds the platform takes to move
+ * @param translation how far the platform moves
+ * @param point_of_rotation the point the platform turns back to level around
  */
-void level_0_main(state_t *state, double dt) {
-  display_timer(state);
-  tick_all(state, dt);
-
+void add_platform(state_t *state, vector_t pos, double rotation,
+                  double motion_time, vector_t translation,
+                  vector_t point_of_rotation) {
   scene_t *scene = get_curr_scene(state);
 
-  sdl_render_scene(scene);
-}
+  body_t *platform_body = body_init_with_info(
+      make_rect_shape(PLATFORM_DIMS.x, PLATFORM_DIMS.y), INFINITY,
+      PLATFORM_COLOR, make_type_info(PLATFORM), free);
+  body_set_centroid(platform_body, pos);
+  body_set_rotation(platform_body, rotation);
+  scene_add_body(scene, platform_body);
 
-// -----------------------  LEVEL 1  -----------------------
-/**
- * Initializes the scene and level layout for level 1
- *
- * @param state a pointer to a state
- */
-void level_1_init(state_t *state) {
-  reset_level(state);
-  state->timer = 60;
-  state->is_portal_restricted = false;
-
-  vector_t player_initial_pos = {2 * 64, 4 * 64 + PLAYER_DIMS.y / 2};
-
-  vector_t exit_pos = {384, 544};
-
-  size_t num_walls = 9;
-  vector_t wall_positions[num_walls];
-  wall_positions[0] = (vector_t){160.0, 672.0};
-  wall_positions[1] = (vector_t){24.0, 448.0};
-  wall_positions[2] = (vector_t){32.0, 128.0};
-  wall_positions[3] = (vector_t){992.0, 32.0};
-  wall_positions[4] = (vector_t){1000.0, 160.0};
-  wall_positions[5] = (vector_t){992.0, 288.0};
-  wall_positions[6] = (vector_t){1000.0, 480.0};
-  wall_positions[7] = (vector_t){992.0, 672.0};
-  wall_positions[8] = (vector_t){720.0, 680.0};
-  vector_t wall_dims[num_walls];
-  wall_dims[0] = (vector_t){320.0, 64.0};
-  wall_dims[1] = (vector_t){48.0, 384.0};
-  wall_dims[2] = (vector_t){64.0, 256.0};
-  wall_dims[3] = (vector_t){64.0, 64.0};
-  wall_dims[4] = (vector_t){48.0, 192.0};
-  wall_dims[5] = (vector_t){64.0, 64.0};
-  wall_dims[6] = (vector_t){48.0, 320.0};
-  wall_dims[7] = (vector_t){64.0, 64.0};
-  wall_dims[8] = (vector_t){480.0, 48.0};
-
-  size_t num_standing_surfaces = 5;
-  vector_t standing_surface_positions[num_standing_surfaces];
-  standing_surface_positions[0] = (vector_t){288.0, 544.0};
-  standing_surface_positions[1] = (vector_t){480.0, 480.0};
-  standing_surface_positions[2] = (vector_t){192.0, 160.0};
-  standing_surface_positions[3] = (vector_t){768.0, 288.0};
-  standing_surface_positions[4] = (vector_t){512.0, 32.0};
-  vector_t standing_surface_dims[num_standing_surfaces];
-  standing_surface_dims[0] = (vector_t){64.0, 192.0};
-  standing_surface_dims[1] = (vector_t){320.0, 64.0};
-  standing_surface_dims[2] = (vector_t){256.0, 192.0};
-  standing_surface_dims[3] = (vector_t){384.0, 64.0};
-  standing_surface_dims[4] = (vector_t){896.0, 64.0};
-
-  size_t num_portal_surfaces = 4;
-  vector_t portal_surface_positions[num_portal_surfaces];
-  portal_surface_positions[0] = (vector_t){56.0, 448.0};
-  portal_surface_positions[1] = (vector_t){720.0, 648.0};
-  portal_surface_positions[2] = (vector_t){968.0, 480.0};
-  portal_surface_positions[3] = (vector_t){968.0, 160.0};
-  vector_t portal_surface_dims[num_portal_surfaces];
-  portal_surface_dims[0] = (vector_t){16.0, 384.0};
-  portal_surface_dims[1] = (vector_t){480.0, 16.0};
-  portal_surface_dims[2] = (vector_t){16.0, 320.0};
-  portal_surface_dims[3] = (vector_t){16.0, 192.0};
-
-  char *bg_filepath = "assets/images/level_1.png";
-  add_background(state, bg_filepath);
-
-  add_gravity_body(state);
-  add_walls(state, num_walls, wall_positions, wall_dims, false);
-  add_level_exit(state, exit_pos, false);
-  add_standing_surfaces(state, num_standing_surfaces,
-                        standing_surface_positions, standing_surface_dims,
-                        false);
-  add_portal_surfaces(state, num_portal_surfaces, portal_surface_positions,
-                      portal_surface_dims, false);
-
-  add_player_body(state, player_initial_pos);
-  body_set_image(state->player_body, state->player_right_image);
-
-  add_timer(state, false);
-
-  add_portal_gun_body(state);
+  platform_t *platform = platform_init(platform_body, motion_time, -rotation,
+                                       translation, point_of_rotation);
+  list_add(state->platforms, platform);
 }
 
 /**
- * Runs level 1
+ * Adds a portal surface with any polygonal shape to a scene.
  *
  * @param state a pointer to a state
+ * @param centroid the point to move the surface's centroid to
+ * @param vertices the x and y coordinates of each vertex, one after the other
+ * @param num_vertices the number of vertices
  */
-void level_1_main(state_t *state, double dt) {
-  display_timer(state);
-  tick_all(state, dt);
-
-  scene_t *scene = get_curr_scene(state);
-  sdl_render_scene(scene);
-}
-
-// -----------------------  LEVEL 2  -----------------------
-
-/**
- * Initializes the scene and level layout for level 2
- *
- * @param state a pointer to a state
- */
-void level_2_init(state_t *state) {
-  reset_level(state);
-  state->timer = 60;
-  state->is_portal_restricted = false;
-
-  vector_t player_initial_pos = {2 * 64, 4 * 64 + PLAYER_DIMS.y / 2};
-
-  vector_t exit_pos = {768, 96};
-
-  size_t num_walls = 8;
-  vector_t wall_positions[num_walls];
-  wall_positions[0] = (vector_t){32.0, 688.0};
-  wall_positions[1] = (vector_t){24.0, 592.0};
-  wall_positions[2] = (vector_t){32.0, 480.0};
-  wall_positions[3] = (vector_t){24.0, 288.0};
-  wall_positions[4] = (vector_t){32.0, 64.0};
-  wall_positions[5] = (vector_t){992.0, 688.0};
-  wall_positions[6] = (vector_t){1000.0, 368.0};
-  wall_positions[7] = (vector_t){992.0, 32.0};
-  vector_t wall_dims[num_walls];
-  wall_dims[0] = (vector_t){64.0, 32.0};
-  wall_dims[1] = (vector_t){48.0, 160.0};
-  wall_dims[2] = (vector_t){64.0, 64.0};
-  wall_dims[3] = (vector_t){48.0, 320.0};
-  wall_dims[4] = (vector_t){64.0, 128.0};
-  wall_dims[5] = (vector_t){64.0, 32.0};
-  wall_dims[6] = (vector_t){48.0, 608.0};
-  wall_dims[7] = (vector_t){64.0, 64.0};
-
-  size_t num_standing_surfaces = 9;
-  vector_t standing_surface_positions[num_standing_surfaces];
-  standing_surface_positions[0] = (vector_t){128.0, 480.0};
-  standing_surface_positions[1] = (vector_t){192.0, 64.0};
-  standing_surface_positions[2] = (vector_t){608.0, 672.0};
-  standing_surface_positions[3] = (vector_t){608.0, 512.0};
-  standing_surface_positions[4] = (vector_t){736.0, 480.0};
-  standing_surface_positions[5] = (vector_t){808.0, 384.0};
-  standing_surface_positions[6] = (vector_t){736.0, 288.0};
-  standing_surface_positions[7] = (vector_t){672.0, 128.0};
-  standing_surface_positions[8] = (vector_t){832.0, 32.0};
-  vector_t standing_surface_dims[num_standing_surfaces];
-  standing_surface_dims[0] = (vector_t){128.0, 64.0};
-  standing_surface_dims[1] = (vector_t){256.0, 128.0};
-  standing_surface_dims[2] = (vector_t){64.0, 64.0};
-  standing_surface_dims[3] = (vector_t){64.0, 128.0};
-  standing_surface_dims[4] = (vector_t){192.0, 64.0};
-  standing_surface_dims[5] = (vector_t){48.0, 128.0};
-  standing_surface_dims[6] = (vector_t){192.0, 64.0};
-  standing_surface_dims[7] = (vector_t){64.0, 256.0};
-  standing_surface_dims[8] = (vector_t){256.0, 64.0};
-
-  size_t num_portal_surfaces = 4;
-  vector_t portal_surface_positions[num_portal_surfaces];
-  portal_surface_positions[0] = (vector_t){56.0, 592.0};
-  portal_surface_positions[1] = (vector_t){56.0, 288.0};
-  portal_surface_positions[2] = (vector_t){968.0, 368.0};
-  portal_surface_positions[3] = (vector_t){776.0, 384.0};
-  vector_t portal_surface_dims[num_portal_surfaces];
-  portal_surface_dims[0] = (vector_t){16.0, 160.0};
-  portal_surface_dims[1] = (vector_t){16.0, 320.0};
-  portal_surface_dims[2] = (vector_t){16.0, 608.0};
-  portal_surface_dims[3] = (vector_t){16.0, 128.0};
-
-  char *bg_filepath = "assets/images/level_2.png";
-  add_background(state, bg_filepath);
-
-  add_gravity_body(state);
-  add_walls(state, num_walls, wall_positions, wall_dims, false);
-  add_level_exit(state, exit_pos, false);
-  add_standing_surfaces(state, num_standing_surfaces,
-                        standing_surface_positions, standing_surface_dims,
-                        false);
-  add_portal_surfaces(state, num_portal_surfaces, portal_surface_positions,
-                      portal_surface_dims, false);
-
-  add_player_body(state, player_initial_pos);
-  body_set_image(state->player_body, state->player_right_image);
-
-  add_timer(state, false);
-
-  add_portal_gun_body(state);
+void add_polygon_portal_surface(state_t *state, vector_t centroid,
+                                const double *vertices, size_t num_vertices) {
+  list_t *shape = list_init(num_vertices, free);
+  for (size_t i = 0; i < num_vertices; i++) {
+    vector_t *v = malloc(sizeof(vector_t));
+    *v = level_vector(&vertices[2 * i]);
+    list_add(shape, v);
+  }
+  body_t *body = body_init_with_info(shape, INFINITY, PORTAL_SURFACE_COLOR,
+                                     make_type_info(PORTAL_SURFACE), free);
+  body_set_centroid(body, centroid);
+  body_set_visibility(body, false);
+  scene_add_body(get_curr_scene(state), body);
 }
 
 /**
- * Run level 2.
+ * Adds a button connected to platforms already in the level to a scene.
  *
  * @param state a pointer to a state
+ * @param pos a vector corresponding to the button's centroid
+ * @param platform_indices the indices in state->platforms of the platforms
+ * @param num_platforms the number of platforms
  */
-void level_2_main(state_t *state, double dt) {
-  display_timer(state);
-  tick_all(state, dt);
-
-  scene_t *scene = get_curr_scene(state);
-  sdl_render_scene(scene);
-}
-
-// -----------------------  LEVEL 3  -----------------------
-
-void add_level_3_platforms(state_t *state) {
-  scene_t *scene = get_curr_scene(state);
-
-  size_t num_platforms = 2;
-
-  vector_t platform_positions[num_platforms];
-  platform_positions[0] = (vector_t){648, 112};
-  platform_positions[1] = (vector_t){888, 112};
-
-  float platform_motion_times[num_platforms];
-  platform_motion_times[0] = 2;
-  platform_motion_times[1] = 2;
-
-  float platform_rotations[num_platforms];
-  platform_rotations[0] = deg_to_rad(-90);
-  platform_rotations[1] = deg_to_rad(90);
-
-  vector_t platform_translations[num_platforms];
-  platform_translations[0] = (vector_t){0, 0};
-  platform_translations[1] = (vector_t){0, 0};
-
-  vector_t platform_points_of_rotations[num_platforms];
-  platform_points_of_rotations[0] = (vector_t){640, 176};
-  platform_points_of_rotations[1] = (vector_t){896, 176};
-
+void add_level_button(state_t *state, vector_t pos,
+                      const double *platform_indices, size_t num_platforms) {
+  list_t *platforms = list_init(num_platforms, NULL);
   for (size_t i = 0; i < num_platforms; i++) {
-    vector_t platform_pos = platform_positions[i];
-    float platform_motion_time = platform_motion_times[i];
-    float platform_rotation = platform_rotations[i];
-    vector_t platform_translation = platform_translations[i];
-    vector_t platform_points_of_rotation = platform_points_of_rotations[i];
-
-    body_t *platform_body = body_init_with_info(
-        make_rect_shape(PLATFORM_DIMS.x, PLATFORM_DIMS.y), INFINITY,
-        PLATFORM_COLOR, make_type_info(PLATFORM), free);
-    body_set_centroid(platform_body, platform_pos);
-    body_set_rotation(platform_body, platform_rotation);
-    scene_add_body(scene, platform_body);
-
-    platform_t *platform =
-        platform_init(platform_body, platform_motion_time, -platform_rotation,
-                      platform_translation, platform_points_of_rotation);
-    list_add(state->platforms, platform);
+    list_add(platforms, list_get(state->platforms, platform_indices[i]));
   }
+  add_button(state, pos, platforms);
 }
 
 /**
- * Initializes the scene and level layout for level 3
+ * Builds the scene of a level from the records of its level file.
+ * The level art is drawn by the background image,
+ * so the bodies that make up the layout are hidden.
  *
  * @param state a pointer to a state
+ * @param level a pointer to the level's layout
  */
-void level_3_init(state_t *state) {
+void build_level(state_t *state, level_t *level) {
   reset_level(state);
-  state->timer = 60;
   state->is_portal_restricted = false;
 
-  vector_t player_initial_pos = {2 * 64, 4 * 64 + PLAYER_DIMS.y / 2};
-
-  vector_t exit_pos = {928, 224};
-
-  size_t num_walls = 9;
-  vector_t wall_positions[num_walls];
-  wall_positions[0] = (vector_t){32.0, 640.0};
-  wall_positions[1] = (vector_t){24.0, 496.0};
-  wall_positions[2] = (vector_t){32.0, 384.0};
-  wall_positions[3] = (vector_t){24.0, 272.0};
-  wall_positions[4] = (vector_t){32.0, 96.0};
-  wall_positions[5] = (vector_t){992.0, 64.0};
-  wall_positions[6] = (vector_t){992.0, 688.0};
-  wall_positions[7] = (vector_t){1000.0, 592.0};
-  wall_positions[8] = (vector_t){992.0, 480.0};
-  vector_t wall_dims[num_walls];
-  wall_dims[0] = (vector_t){64.0, 128.0};
-  wall_dims[1] = (vector_t){48.0, 160.0};
-  wall_dims[2] = (vector_t){64.0, 64.0};
-  wall_dims[3] = (vector_t){48.0, 160.0};
-  wall_dims[4] = (vector_t){64.0, 192.0};
-  wall_dims[5] = (vector_t){64.0, 128.0};
-  wall_dims[6] = (vector_t){64.0, 32.0};
-  wall_dims[7] = (vector_t){48.0, 160.0};
-  wall_dims[8] = (vector_t){64.0, 64.0};
-
-  size_t num_standing_surfaces = 4;
-  vector_t standing_surface_positions[num_standing_surfaces];
-  standing_surface_positions[0] = (vector_t){128.0, 384.0};
-  standing_surface_positions[1] = (vector_t){352.0, 96.0};
-  standing_surface_positions[2] = (vector_t){864.0, 480.0};
-  standing_surface_positions[3] = (vector_t){960.0, 160.0};
-  vector_t standing_surface_dims[num_standing_surfaces];
-  standing_surface_dims[0] = (vector_t){128.0, 64.0};
-  standing_surface_dims[1] = (vector_t){576.0, 192.0};
-  standing_surface_dims[2] = (vector_t){192.0, 64.0};
-  standing_surface_dims[3] = (vector_t){128.0, 64.0};
-
-  size_t num_portal_surfaces = 3;
-  vector_t portal_surface_positions[num_portal_surfaces];
-  portal_surface_positions[0] = (vector_t){56.0, 496.0};
-  portal_surface_positions[1] = (vector_t){56.0, 272.0};
-  portal_surface_positions[2] = (vector_t){968.0, 592.0};
-  vector_t portal_surface_dims[num_portal_surfaces];
-  portal_surface_dims[0] = (vector_t){16.0, 160.0};
-  portal_surface_dims[1] = (vector_t){16.0, 160.0};
-  portal_surface_dims[2] = (vector_t){16.0, 160.0};
-
-  vector_t box_1_pos = {144, 432};
-  vector_t box_2_pos = {848, 528};
-
-  vector_t button_1_pos = {256, 192};
-  vector_t button_2_pos = {512, 192};
-
-  char *bg_filepath = "assets/images/level_3.png";
-  add_background(state, bg_filepath);
-
-  add_gravity_body(state);
-  add_walls(state, num_walls, wall_positions, wall_dims, false);
-  add_level_exit(state, exit_pos, false);
-  add_standing_surfaces(state, num_standing_surfaces,
-                        standing_surface_positions, standing_surface_dims,
-                        false);
-  add_portal_surfaces(state, num_portal_surfaces, portal_surface_positions,
-                      portal_surface_dims, false);
-  add_level_3_platforms(state);
-
-  list_t *button_1_platforms = list_init(1, NULL);
-  list_add(button_1_platforms, list_get(state->platforms, 0));
-  list_t *button_2_platforms = list_init(1, NULL);
-  list_add(button_2_platforms, list_get(state->platforms, 1));
-  add_button(state, button_1_pos, button_1_platforms);
-  add_button(state, button_2_pos, button_2_platforms);
-
-  add_player_body(state, player_initial_pos);
-  body_set_image(state->player_body, state->player_right_image);
-
-  add_box(state, box_1_pos);
-  add_box(state, box_2_pos);
-
-  add_timer(state, false);
-
-  add_portal_gun_body(state);
-}
-
-/**
- * Run level 3
- *
- * @param state a pointer to a state
- */
-void level_3_main(state_t *state, double dt) {
-  display_timer(state);
-  tick_all(state, dt);
-
-  scene_t *scene = get_curr_scene(state);
-  sdl_render_scene(scene);
-}
-
-// -----------------------  LEVEL 4  -----------------------
-/**
- * Initializes the scene and level layout of level 4
- *
- * @param state a pointer to a state
- */
-void level_4_init(state_t *state) {
-  reset_level(state);
-  state->timer = 60;
-  state->is_portal_restricted = true;
-
-  vector_t player_initial_pos = {832, 3 * 64 + PLAYER_DIMS.y / 2};
-
-  vector_t exit_pos = {864, 416};
-
-  size_t num_walls = 3;
-  vector_t wall_positions[num_walls];
-  wall_positions[0] = (vector_t){32.0, 352.0};
-  wall_positions[1] = (vector_t){992.0, 352.0};
-  wall_positions[2] = (vector_t){832.0, 672.0};
-  vector_t wall_dims[num_walls];
-  wall_dims[0] = (vector_t){64.0, 704.0};
-  wall_dims[1] = (vector_t){64.0, 704.0};
-  wall_dims[2] = (vector_t){256.0, 64.0};
-
-  size_t num_standing_surfaces = 6;
-  vector_t standing_surface_positions[num_standing_surfaces];
-  standing_surface_positions[0] = (vector_t){312.0, 32.0};
-  standing_surface_positions[1] = (vector_t){808.0, 32.0};
-  standing_surface_positions[2] = (vector_t){832.0, 128.0};
-  standing_surface_positions[3] = (vector_t){832.0, 360.0};
-  standing_surface_positions[4] = (vector_t){416.0, 352.0};
-  standing_surface_positions[5] = (vector_t){608.0, 16.0};
-  vector_t standing_surface_dims[num_standing_surfaces];
-  standing_surface_dims[0] = (vector_t){496.0, 64.0};
-  standing_surface_dims[1] = (vector_t){304.0, 64.0};
-  standing_surface_dims[2] = (vector_t){256.0, 128.0};
-  standing_surface_dims[3] = (vector_t){256.0, 48.0};
-  standing_surface_dims[4] = (vector_t){192.0, 64.0};
-  standing_surface_dims[5] = (vector_t){96.0, 32.0};
-
-  size_t num_portal_surfaces = 2;
-  vector_t portal_surface_positions[num_portal_surfaces];
-  portal_surface_positions[0] = (vector_t){608.0, 48.0};
-  portal_surface_positions[1] = (vector_t){832.0, 328.0};
-  vector_t portal_surface_dims[num_portal_surfaces];
-  portal_surface_dims[0] = (vector_t){128, 32.0};
-  portal_surface_dims[1] = (vector_t){256.0, 16.0};
-
-  char *bg_filepath = "assets/images/level_4.png";
-  add_background(state, bg_filepath);
-
-  add_gravity_body(state);
-  add_walls(state, num_walls, wall_positions, wall_dims, false);
-  add_level_exit(state, exit_pos, false);
-  add_standing_surfaces(state, num_standing_surfaces,
-                        standing_surface_positions, standing_surface_dims,
-                        false);
-  add_portal_surfaces(state, num_portal_surfaces, portal_surface_positions,
-                      portal_surface_dims, false);
-
-  // Slanted shape on left of screen is a portal surface
-  list_t *slanted_shape = list_init(1, free);
-  vector_t *v;
-  v = calloc(1, sizeof(vector_t));
-  *v = (vector_t){64, 352};
-  list_add(slanted_shape, v);
-  v = calloc(1, sizeof(vector_t));
-  *v = (vector_t){64, 320};
-  list_add(slanted_shape, v);
-  v = calloc(1, sizeof(vector_t));
-  *v = (vector_t){128, 256};
-  list_add(slanted_shape, v);
-  v = calloc(1, sizeof(vector_t));
-  *v = (vector_t){160, 256};
-  list_add(slanted_shape, v);
-  body_t *slanted_body =
-      body_init_with_info(slanted_shape, INFINITY, PORTAL_SURFACE_COLOR,
-                          make_type_info(PORTAL_SURFACE), free);
-  vector_t slanted_body_centroid = {104, 330};
-  body_set_centroid(slanted_body, slanted_body_centroid);
-  body_set_visibility(slanted_body, false);
-  scene_add_body(get_curr_scene(state), slanted_body);
-
-  vector_t portal_2_pos = {608, 70};
-  vector_t portal_2_dir = {0, 1};
-  add_portal(state, portal_2_pos, portal_2_dir, 2);
-
-  add_player_body(state, player_initial_pos);
-  body_set_image(state->player_body, state->player_left_image);
-
-  add_timer(state, false);
-
-  add_portal_gun_body(state);
-}
-
-/**
- * Run level 4.
- *
- * @param state a pointer to a state
- */
-void level_4_main(state_t *state, double dt) {
-  display_timer(state);
-  tick_all(state, dt);
-
-  scene_t *scene = get_curr_scene(state);
-  sdl_render_scene(scene);
-}
-
-// -----------------------  LEVEL 5  -----------------------
+  for (size_t i = 0; i < level_num_records(level); i++) {
+    level_record_t record = level_get_record(level, i);
+    const double *values = record.values;
+    vector_t pos = record.num_values >= 2 ? level_vector(values) : VEC_ZERO;
 
-/**
- * Initializes the scene and level layout for level 5.
- *
- * @param state a pointer to a state
- */
-void level_5_init(state_t *state) {
-  reset_level(state);
-  state->timer = 60;
-  state->is_portal_restricted = false;
-
-  vector_t player_initial_pos = {5 * 64, 1 * 64 + PLAYER_DIMS.y / 2};
-
-  vector_t exit_pos = {2 * 64 + EXIT_BOX_DIMS.x / 2,
-                       7 * 64 + EXIT_BOX_DIMS.y / 2};
-
-  size_t num_walls = 5;
-  vector_t wall_positions[num_walls];
-  wall_positions[0] = (vector_t){512.0, 672.0};
-  wall_positions[1] = (vector_t){32.0, 320.0};
-  wall_positions[2] = (vector_t){784.0, 96.0};
-  wall_positions[3] = (vector_t){992.0, 320.0};
-  wall_positions[4] = (vector_t){160.0, 192.0};
-  vector_t wall_dims[num_walls];
-  wall_dims[0] = (vector_t){1024.0, 64.0};
-  wall_dims[1] = (vector_t){64.0, 640.0};
-  wall_dims[2] = (vector_t){32.0, 64.0};
-  wall_dims[3] = (vector_t){64.0, 640.0};
-  wall_dims[4] = (vector_t){192.0, 384.0};
-
-  size_t num_standing_surfaces = 5;
-  vector_t standing_surface_positions[num_standing_surfaces];
-  standing_surface_positions[0] = (vector_t){256.0, 416.0};
-  standing_surface_positions[1] = (vector_t){544.0, 368.0};
-  standing_surface_positions[2] = (vector_t){368.0, 32.0};
-  standing_surface_positions[3] = (vector_t){544.0, 16.0};
-  standing_surface_positions[4] = (vector_t){784.0, 32.0};
-  vector_t standing_surface_dims[num_standing_surfaces];
-  standing_surface_dims[0] = (vector_t){384.0, 64.0};
-  standing_surface_dims[1] = (vector_t){128.0, 32.0};
-  standing_surface_dims[2] = (vector_t){224.0, 64.0};
-  standing_surface_dims[3] = (vector_t){128.0, 32.0};
-  standing_surface_dims[4] = (vector_t){352.0, 64.0};
-
-  size_t num_portal_surfaces = 2;
-  vector_t portal_surface_positions[num_portal_surfaces];
-  portal_surface_positions[0] = (vector_t){544.0, 336.0};
-  portal_surface_positions[1] = (vector_t){544.0, 48.0};
-  vector_t portal_surface_dims[num_portal_surfaces];
-  portal_surface_dims[0] = (vector_t){128.0, 32.0};
-  portal_surface_dims[1] = (vector_t){128.0, 32.0};
-
-  char *bg_filepath = "assets/images/level_5.png";
-  add_background(state, bg_filepath);
-
-  add_gravity_body(state);
-  add_walls(state, num_walls, wall_positions, wall_dims, false);
-  add_level_exit(state, exit_pos, false);
-  add_standing_surfaces(state, num_standing_surfaces,
-                        standing_surface_positions, standing_surface_dims,
-                        false);
-  add_portal_surfaces(state, num_portal_surfaces, portal_surface_positions,
-                      portal_surface_dims, false);
-
-  // Slanted shape on left of screen is a portal surface
-  list_t *slanted_shape = list_init(1, free);
-  vector_t *v;
-  v = calloc(1, sizeof(vector_t));
-  *v = (vector_t){768, 128};
-  list_add(slanted_shape, v);
-  v = calloc(1, sizeof(vector_t));
-  *v = (vector_t){800, 128};
-  list_add(slanted_shape, v);
-  v = calloc(1, sizeof(vector_t));
-  *v = (vector_t){960, 288};
-  list_add(slanted_shape, v);
-  v = calloc(1, sizeof(vector_t));
-  *v = (vector_t){960, 320};
-  list_add(slanted_shape, v);
-  body_t *slanted_body =
-      body_init_with_info(slanted_shape, INFINITY, PORTAL_SURFACE_COLOR,
-                          make_type_info(PORTAL_SURFACE), free);
-  vector_t slanted_body_centroid = {871.8, 216.2};
-  body_set_centroid(slanted_body, slanted_body_centroid);
-  body_set_visibility(slanted_body, false);
-  scene_add_body(get_curr_scene(state), slanted_body);
-
-  add_player_body(state, player_initial_pos);
-  body_set_image(state->player_body, state->player_right_image);
-
-  add_timer(state, false);
-
-  add_portal_gun_body(state);
+    switch (record.kind) {
+    case LEVEL_RESTRICT_PORTALS:
+      state->is_portal_restricted = true;
+      break;
+    case LEVEL_BACKGROUND:
+      add_background(state, record.string);
+      break;
+    case LEVEL_GRAVITY:
+      add_gravity(state);
+      break;
+    case LEVEL_WALL: {
+      vector_t dims = level_vector(&values[2]);
+      add_walls(state, 1, &pos, &dims, false);
+      break;
+    }
+    case LEVEL_SURFACE: {
+      vector_t dims = level_vector(&values[2]);
+      add_standing_surfaces(state, 1, &pos, &dims, false);
+      break;
+    }
+    case LEVEL_PORTAL_SURFACE: {
+      vector_t dims = level_vector(&values[2]);
+      add_portal_surfaces(state, 1, &pos, &dims, false);
+      break;
+    }
+    case LEVEL_PORTAL_SURFACE_POLYGON:
+      add_polygon_portal_surface(state, pos, &values[2],
+                                 (record.num_values - 2) / 2);
+      break;
+    case LEVEL_PORTAL:
+      add_portal(state, level_vector(&values[1]), level_vector(&values[3]),
+                 values[0]);
+      break;
+    case LEVEL_EXIT:
+      add_level_exit(state, pos, false);
+      break;
+    case LEVEL_PLATFORM:
+      add_platform(state, pos, deg_to_rad(values[2]), values[3],
+                   level_vector(&values[4]), level_vector(&values[6]));
+      break;
+    case LEVEL_BUTTON:
+      add_level_button(state, pos, &values[2], record.num_values - 2);
+      break;
+    case LEVEL_PLAYER:
+      add_player_body(state, pos);
+      body_set_image(state->player_body, values[2] < 0
+                                             ? state->player_left_image
+                                             : state->player_right_image);
+      break;
+    case LEVEL_BOX:
+      add_box(state, pos);
+      break;
+    case LEVEL_TIMER:
+      state->timer = values[0];
+      add_timer(state, false);
+      break;
+    case LEVEL_PORTAL_GUN:
+      add_portal_gun_body(state);
+      break;
+    default:
+      break;
+    }
+  }
 }
 
 /**
- * Run level 5.
+ * Runs one of the playable levels.
  *
  * @param state a pointer to a state
+ * @param dt seconds passed since the last tick
  */
-void level_5_main(state_t *state, double dt) {
+void level_main(state_t *state, double dt) {
   display_timer(state);
   tick_all(state, dt);
 
   scene_t *scene = get_curr_scene(state);
-  sdl_render_scene(scene);
+  render_scene(scene);
 }
 
 /**
@@ -1924,22 +1543,18 @@ void on_key(state_t *state, char key, key_event_type_t type, double held_time) {
     sdl_play_sound(PORTAL_GUN_SOUND_PATH);
     add_portal_projectile(state, 2);
   } else if (key == F) {
-    list_t *player_shape = body_get_shape(player_body);
     for (size_t i = 0; i < list_size(box_connections); i++) {
       connection_t *box_connection = list_get(box_connections, i);
       body_t *box_body = connection_get_connected_body(box_connection);
       bool is_connected = connection_get_is_connected(box_connection);
 
-      list_t *box_shape = body_get_shape(box_body);
-
-      collision_info_t collision_info = find_collision(player_shape, box_shape);
+      collision_info_t collision_info =
+          find_body_collision(player_body, box_body);
       if (collision_info.collided || is_connected) {
         connection_toggle(box_connection);
         break;
       }
-      list_free(box_shape);
     }
-    list_free(player_shape);
   } else if (key == RET) {
     if (state->curr_level == START_SCREEN_IDX) {
       state->curr_level = 0;
@@ -1988,6 +1603,51 @@ void on_key(state_t *state, char key, key_event_type_t type, double held_time) {
   body_set_velocity(player_body, new_velocity);
 }
 
+/**
+ * Handles a key event like on_key(), recording it first
+ * so that the session can be replayed.
+ *
+ * @param state pointer to the current state of the program
+ * @param key a character indicating which key was pressed
+ * @param type the type of key event (KEY_PRESSED or KEY_RELEASED)
+ * @param held_time if a press event, the time the key has been held in seconds
+ */
+void record_key(state_t *state, char key, key_event_type_t type,
+                double held_time) {
+  input_recorder_key(state->recorder, state->frame, key, type, held_time);
+  on_key(state, key, type, held_time);
+}
+
+/**
+ * Feeds the recorded input for the current frame back into the game,
+ * in the order it originally arrived.
+ *
+ * @param state a pointer to a state that is replaying input
+ */
+void replay_input(state_t *state) {
+  journal_event_t event;
+  while (input_player_next(state->player, state->frame, &event)) {
+    if (event.kind == JOURNAL_MOUSE) {
+      state->mouse_pos = event.mouse_pos;
+    } else {
+      on_key(state, event.key, event.type, event.held_time);
+    }
+  }
+}
+
+/**
+ * Reports how long a replay took to run and exits.
+ *
+ * @param state a pointer to a state that has replayed all its input
+ */
+void finish_replay(state_t *state) {
+  double seconds = (double)(clock() - state->replay_start) / CLOCKS_PER_SEC;
+  printf("Replayed %u frames in %.3f s (%.3f ms per frame)\n", state->frame,
+         seconds, 1e3 * seconds / state->frame);
+  emscripten_free(state);
+  exit(0);
+}
+
 /**
  * Initialize eitehr the game level, start screen, level screen, or game won
  * screen according to the current level in state.
@@ -1996,24 +1656,6 @@ void on_key(state_t *state, char key, key_event_type_t type, double held_time) {
  */
 void init_new_level(state_t *state) {
   switch (state->curr_level) {
-  case 0:
-    level_0_init(state);
-    break;
-  case 1:
-    level_1_init(state);
-    break;
-  case 2:
-    level_2_init(state);
-    break;
-  case 3:
-    level_3_init(state);
-    break;
-  case 4:
-    level_4_init(state);
-    break;
-  case 5:
-    level_5_init(state);
-    break;
   case START_SCREEN_IDX:
     start_screen_init(state);
     break;
@@ -2026,6 +1668,12 @@ void init_new_level(state_t *state) {
   case RULES_SCREEN_IDX:
     rules_screen_init(state);
     break;
+  default:
+    build_level(state, list_get(state->levels, state->curr_level));
+    break;
+  }
+  if (state->curr_level < NUM_LEVELS) {
+    save_level_start(state);
   }
 }
 
@@ -2037,24 +1685,6 @@ void init_new_level(state_t *state) {
  */
 void run_curr_level(state_t *state, double dt) {
   switch (state->curr_level) {
-  case 0:
-    level_0_main(state, dt);
-    break;
-  case 1:
-    level_1_main(state, dt);
-    break;
-  case 2:
-    level_2_main(state, dt);
-    break;
-  case 3:
-    level_3_main(state, dt);
-    break;
-  case 4:
-    level_4_main(state, dt);
-    break;
-  case 5:
-    level_5_main(state, dt);
-    break;
   case START_SCREEN_IDX:
     start_screen_main(state, dt);
     break;
@@ -2067,6 +1697,9 @@ void run_curr_level(state_t *state, double dt) {
   case RULES_SCREEN_IDX:
     rules_screen_main(state, dt);
     break;
+  default:
+    level_main(state, dt);
+    break;
   }
 }
 
@@ -2078,13 +1711,24 @@ void run_curr_level(state_t *state, double dt) {
 state_t *emscripten_init() {
   vector_t min = (vector_t){.x = 0, .y = 0};
   vector_t max = WINDOW;
-  sdl_init(min, max);
+  state_t *state = calloc(1, sizeof(state_t));
+  const char *replay_path = getenv(REPLAY_ENV_VAR);
+  if (replay_path) {
+    state->player = input_player_init(replay_path);
+    if (!state->player) {
+      exit(2);
+    }
+    state->headless_backend = null_backend_init();
+    render_set_backend(state->headless_backend);
+    sdl_disable_audio();
+  } else {
+    sdl_init(min, max);
+  }
   if (TTF_Init() == -1) {
     printf("TTF_Init: %s\n", TTF_GetError());
     exit(2);
   }
 
-  state_t *state = calloc(1, sizeof(state_t));
   state->scenes = list_init(NUM_LEVELS, (free_func_t)scene_free);
   state->curr_level = START_SCREEN_IDX;
   state->is_jumping = calloc(1, sizeof(bool));
@@ -2096,8 +1740,39 @@ state_t *emscripten_init() {
     list_add(state->scenes, scene_init());
   }
 
+  // Read every level up front, so switching levels needs no file access
+  state->levels = list_init(NUM_LEVELS, (free_func_t)level_free);
+  for (size_t i = 0; i < NUM_LEVELS; i++) {
+    char level_path[100];
+    snprintf(level_path, sizeof(level_path), LEVEL_PATH_FORMAT, i);
+    level_t *level = level_load(level_path);
+    // level_load() has already printed what is wrong with the file
+    if (!level) {
+      exit(2);
+    }
+    list_add(state->levels, level);
+  }
+
+  if (!state->player) {
+    // Pack the small images drawn every frame into one texture
+    const char *sprite_paths[] = {BOX_IMG_PATH, PORTAL_1_IMG_PATH,
+                                  PORTAL_2_IMG_PATH, PLAYER_RIGHT_IMG_PATH,
+                                  PLAYER_LEFT_IMG_PATH};
+    sdl_pack_images(sprite_paths, sizeof(sprite_paths) / sizeof(char *));
+  }
+  state->player_left_image = render_acquire_image(PLAYER_LEFT_IMG_PATH);
+  state->player_right_image = render_acquire_image(PLAYER_RIGHT_IMG_PATH);
+
   init_new_level(state);
-  sdl_on_key(on_key);
+  const char *record_path = getenv(RECORD_ENV_VAR);
+  if (state->player) {
+    state->replay_start = clock();
+  } else if (record_path) {
+    state->recorder = input_recorder_init(record_path, PHYSICS_DT);
+  }
+  sdl_on_key(state->recorder ? record_key : on_key);
+  sdl_preload_sound(PORTAL_GUN_SOUND_PATH);
+  portal_preload_sound();
   sdl_start_background_music(BACKGROUND_MUSIC_FILE_PATH);
   return state;
 }
@@ -2109,14 +1784,33 @@ state_t *emscripten_init() {
  * @return a pointer to the current state of the program
  */
 void emscripten_main(state_t *state) {
-  sdl_clear();
-  double dt = time_since_last_tick();
+  double dt;
+  if (state->player) {
+    replay_input(state);
+    dt = input_player_dt(state->player);
+  } else {
+    sdl_clear();
+    // A recorded session runs one fixed step per frame,
+    // so that replaying it gives exactly the same results
+    dt = state->recorder ? PHYSICS_DT : time_since_last_tick();
+  }
 
   run_curr_level(state, dt);
   restrict_player_speed(state);
   check_end_level(state);
 
+  // Input that arrives now is handled before the next frame runs
+  state->frame++;
+  if (state->player) {
+    if (state->frame >= input_player_num_frames(state->player)) {
+      finish_replay(state);
+    }
+    return;
+  }
   state->mouse_pos = sdl_get_mouse_pos();
+  if (state->recorder) {
+    input_recorder_mouse(state->recorder, state->frame, state->mouse_pos);
+  }
 }
 
 /**
@@ -2125,7 +1819,17 @@ void emscripten_main(state_t *state) {
  * @param state a pointer to the state of the program
  */
 void emscripten_free(state_t *state) {
+  sdl_free_sounds();
+  sdl_free_fonts();
   list_free(state->scenes);
+  list_free(state->levels);
+  if (state->player_left_image) {
+    render_release_image(state->player_left_image);
+  }
+  if (state->player_right_image) {
+    render_release_image(state->player_right_image);
+  }
+  sdl_free_images();
   free(state->is_jumping);
   free(state->is_player_teleporting);
   free(state->is_box_teleporting);
@@ -2147,5 +1851,18 @@ void emscripten_free(state_t *state) {
   if (state->buttons) {
     list_free(state->buttons);
   }
+  if (state->level_start) {
+    level_start_free(state->level_start);
+  }
+  if (state->recorder) {
+    input_recorder_free(state->recorder, state->frame);
+  }
+  if (state->player) {
+    input_player_free(state->player);
+  }
+  if (state->headless_backend) {
+    render_set_backend(NULL);
+    render_backend_free(state->headless_backend);
+  }
   free(state);
 }
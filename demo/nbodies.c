@@ -21,6 +21,8 @@ const double BASE_HEIGHT_LEN = 6;
 const vector_t INITIAL_VEL = {0, 0};
 const double MAX_MASS = 20;
 const double G = 1e3;
+// Barnes-Hut opening angle; smaller is more accurate but slower
+const double THETA = 0.5;
 const vector_t SPAWNING_WINDOW = {600, 300};
 const double TOTAL_CIRCLE_ANGLE = 360;
 
@@ -184,12 +186,7 @@ state_t *emscripten_init() {
   }
 
   // Add gravitational forces between every body
-  for (size_t i = 0; i < scene_bodies(scene) - 1; i++) {
-    for (size_t j = i + 1; j < scene_bodies(scene); j++) {
-      create_newtonian_gravity(scene, G, scene_get_body(scene, i),
-                               scene_get_body(scene, j));
-    }
-  }
+  create_barnes_hut_gravity(scene, G, THETA);
 
   return state;
 }
@@ -29,20 +29,19 @@
 
 #define BALL_MASS 2.0
 
+// Side length of the broad-phase grid cells; about one ball across
+#define GRID_CELL_SIZE (2 * BALL_RADIUS)
+
 #define BALL_COLOR ((rgb_color_t){1, 0, 0})
 #define PEG_COLOR ((rgb_color_t){0, 1, 0})
 #define WALL_COLOR ((rgb_color_t){0, 0, 1})
 
-#define G 6.67E-11          // N m^2 / kg^2
-#define M 6E24              // kg
-#define g 9.8               // m / s^2
-#define R (sqrt(G * M / g)) // m
+#define g 9.8 // m / s^2
 
 typedef enum {
   BALL,
   FROZEN,
-  WALL, // or peg
-  GRAVITY
+  WALL // or peg
 } body_type_t;
 
 body_type_t *make_type_info(body_type_t type) {
@@ -55,6 +54,12 @@ body_type_t get_type(body_t *body) {
   return *(body_type_t *)body_get_info(body);
 }
 
+bool is_ball(body_t *body) { return get_type(body) == BALL; }
+
+bool is_frozen(body_t *body) { return get_type(body) == FROZEN; }
+
+bool is_wall(body_t *body) { return get_type(body) == WALL; }
+
 /** Generates a random number between 0 and 1 */
 double rand_double(void) { return (double)rand() / RAND_MAX; }
 
@@ -99,19 +104,6 @@ vector_t get_peg_center(size_t row, size_t col) {
   return center;
 }
 
-/** Creates an Earth-like mass to accelerate the balls */
-void add_gravity_body(scene_t *scene) {
-  // Will be offscreen, so shape is irrelevant
-  list_t *gravity_ball = rect_init(1, 1);
-  body_t *body = body_init_with_info(gravity_ball, M, WALL_COLOR,
-                                     make_type_info(GRAVITY), free);
-
-  // Move a distnace R below the scene
-  vector_t gravity_center = {.x = MAX.x / 2, .y = -R};
-  body_set_centroid(body, gravity_center);
-  scene_add_body(scene, body);
-}
-
 /** Creates a ball with the given starting position and velocity */
 body_t *get_ball(vector_t center, vector_t velocity) {
   list_t *shape = circle_init(BALL_RADIUS);
@@ -136,15 +128,6 @@ void freeze(body_t *ball, body_t *target, vector_t axis, void *aux) {
   *((body_type_t *)body_get_info(frozen)) = FROZEN;
   scene_t *scene = aux;
   scene_add_body(scene, frozen);
-
-  // Make other falling bodies freeze when they collide with this body
-  size_t body_count = scene_bodies(scene);
-  for (size_t i = 0; i < body_count; i++) {
-    body_t *body = scene_get_body(scene, i);
-    if (get_type(body) == BALL) {
-      create_collision(scene, body, frozen, freeze, scene, NULL);
-    }
-  }
 }
 
 /** Adds a ball to the scene */
@@ -153,44 +136,42 @@ void add_ball(scene_t *scene) {
   vector_t ball_center = {.x = MAX.x / 2 + (rand_double() - 0.5) * DELTA_X,
                           .y = DROP_Y};
   body_t *ball = get_ball(ball_center, START_VELOCITY);
-  size_t body_count = scene_bodies(scene);
+  // Gravity and collisions are registered for all balls in add_forces()
   scene_add_body(scene, ball);
+}
 
-  // Add force creators with other bodies
-  for (size_t i = 0; i < body_count; i++) {
-    body_t *body = scene_get_body(scene, i);
-    switch (get_type(body)) {
-    case BALL:
-      // Bounce off other balls
-      create_physics_collision(scene, BALL_ELASTICITY, ball, body);
-      break;
-    case WALL:
-      // Bounce off walls and pegs
-      create_physics_collision(scene, PEG_ELASTICITY, ball, body);
-      break;
-    case FROZEN:
-      // Freeze when hitting the ground or frozen balls
-      create_collision(scene, ball, body, freeze, scene, NULL);
-      break;
-    case GRAVITY:
-      // Simulate earth's gravity acting on the ball
-      create_newtonian_gravity(scene, G, body, ball);
-    }
-  }
+/** Adds gravity and the collision rules between each type of body */
+void add_forces(scene_t *scene) {
+  // Simulate earth's gravity acting on the falling balls
+  create_filtered_uniform_field(scene, (vector_t){.x = 0.0, .y = -g},
+                                is_ball);
+  // Only nearby bodies need to be tested against each other
+  scene_enable_spatial_hash(scene, GRID_CELL_SIZE);
+  // Bounce off other balls
+  create_type_physics_collision(scene, BALL_ELASTICITY, is_ball, is_ball);
+  // Bounce off walls and pegs
+  create_type_physics_collision(scene, PEG_ELASTICITY, is_ball, is_wall);
+  // Freeze when hitting the ground or frozen balls
+  create_type_collision(scene, is_ball, is_frozen, freeze, scene, NULL);
 }
 
 /** Adds the pegs to the scene */
 void add_pegs(scene_t *scene) {
+  // Every peg is a copy of one circle, so its centroid is only computed once
+  list_t *circle = circle_init(PEG_RADIUS);
+  polygon_t *peg_shape = polygon_from_list(circle);
+  list_free(circle);
   // Add N_ROWS and N_COLS of pegs.
   for (size_t i = 1; i <= N_ROWS; i++) {
     for (size_t j = 0; j <= i; j++) {
-      list_t *polygon = circle_init(PEG_RADIUS);
-      body_t *body = body_init_with_info(polygon, INFINITY, PEG_COLOR,
-                                         make_type_info(WALL), free);
+      body_t *body =
+          body_init_with_polygon(polygon_copy(peg_shape), INFINITY, PEG_COLOR,
+                                 make_type_info(WALL), free, NULL);
       body_set_centroid(body, get_peg_center(i, j));
       scene_add_body(scene, body);
     }
   }
+  polygon_free(peg_shape);
 }
 
 /** Adds the walls to the scene */
@@ -229,9 +210,9 @@ state_t *emscripten_init(void) {
   sdl_init(VEC_ZERO, MAX);
   scene_t *scene = scene_init();
   // Add elements to the scene
-  add_gravity_body(scene);
   add_pegs(scene);
   add_walls(scene);
+  add_forces(scene);
   // Repeatedly render scene
   double time_since_drop = INFINITY;
 
@@ -3,9 +3,10 @@
 
 #include "color.h"
 #include "list.h"
+#include "polygon.h"
 #include "vector.h"
-#include <SDL2/SDL.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * A rigid body constrained to the plane.
@@ -15,6 +16,59 @@
  */
 typedef struct body body_t;
 
+/**
+ * A font at one size whose glyphs are cached in a single texture.
+ * See sdl_get_font().
+ */
+typedef struct font font_t;
+
+/**
+ * A reference-counted image loaded from a file.
+ * See render_acquire_image().
+ */
+typedef struct image image_t;
+
+/**
+ * A texture created by SDL, e.g. with sdl_load_text().
+ * Declared here so that bodies can hold one without depending on SDL.
+ */
+typedef struct SDL_Texture SDL_Texture;
+
+/**
+ * The part of a body that changes as a scene runs,
+ * saved by body_save_state() so it can be put back later.
+ * The body's vertices are saved separately.
+ */
+typedef struct body_state {
+  vector_t centroid;
+  vector_t prev_centroid;
+  vector_t velocity;
+  double rotation;
+  vector_t origin_offset;
+  aabb_t bounds;
+  bool is_visible;
+  bool is_removed;
+} body_state_t;
+
+/**
+ * Where the fields of a body that a scene visits every tick are stored.
+ * A body starts out storing them itself. A scene moves them into arrays
+ * holding the same field for all of its bodies, so that it can integrate
+ * every body in one pass over contiguous memory (see scene_tick()).
+ */
+typedef struct body_kinematics {
+  vector_t *centroid;
+  vector_t *prev_centroid;
+  vector_t *velocity;
+  vector_t *force;
+  vector_t *impulse;
+  double *inverse_mass;
+  bool *is_removed;
+  // Set when the body is moved or turned other than by integration,
+  // e.g. by body_set_centroid(); shared by all the bodies of a scene
+  bool *moved;
+} body_kinematics_t;
+
 /**
  * Initializes a body without any info.
  * Acts like body_init_with_info() where info and info_freer are NULL.
@@ -30,8 +84,8 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
 
 /**
  * Allocates memory for a body with the given parameters.
- * The body is initially at rest.
- * Asserts that the mass is positive and that the required memory is allocated.
+ * Acts like body_init_with_polygon(), but takes the shape as a list of vectors.
+ * The list is converted to a packed polygon and freed.
  *
  * @param shape a list of vectors describing the initial shape of the body
  * @param mass the mass of the body (if INFINITY, stops the body from moving)
@@ -46,6 +100,26 @@ body_t *body_init_with_image(list_t *shape, double mass, rgb_color_t color,
                              void *info, free_func_t info_freer,
                              const char *image_path);
 
+/**
+ * Allocates memory for a body with the given parameters.
+ * The body is initially at rest.
+ * Asserts that the mass is positive and that the required memory is allocated.
+ *
+ * @param shape a packed polygon describing the initial shape of the body;
+ *   the body takes ownership of it
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body,
+ *   e.g. its type if the scene has multiple types of bodies
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @param image_path path to the image to be rendered, or NULL;
+ *   loaded through the active render backend (see render_acquire_image())
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_with_polygon(polygon_t *shape, double mass,
+                               rgb_color_t color, void *info,
+                               free_func_t info_freer, const char *image_path);
+
 /**
  * Releases the memory allocated for a body.
  *
@@ -62,6 +136,27 @@ void body_free(body_t *body);
  */
 list_t *body_get_shape(body_t *body);
 
+/**
+ * Gets the current shape of a body without copying it.
+ * The returned polygon is owned by the body and must not be modified or freed.
+ * It remains valid until the body is freed, but its vertices are only
+ * moved to follow the body when the shape is asked for again.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the polygon describing the body's current position
+ */
+polygon_t *body_peek_shape(body_t *body);
+
+/**
+ * Gets the axis-aligned bounding box of a body's current shape.
+ * The box is cached, and offset by how far the body has moved
+ * since its vertices were last placed.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the world-space bounding box of the body
+ */
+aabb_t body_get_bounds(body_t *body);
+
 /**
  * Gets the current center of mass of a body.
  * While this could be calculated with polygon_centroid(), that becomes too slow
@@ -73,6 +168,16 @@ list_t *body_get_shape(body_t *body);
  */
 vector_t body_get_centroid(body_t *body);
 
+/**
+ * Gets the center of mass a body had before its last tick.
+ * Moving the body with body_set_centroid() moves this position with it,
+ * so a renderer blending between the two never smears a teleport.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's center of mass before the last call to body_tick()
+ */
+vector_t body_get_previous_centroid(body_t *body);
+
 /**
  * Gets the current velocity of a body.
  *
@@ -138,12 +243,36 @@ double body_get_rotation(body_t *body);
 SDL_Texture *body_get_text(body_t *body);
 
 /**
- * Gets the body's image texture.
+ * Gets the text drawn on the body with its font, if any.
  *
  * @param body a pointer to a body returned from body_init()
- * @return the pointer to the body's image texture.
+ * @return the body's label, or NULL if it has none
  */
-SDL_Texture *body_get_image(body_t *body);
+const char *body_get_label(body_t *body);
+
+/**
+ * Gets the font the body's label is drawn with.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the label's font, or NULL if the body has no label
+ */
+font_t *body_get_label_font(body_t *body);
+
+/**
+ * Gets the color the body's label is drawn in.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the label's color
+ */
+rgb_color_t body_get_label_color(body_t *body);
+
+/**
+ * Gets the body's image.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the pointer to the body's image, or NULL if it has none
+ */
+image_t *body_get_image(body_t *body);
 
 /**
  * Gets the visibility of the body.
@@ -171,16 +300,33 @@ void body_set_visibility(body_t *body, bool is_visible);
 void body_set_text(body_t *body, SDL_Texture *text);
 
 /**
- * Changes a body's image texture.
+ * Changes the text drawn on a body, drawn glyph by glyph from a cached font
+ * instead of being rendered into a new texture.
+ * The body keeps its own copy of the text, reusing its buffer when it can,
+ * so updating a label every frame neither allocates nor touches the disk.
  *
  * @param body a pointer to a body returned from body_init()
- * @param image a pointer to the new image texture
+ * @param label the new text, or NULL to remove the label
+ * @param font a font returned from sdl_get_font(); not owned by the body
+ * @param color the color to draw the text in
  */
-void body_set_image(body_t *body, SDL_Texture *image);
+void body_set_label(body_t *body, const char *label, font_t *font,
+                    rgb_color_t color);
+
+/**
+ * Changes a body's image.
+ * The body holds a reference to its image, releasing it when it is replaced
+ * or the body is freed.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param image a pointer to the new image, or NULL for none
+ */
+void body_set_image(body_t *body, image_t *image);
 
 /**
  * Translates a body to a new position.
  * The position is specified by the position of the body's center of mass.
+ * Takes constant time: the vertices follow when they are next needed.
  *
  * @param body a pointer to a body returned from body_init()
  * @param x the body's new centroid
@@ -199,6 +345,8 @@ void body_set_velocity(body_t *body, vector_t v);
  * Changes a body's orientation in the plane.
  * The body is rotated about an inputted point.
  * Note that the angle is *absolute*, not relative to the current orientation.
+ * Takes constant time: the vertices are rebuilt from the body's shape
+ * as it was created when they are next needed.
  *
  * @param body a pointer to a body returned from body_init()
  * @param angle the body's new angle in radians. Positive is counterclockwise.
@@ -270,5 +418,55 @@ void body_remove(body_t *body);
  */
 bool body_is_removed(body_t *body);
 
+/**
+ * Gets a number identifying a body.
+ * Unlike the body's address, it is never reused by a later body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's identifier
+ */
+uint64_t body_get_id(body_t *body);
+
+/**
+ * Saves the position, rotation, velocity, and flags of a body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param state where to save the body's state
+ * @param vertices where to copy the body's vertices; must have room for
+ *   polygon_size(body_peek_shape(body)) vectors
+ */
+void body_save_state(body_t *body, body_state_t *state, vector_t *vertices);
+
+/**
+ * Puts back a state saved by body_save_state(),
+ * and clears the forces and impulses accumulated on the body.
+ * The body's shape must still have the same number of vertices.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param state the state to restore
+ * @param vertices the vertices saved with the state
+ */
+void body_restore_state(body_t *body, const body_state_t *state,
+                        const vector_t *vertices);
+
+/**
+ * Moves a body's kinematic fields to new storage, copying their values.
+ * The body reads and writes them there from then on.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param kinematics where to store the fields; must stay valid
+ *   until the body is freed or its fields are moved again
+ */
+void body_move_kinematics(body_t *body, body_kinematics_t kinematics);
+
+/**
+ * Points a body at storage that already holds its kinematic fields,
+ * e.g. after the array holding them was reallocated.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param kinematics where the body's fields are now stored
+ */
+void body_set_kinematics(body_t *body, body_kinematics_t kinematics);
+
 
 #endif // #ifndef __BODY_H__
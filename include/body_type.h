@@ -5,7 +5,6 @@ typedef enum {
   PLAYER,
   WALL,
   JUMPABLE,
-  GRAVITY,
   PORTAL,
   PORTAL_GUN,
   PORTAL_PROJECTILE,
@@ -53,4 +53,22 @@ body_t *button_get_base_body(button_t *button);
  * @param pressing_bodies the pointer to the list of bodies that can be on the button
  * @param dt the number of seconds elapsed since the last tick
  */
-void button_tick(button_t *button, list_t *pressing_bodies, double dt);
\ No newline at end of file
+void button_tick(button_t *button, list_t *pressing_bodies, double dt);
+
+/**
+ * Gets how far a button has been pressed down,
+ * as the time it has spent moving down.
+ *
+ * @param button the pointer to the button struct
+ * @return the number of seconds of its press the button has completed
+ */
+double button_get_motion_time(button_t *button);
+
+/**
+ * Sets how far a button has been pressed down, without moving its body.
+ * Used to put a button back together with its body's saved state.
+ *
+ * @param button the pointer to the button struct
+ * @param sum_motion_time a value returned from button_get_motion_time()
+ */
+void button_set_motion_time(button_t *button, double sum_motion_time);
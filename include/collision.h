@@ -1,7 +1,9 @@
 #ifndef __COLLISION_H__
 #define __COLLISION_H__
 
+#include "body.h"
 #include "list.h"
+#include "polygon.h"
 #include "vector.h"
 #include <stdbool.h>
 
@@ -31,7 +33,33 @@ typedef struct {
  * @param shape2 the second shape
  * @return whether the shapes are colliding, and if so, the collision axis.
  * The axis should be a unit vector pointing from shape1 towards shape2.
+ * Legacy entry point: both lists are converted to packed polygons first.
  */
 collision_info_t find_collision(list_t *shape1, list_t *shape2);
 
+/**
+ * Computes the status of the collision between two packed convex polygons.
+ * Acts like find_collision(), but does not allocate any memory.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @return whether the shapes are colliding, and if so, the collision axis.
+ * The axis is a unit vector pointing from shape1 towards shape2.
+ */
+collision_info_t find_polygon_collision(polygon_t *shape1, polygon_t *shape2);
+
+/**
+ * Computes the status of the collision between two bodies.
+ * Acts like find_polygon_collision() on the bodies' current shapes,
+ * reading the vertices in place instead of copying them.
+ * Pairs whose cached bounding boxes don't overlap are rejected
+ * before any per-vertex work is done.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return whether the bodies are colliding, and if so, the collision axis.
+ * The axis is a unit vector pointing from body1 towards body2.
+ */
+collision_info_t find_body_collision(body_t *body1, body_t *body2);
+
 #endif // #ifndef __COLLISION_H__
@@ -14,6 +14,12 @@
 typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
                                     void *aux);
 
+/**
+ * A function which decides whether a body belongs to some group,
+ * e.g. by checking the type stored in its info.
+ */
+typedef bool (*body_filter_t)(body_t *body);
+
 typedef struct force_applier force_applier_t;
 
 force_applier_t *force_applier_init(force_creator_t forcer, void *aux,
@@ -27,6 +33,10 @@ list_t *get_force_applier_bodies(force_applier_t *force_applier);
 
 void force_applier_free(force_applier_t *force_applier);
 
+void force_applier_remove(force_applier_t *force_applier);
+
+bool force_applier_is_removed(force_applier_t *force_applier);
+
 /**
  * Adds a force creator to a scene that applies gravity between two bodies.
  * The force creator will be called each tick
@@ -51,6 +61,64 @@ void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
  */
 void apply_newtonian_gravity(void *aux);
 
+/**
+ * Adds a force creator to a scene that applies Newtonian gravity
+ * between every pair of bodies in the scene, including bodies added later.
+ * Replaces calling create_newtonian_gravity() on every pair:
+ * each tick it builds a Barnes-Hut quadtree over the bodies' centroids
+ * and approximates the pull of distant groups of bodies by their total mass,
+ * taking O(n log n) time and O(n) memory instead of O(n^2).
+ *
+ * Like create_newtonian_gravity(), bodies very close together don't attract.
+ * Its cutoff for small force components is not applied, though,
+ * since a group's pull is only known as a sum.
+ * Bodies with infinite mass are left out.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param theta the opening angle; a group of bodies of width s at distance d
+ *   is treated as one mass when s / d < theta. 0 is exact; 0.5 is typical.
+ */
+void create_barnes_hut_gravity(scene_t *scene, double G, double theta);
+
+/**
+ * Applies Barnes-Hut gravity to all the bodies in the scene stored in aux.
+ *
+ * @param aux an auxiliary value holding the scene, constants,
+ * and the quadtree reused between ticks
+ */
+void apply_barnes_hut_gravity(void *aux);
+
+/**
+ * Adds a force creator to a scene that applies a uniform gravitational field,
+ * i.e. a force of mass * g, to every body in the scene with finite mass,
+ * including bodies added later.
+ * This is exact and far cheaper than placing a planet-sized body
+ * far away and using create_newtonian_gravity() on every body.
+ *
+ * @param scene the scene containing the bodies
+ * @param g the acceleration due to gravity
+ */
+void create_uniform_field(scene_t *scene, vector_t g);
+
+/**
+ * Acts like create_uniform_field(), but only applies the field
+ * to the bodies selected by a filter.
+ *
+ * @param scene the scene containing the bodies
+ * @param g the acceleration due to gravity
+ * @param filter selects the bodies the field acts on, or NULL for all of them
+ */
+void create_filtered_uniform_field(scene_t *scene, vector_t g,
+                                   body_filter_t filter);
+
+/**
+ * Applies a uniform field to the bodies in the scene stored in aux.
+ *
+ * @param aux an auxiliary value holding the scene, the field, and the filter
+ */
+void apply_uniform_field(void *aux);
+
 /**
  * Adds a force creator to a scene that acts like a spring between two bodies.
  * The force creator will be called each tick
@@ -230,4 +298,45 @@ void create_jump_force(scene_t *scene, double jump_speed,
  */
 void apply_jump_force(void *aux);
 
+/**
+ * Adds a force creator to a scene that calls a given collision handler
+ * each time a body of one group collides with a body of another group.
+ * Acts like calling create_collision() on every such pair, including bodies
+ * added to the scene later, but only the pairs the scene's broad phase
+ * reports as nearby are tested (see scene_for_each_pair()).
+ * The handler is called once when a pair starts colliding.
+ *
+ * @param scene the scene containing the bodies
+ * @param is_body1 selects the bodies passed to the handler as body1
+ * @param is_body2 selects the bodies passed to the handler as body2
+ * @param handler a function to call whenever two such bodies collide
+ * @param aux an auxiliary value to pass to the handler
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void create_type_collision(scene_t *scene, body_filter_t is_body1,
+                           body_filter_t is_body2, collision_handler_t handler,
+                           void *aux, free_func_t freer);
+
+/**
+ * Applies the collision handler to every colliding pair selected by aux.
+ *
+ * @param aux a pointer to an auxiliary variable containing the scene,
+ * the body filters, and the pairs that collided last tick
+ */
+void apply_type_collision(void *aux);
+
+/**
+ * Adds a force creator to a scene that applies impulses to resolve
+ * collisions between bodies of two groups.
+ * Acts like create_physics_collision() on every such pair.
+ *
+ * @param scene the scene containing the bodies
+ * @param elasticity the "coefficient of restitution" of the collision
+ * @param is_body1 selects the first group of bodies
+ * @param is_body2 selects the second group of bodies
+ */
+void create_type_physics_collision(scene_t *scene, double elasticity,
+                                   body_filter_t is_body1,
+                                   body_filter_t is_body2);
+
 #endif // #ifndef __FORCES_H__
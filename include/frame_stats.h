@@ -0,0 +1,59 @@
+#ifndef __FRAME_STATS_H__
+#define __FRAME_STATS_H__
+
+#include <stddef.h>
+
+/**
+ * A record of the most recent frame times,
+ * kept in a fixed-size ring so recording a frame never allocates.
+ */
+typedef struct frame_stats frame_stats_t;
+
+/**
+ * Statistics over the frames currently held by a frame_stats_t.
+ * All times are in seconds, and are 0 if no frames have been recorded.
+ */
+typedef struct frame_summary {
+  size_t num_frames;
+  double min;
+  double max;
+  double mean;
+  // The frame time that 99% of the frames were at most
+  double p99;
+} frame_summary_t;
+
+/**
+ * Allocates memory for an empty record of frame times.
+ * Asserts that the required memory is allocated.
+ *
+ * @param window the number of most recent frames to keep; must be positive
+ * @return a pointer to the newly allocated record
+ */
+frame_stats_t *frame_stats_init(size_t window);
+
+/**
+ * Releases the memory allocated for a record of frame times.
+ *
+ * @param stats a pointer to a record returned from frame_stats_init()
+ */
+void frame_stats_free(frame_stats_t *stats);
+
+/**
+ * Adds a frame's time to a record, replacing the oldest frame if it is full.
+ *
+ * @param stats a pointer to a record returned from frame_stats_init()
+ * @param frame_time the time the frame took, in seconds
+ */
+void frame_stats_record(frame_stats_t *stats, double frame_time);
+
+/**
+ * Computes statistics over the frames in a record.
+ * Takes time proportional to the window size times its logarithm,
+ * so this is meant for occasional reporting rather than every frame.
+ *
+ * @param stats a pointer to a record returned from frame_stats_init()
+ * @return the statistics of the recorded frames
+ */
+frame_summary_t frame_stats_summarize(frame_stats_t *stats);
+
+#endif // #ifndef __FRAME_STATS_H__
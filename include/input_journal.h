@@ -0,0 +1,130 @@
+#ifndef __INPUT_JOURNAL_H__
+#define __INPUT_JOURNAL_H__
+
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A recording of the input to a program, frame by frame,
+ * so that a session can be played back exactly (e.g. without a window,
+ * to profile the same workload repeatedly).
+ *
+ * The file starts with the length of each frame, which must be fixed,
+ * followed by one record per key event or mouse movement.
+ * Each record stores how many frames passed since the previous one
+ * as a variable-length integer, so idle frames cost nothing.
+ */
+typedef struct input_recorder input_recorder_t;
+
+/**
+ * Plays back a journal written by an input_recorder_t.
+ * The whole file is read when the player is created.
+ */
+typedef struct input_player input_player_t;
+
+/** The kinds of input stored in a journal */
+typedef enum { JOURNAL_KEY, JOURNAL_MOUSE } journal_event_kind_t;
+
+/** One recorded input */
+typedef struct journal_event {
+  journal_event_kind_t kind;
+  // The frame the input was delivered on
+  uint32_t frame;
+  // For JOURNAL_KEY, the arguments that were passed to the key handler
+  char key;
+  int type;
+  double held_time;
+  // For JOURNAL_MOUSE, the new mouse position
+  vector_t mouse_pos;
+} journal_event_t;
+
+/**
+ * Creates a journal file and starts recording into it.
+ *
+ * @param filename the path of the file to write; it is overwritten
+ * @param dt the length of every recorded frame, in seconds
+ * @return a pointer to the newly allocated recorder,
+ *   or NULL if the file could not be created
+ */
+input_recorder_t *input_recorder_init(const char *filename, double dt);
+
+/**
+ * Records a key event.
+ * Frames must be recorded in non-decreasing order.
+ *
+ * @param recorder a pointer to a recorder returned from input_recorder_init()
+ * @param frame the number of the frame the event is delivered on
+ * @param key the key passed to the key handler
+ * @param type the event type passed to the key handler (a key_event_type_t)
+ * @param held_time the held time passed to the key handler
+ */
+void input_recorder_key(input_recorder_t *recorder, uint32_t frame, char key,
+                        int type, double held_time);
+
+/**
+ * Records the mouse position. Nothing is written if it hasn't moved
+ * since it was last recorded.
+ * Frames must be recorded in non-decreasing order.
+ *
+ * @param recorder a pointer to a recorder returned from input_recorder_init()
+ * @param frame the number of the frame the position is read on
+ * @param mouse_pos the position of the mouse
+ */
+void input_recorder_mouse(input_recorder_t *recorder, uint32_t frame,
+                          vector_t mouse_pos);
+
+/**
+ * Finishes the journal, closes its file, and releases the recorder.
+ *
+ * @param recorder a pointer to a recorder returned from input_recorder_init()
+ * @param num_frames the number of frames the session ran for
+ */
+void input_recorder_free(input_recorder_t *recorder, uint32_t num_frames);
+
+/**
+ * Reads a journal file for playback.
+ *
+ * @param filename the path of a file written by an input_recorder_t
+ * @return a pointer to the newly allocated player,
+ *   or NULL if the file could not be read or is not a complete journal
+ */
+input_player_t *input_player_init(const char *filename);
+
+/**
+ * Releases the memory allocated for a player.
+ *
+ * @param player a pointer to a player returned from input_player_init()
+ */
+void input_player_free(input_player_t *player);
+
+/**
+ * Gets the length of each frame of the recorded session.
+ *
+ * @param player a pointer to a player returned from input_player_init()
+ * @return the frame length passed to input_recorder_init(), in seconds
+ */
+double input_player_dt(input_player_t *player);
+
+/**
+ * Gets the number of frames the recorded session ran for.
+ *
+ * @param player a pointer to a player returned from input_player_init()
+ * @return the number of frames passed to input_recorder_free()
+ */
+uint32_t input_player_num_frames(input_player_t *player);
+
+/**
+ * Takes the next recorded input of a frame, in the order it was recorded.
+ * Inputs of earlier frames that were never taken are skipped.
+ *
+ * @param player a pointer to a player returned from input_player_init()
+ * @param frame the frame being played
+ * @param event where to store the input
+ * @return whether there was another input on the frame
+ */
+bool input_player_next(input_player_t *player, uint32_t frame,
+                       journal_event_t *event);
+
+#endif // #ifndef __INPUT_JOURNAL_H__
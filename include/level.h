@@ -0,0 +1,140 @@
+#ifndef __LEVEL_H__
+#define __LEVEL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * The layout of a game level, read from a file:
+ * an ordered list of records, each describing one thing to put in the level.
+ * Records are built in file order, since bodies only get forces
+ * with the bodies added before them.
+ *
+ * A level has two forms. The text form is for writing levels by hand:
+ * one record per line, a keyword followed by numbers separated by spaces
+ * (or, for a background, an image path). Blank lines and lines
+ * starting with '#' are ignored. The keywords and their values are:
+ *
+ *   restrict_portals                    only the first portal can be shot
+ *   background <image path>             an image covering the window
+ *   gravity                             a gravitational field
+ *   wall <x> <y> <width> <height>       a wall, centered at (x, y)
+ *   surface <x> <y> <width> <height>    a surface that can be stood on
+ *   portal_surface <x> <y> <width> <height>
+ *                                       a surface that portals stick to
+ *   portal_surface_polygon <x> <y> <x1> <y1> <x2> <y2> <x3> <y3> ...
+ *                                       a polygonal portal surface,
+ *                                       moved to be centered at (x, y)
+ *   portal <1 or 2> <x> <y> <dx> <dy>   a portal facing direction (dx, dy)
+ *   exit <x> <y>                        the area that ends the level
+ *   platform <x> <y> <angle> <time> <dx> <dy> <px> <py>
+ *                                       a platform tilted by angle degrees,
+ *                                       which turns back to level around
+ *                                       (px, py) and moves by (dx, dy)
+ *                                       over time seconds when triggered
+ *   button <x> <y> <platform> ...       a button moving the given platforms,
+ *                                       numbered from 0 in file order
+ *   player <x> <y> <facing>             the player, facing left if facing
+ *                                       is negative and right otherwise
+ *   box <x> <y>                         a box the player can carry
+ *   timer <seconds>                     the time limit, and its display
+ *   portal_gun                          the player's portal gun
+ *
+ * A level must have exactly one player, at least one exit and exactly
+ * one timer. Boxes and the portal gun must come after the player,
+ * and buttons after the platforms they move.
+ *
+ * The binary form holds the same records, laid out so it can be used
+ * straight from memory once the file is read (see level_write_binary()).
+ * Loading it does no parsing, so levels can be switched cheaply.
+ */
+typedef struct level level_t;
+
+/** The kinds of records in a level */
+typedef enum {
+  LEVEL_RESTRICT_PORTALS,
+  LEVEL_BACKGROUND,
+  LEVEL_GRAVITY,
+  LEVEL_WALL,
+  LEVEL_SURFACE,
+  LEVEL_PORTAL_SURFACE,
+  LEVEL_PORTAL_SURFACE_POLYGON,
+  LEVEL_PORTAL,
+  LEVEL_EXIT,
+  LEVEL_PLATFORM,
+  LEVEL_BUTTON,
+  LEVEL_PLAYER,
+  LEVEL_BOX,
+  LEVEL_TIMER,
+  LEVEL_PORTAL_GUN,
+  // The number of kinds of records, not a kind itself
+  LEVEL_NUM_KINDS
+} level_record_kind_t;
+
+/** One record of a level, pointing into the level's memory */
+typedef struct level_record {
+  level_record_kind_t kind;
+  // The numbers after the keyword, in the order they were written
+  const double *values;
+  size_t num_values;
+  // For LEVEL_BACKGROUND, the image path; otherwise NULL
+  const char *string;
+} level_record_t;
+
+/**
+ * Reads a level file in either form.
+ * The binary form is recognized by the magic number it starts with.
+ *
+ * @param filename the path of the level file
+ * @return a pointer to the newly allocated level,
+ *   or NULL if the file could not be read or is not a valid level;
+ *   the reason, with its line or record number, is printed
+ */
+level_t *level_load(const char *filename);
+
+/**
+ * Parses the text form of a level from memory.
+ *
+ * @param text the contents of a text level file, ending in '\0'
+ * @param name the name to print in error messages
+ * @return a pointer to the newly allocated level,
+ *   or NULL if the text is not a valid level
+ */
+level_t *level_parse(const char *text, const char *name);
+
+/**
+ * Writes the binary form of a level.
+ * The file is only valid on machines with the same byte order.
+ *
+ * @param level a pointer to a level returned from level_load()
+ * @param filename the path of the file to write; it is overwritten
+ * @return whether the whole file was written
+ */
+bool level_write_binary(level_t *level, const char *filename);
+
+/**
+ * Releases the memory allocated for a level.
+ * Records and strings taken from the level are no longer valid.
+ *
+ * @param level a pointer to a level returned from level_load()
+ */
+void level_free(level_t *level);
+
+/**
+ * Gets the number of records in a level.
+ *
+ * @param level a pointer to a level returned from level_load()
+ * @return the number of records
+ */
+size_t level_num_records(level_t *level);
+
+/**
+ * Gets a record of a level. Asserts that the index is valid.
+ *
+ * @param level a pointer to a level returned from level_load()
+ * @param index the index of the record, in file order
+ * @return the record
+ */
+level_record_t level_get_record(level_t *level, size_t index);
+
+#endif // #ifndef __LEVEL_H__
@@ -1,6 +1,7 @@
 #ifndef __LIST_H__
 #define __LIST_H__
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /**
@@ -16,6 +17,15 @@ typedef struct list list_t;
  */
 typedef void (*free_func_t)(void *);
 
+/**
+ * A function that decides whether list_compact() should remove an element.
+ *
+ * @param element an element of the list
+ * @param aux the auxiliary value passed to list_compact()
+ * @return whether to remove the element
+ */
+typedef bool (*list_predicate_t)(void *element, void *aux);
+
 /**
  * Allocates memory for a new list with space for the given number of elements.
  * The list is initially empty.
@@ -66,6 +76,30 @@ void list_set(list_t *lst, void *value, size_t index);
  */
 void *list_remove(list_t *list, size_t index);
 
+/**
+ * Removes the element at a given index in a list and returns it,
+ * moving the last element into its place.
+ * Takes constant time, but does not preserve the order of the list.
+ * Asserts that the index is valid, given the list's current size.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param index an index in the list (the first element is at 0)
+ * @return the element at the given index in the list
+ */
+void *list_swap_remove(list_t *list, size_t index);
+
+/**
+ * Removes every element of a list that matches a predicate in a single pass,
+ * keeping the remaining elements in their original order.
+ * If the list has a freer, it is called on each removed element.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param should_remove the predicate to call on each element
+ * @param aux an auxiliary value to pass to the predicate
+ * @return the number of elements removed
+ */
+size_t list_compact(list_t *list, list_predicate_t should_remove, void *aux);
+
 /**
  * Appends an element to the end of a list.
  * If the list is filled to capacity, resizes the list to fit more elements
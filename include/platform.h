@@ -45,4 +45,20 @@ void platform_change_is_moving(platform_t *platform, bool is_moving);
  * @param platform a pointer to a platform struct
  * @param dt the number of seconds elapsed since the last tick
  */
-void platform_tick(platform_t *platform, double dt);
\ No newline at end of file
+void platform_tick(platform_t *platform, double dt);
+/**
+ * Gets how far a platform has moved, as the time it has spent moving.
+ *
+ * @param platform a pointer to a platform struct
+ * @return the number of seconds of its motion the platform has completed
+ */
+double platform_get_motion_time(platform_t *platform);
+
+/**
+ * Sets how far a platform has moved, without moving its body.
+ * Used to put a platform back together with its body's saved state.
+ *
+ * @param platform a pointer to a platform struct
+ * @param sum_motion_time a value returned from platform_get_motion_time()
+ */
+void platform_set_motion_time(platform_t *platform, double sum_motion_time);
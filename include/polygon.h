@@ -7,6 +7,212 @@
 
 #include "../include/list.h"
 #include "../include/vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A polygon whose vertices are stored inline, in one contiguous array.
+ * The vertices are listed in a counterclockwise direction.
+ * There is an edge between each pair of consecutive vertices,
+ * plus one between the first and last.
+ *
+ * The list_t-based functions below are kept for legacy callers;
+ * they convert to and from this representation.
+ */
+typedef struct polygon polygon_t;
+
+/**
+ * An axis-aligned bounding box, given by its lower-left and upper-right corners.
+ */
+typedef struct {
+  vector_t min;
+  vector_t max;
+} aabb_t;
+
+/**
+ * Allocates memory for a polygon with the given number of vertices.
+ * All vertices are initially (0, 0).
+ * Asserts that the required memory was allocated.
+ *
+ * @param num_vertices the number of vertices in the polygon
+ * @return a pointer to the newly allocated polygon
+ */
+polygon_t *polygon_init(size_t num_vertices);
+
+/**
+ * Allocates a polygon holding the same vertices as a list of vectors.
+ * Does not free or modify the list.
+ *
+ * @param shape a list of vector_t * describing the polygon
+ * @return a pointer to the newly allocated polygon
+ */
+polygon_t *polygon_from_list(list_t *shape);
+
+/**
+ * Copies the vertices of a polygon into a new list of vectors.
+ * The list owns its vectors, so it must be list_free()d.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return a newly allocated list of vector_t *
+ */
+list_t *polygon_to_list(polygon_t *polygon);
+
+/**
+ * Allocates a copy of a polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return a pointer to the newly allocated copy
+ */
+polygon_t *polygon_copy(polygon_t *polygon);
+
+/**
+ * Releases the memory allocated for a polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ */
+void polygon_free(polygon_t *polygon);
+
+/**
+ * Gets the number of vertices in a polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return the number of vertices
+ */
+size_t polygon_size(polygon_t *polygon);
+
+/**
+ * Gets the vertex array of a polygon.
+ * The array has polygon_size() elements and is owned by the polygon;
+ * writing to it mutates the polygon. After writing to the vertices of a
+ * polygon whose area, centroid, etc. were already asked for,
+ * call polygon_vertices_changed().
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return a pointer to the first vertex
+ */
+vector_t *polygon_vertices(polygon_t *polygon);
+
+/**
+ * Tells a polygon that its vertices were written through polygon_vertices(),
+ * so the shape data it caches must be computed again.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ */
+void polygon_vertices_changed(polygon_t *polygon);
+
+/**
+ * Computes the area of a packed polygon.
+ * See polygon_area().
+ *
+ * The area, centroid, radius, moment of inertia, and edge normals
+ * are computed together the first time any of them is asked for,
+ * and cached in the polygon. Translating and rotating the polygon
+ * (including copying it with polygon_transform_packed())
+ * keeps them up to date without recomputing them.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return the area of the polygon
+ */
+double polygon_area_packed(polygon_t *polygon);
+
+/**
+ * Computes the center of mass of a packed polygon.
+ * See polygon_centroid().
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return the centroid of the polygon
+ */
+vector_t polygon_centroid_packed(polygon_t *polygon);
+
+/**
+ * Gets the distance from the centroid of a packed polygon
+ * to its farthest vertex.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return the radius of the polygon
+ */
+double polygon_radius(polygon_t *polygon);
+
+/**
+ * Gets the moment of inertia of a packed polygon with uniform density
+ * about its centroid, for a unit mass. Multiply it by a mass to get the
+ * moment of inertia of a body with that mass.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return the moment of inertia per unit mass
+ */
+double polygon_moment_of_inertia(polygon_t *polygon);
+
+/**
+ * Gets the outward unit normals of the edges of a packed polygon.
+ * Normal i belongs to the edge from vertex i to vertex i + 1
+ * (or to vertex 0, for the last edge).
+ * The array is owned by the polygon and is valid until it changes.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return a pointer to the first of polygon_size() normals
+ */
+const vector_t *polygon_edge_normals(polygon_t *polygon);
+
+/**
+ * Translates all vertices in a packed polygon by a given vector.
+ * See polygon_translate().
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param translation the vector to add to each vertex's position
+ */
+void polygon_translate_packed(polygon_t *polygon, vector_t translation);
+
+/**
+ * Rotates vertices in a packed polygon by a given angle about a given point.
+ * See polygon_rotate().
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param angle the angle to rotate the polygon, in radians.
+ * A positive angle means counterclockwise.
+ * @param point the point to rotate around
+ */
+void polygon_rotate_packed(polygon_t *polygon, double angle, vector_t point);
+
+/**
+ * Sets the vertices of a packed polygon to those of another,
+ * rotated around (0, 0) and then translated.
+ * The polygons must have the same number of vertices.
+ *
+ * @param polygon a pointer to the polygon to overwrite
+ * @param source a pointer to the polygon to read from
+ * @param rotation the rotation to apply, from rotation_from_angle()
+ * @param translation the vector to add to each rotated vertex
+ */
+void polygon_transform_packed(polygon_t *polygon, polygon_t *source,
+                              rotation_t rotation, vector_t translation);
+
+/**
+ * Computes the smallest axis-aligned box containing a packed polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return the bounding box of the polygon
+ */
+aabb_t polygon_bounds(polygon_t *polygon);
+
+/**
+ * Translates a bounding box by a given vector.
+ *
+ * @param box the bounding box to translate
+ * @param translation the vector to add to both corners
+ * @return the translated bounding box
+ */
+aabb_t aabb_translate(aabb_t box, vector_t translation);
+
+/**
+ * Determines whether two bounding boxes overlap.
+ * Boxes that only touch along an edge are considered overlapping.
+ *
+ * @param box1 the first bounding box
+ * @param box2 the second bounding box
+ * @return whether the boxes overlap
+ */
+bool aabb_overlaps(aabb_t box1, aabb_t box2);
 
 /**
  * Computes the area of a polygon.
@@ -1,5 +1,4 @@
 #include "../include/body.h"
-#include "../include/sdl_wrapper.h"
 #include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -52,6 +51,11 @@ body_t *portal_get_body(portal_t *portal);
  */
 vector_t portal_get_direction(portal_t *portal);
 
+/**
+ * Loads the sound effect played by portal_tick() ahead of time.
+ */
+void portal_preload_sound(void);
+
 /**
  * Updates the position and velocity of the transport_body if it
  * teleports through portal to other_portal. 
@@ -0,0 +1,58 @@
+#ifndef __RASTER_BACKEND_H__
+#define __RASTER_BACKEND_H__
+
+#include "render_backend.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Allocates memory for a backend that draws scenes on the CPU
+ * into an in-memory image, without SDL or a display.
+ * Scenes are mapped onto the image the same way sdl_init() maps them
+ * onto the window, so frames can be compared with what SDL draws.
+ *
+ * Bodies are drawn as filled polygons. Image files are not decoded:
+ * a body's image is drawn as its bounding box in a flat color
+ * picked from the image's path, and text as a box in the text's color.
+ * Asserts that the required memory is allocated.
+ *
+ * @param width the width of the image in pixels
+ * @param height the height of the image in pixels
+ * @param min the x and y coordinates of the bottom left of the scene
+ * @param max the x and y coordinates of the top right of the scene
+ * @return a pointer to the newly allocated backend
+ */
+render_backend_t *raster_backend_init(size_t width, size_t height,
+                                      vector_t min, vector_t max);
+
+/**
+ * Gets the image the last frame was drawn into.
+ * Pixels are stored row by row from the top left, 4 bytes per pixel
+ * in the order red, green, blue, alpha.
+ *
+ * @param backend a pointer to a backend returned from raster_backend_init()
+ * @return the pixels, which are overwritten by the next frame
+ */
+const uint8_t *raster_backend_pixels(render_backend_t *backend);
+
+/**
+ * Gets the number of frames a raster backend has drawn.
+ *
+ * @param backend a pointer to a backend returned from raster_backend_init()
+ * @return the number of calls to render_scene() while it was active
+ */
+size_t raster_backend_frames(render_backend_t *backend);
+
+/**
+ * Writes the last frame to a binary PPM (P6) file, dropping alpha.
+ *
+ * @param backend a pointer to a backend returned from raster_backend_init()
+ * @param filename the path of the file to write
+ * @return whether the whole file was written
+ */
+bool raster_backend_write_ppm(render_backend_t *backend,
+                              const char *filename);
+
+#endif // #ifndef __RASTER_BACKEND_H__
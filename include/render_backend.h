@@ -0,0 +1,153 @@
+#ifndef __RENDER_BACKEND_H__
+#define __RENDER_BACKEND_H__
+
+#include "body.h"
+#include "list.h"
+#include "scene.h"
+#include <stddef.h>
+
+/**
+ * The functions a renderer provides for drawing scenes,
+ * for loading the images that bodies display, and for playing sounds.
+ * Scene and game code goes through the active backend
+ * instead of calling SDL directly, so the same code can run
+ * with a window (see sdl_get_backend()) or without one
+ * (see null_backend_init()).
+ */
+typedef struct render_backend {
+  /**
+   * Gets an image from a file and takes a reference to it.
+   * May return NULL if the backend doesn't load images.
+   */
+  image_t *(*acquire_image)(void *aux, const char *image_filename);
+  /** Takes another reference to an image returned by acquire_image */
+  void (*retain_image)(void *aux, image_t *image);
+  /** Releases a reference taken by acquire_image or retain_image */
+  void (*release_image)(void *aux, image_t *image);
+  /** Draws every body in a scene as one frame */
+  void (*render_scene)(void *aux, scene_t *scene);
+  /** Plays a sound effect from a file, or NULL if the backend is silent */
+  void (*play_sound)(void *aux, const char *sound_filename);
+  /** Loads a sound effect ahead of time, or NULL if there is nothing to do */
+  void (*preload_sound)(void *aux, const char *sound_filename);
+  /** Any state the backend needs, passed to each of its functions */
+  void *aux;
+  /** A function to free aux when the backend is freed, or NULL */
+  free_func_t aux_freer;
+} render_backend_t;
+
+/**
+ * Allocates memory for a backend that draws nothing and loads no images,
+ * for running scenes with no window or display (e.g. in tests or
+ * benchmarks). It only counts the frames and bodies it is asked to draw.
+ * Asserts that the required memory is allocated.
+ *
+ * @return a pointer to the newly allocated backend
+ */
+render_backend_t *null_backend_init(void);
+
+/**
+ * Gets the number of frames a null backend has been asked to draw.
+ *
+ * @param backend a pointer to a backend returned from null_backend_init()
+ * @return the number of calls to render_scene() while it was active
+ */
+size_t null_backend_frames(render_backend_t *backend);
+
+/**
+ * Gets the number of bodies a null backend has been asked to draw,
+ * summed over every frame.
+ *
+ * @param backend a pointer to a backend returned from null_backend_init()
+ * @return the total number of bodies in the scenes passed to render_scene()
+ */
+size_t null_backend_bodies_drawn(render_backend_t *backend);
+
+/**
+ * Releases the memory allocated for a backend, including its aux value.
+ * The backend must not be active.
+ *
+ * @param backend a pointer to a backend returned from an *_init() function
+ */
+void render_backend_free(render_backend_t *backend);
+
+/**
+ * Sets the backend that draws scenes and loads images.
+ * Should be set before any bodies with images are created,
+ * since their images are released through the backend active at the time.
+ *
+ * @param backend the backend to use, or NULL to draw nothing
+ *   and give bodies no images
+ */
+void render_set_backend(render_backend_t *backend);
+
+/**
+ * Gets the backend that draws scenes and loads images.
+ *
+ * @return the active backend, or NULL if none has been set
+ */
+render_backend_t *render_get_backend(void);
+
+/**
+ * Gets an image from a file through the active backend
+ * and takes a reference to it.
+ *
+ * @param image_filename a pointer to the filepath of the image
+ * @return the image, or NULL if there is no backend
+ *   or the backend did not load it
+ */
+image_t *render_acquire_image(const char *image_filename);
+
+/**
+ * Takes another reference to an image through the active backend.
+ *
+ * @param image an image returned from render_acquire_image()
+ * @return the same image
+ */
+image_t *render_retain_image(image_t *image);
+
+/**
+ * Releases a reference to an image through the active backend.
+ *
+ * @param image an image returned from render_acquire_image()
+ */
+void render_release_image(image_t *image);
+
+/**
+ * Draws all bodies in a scene with the active backend.
+ * Does nothing if there is no backend.
+ *
+ * @param scene the scene to draw
+ */
+void render_scene(scene_t *scene);
+
+/**
+ * Plays a sound effect through the active backend.
+ * Does nothing if there is no backend or it plays no sounds.
+ *
+ * @param sound_filename a pointer to the filepath of the sound
+ */
+void render_play_sound(const char *sound_filename);
+
+/**
+ * Loads a sound effect through the active backend ahead of time,
+ * so the first render_play_sound() of it doesn't wait on the disk.
+ * Does nothing if there is no backend or it plays no sounds.
+ *
+ * @param sound_filename a pointer to the filepath of the sound
+ */
+void render_preload_sound(const char *sound_filename);
+
+/**
+ * Finds where to draw a body between its previous and current positions,
+ * for backends drawing a scene that uses a fixed timestep.
+ *
+ * @param body the body being drawn
+ * @param alpha the scene's interpolation alpha
+ *   (see scene_get_interpolation_alpha())
+ * @return the translation from the body's current position
+ *   to where it should be drawn
+ */
+vector_t render_interpolation_offset(body_t *body, double alpha);
+
+#endif // #ifndef __RENDER_BACKEND_H__
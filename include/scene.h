@@ -3,6 +3,8 @@
 
 #include "body.h"
 #include "list.h"
+#include "polygon.h"
+#include "spatial_hash.h"
 
 /**
  * A collection of bodies and force creators.
@@ -18,6 +20,13 @@ typedef struct scene scene_t;
  */
 typedef void (*force_creator_t)(void *aux);
 
+/**
+ * A function which runs game logic before each tick of a scene,
+ * e.g. moving platforms or checking for teleports.
+ * Takes in an auxiliary value and the length of the coming tick, in seconds.
+ */
+typedef void (*tick_handler_t)(void *aux, double dt);
+
 /**
  * Allocates memory for an empty scene.
  * Makes a reasonable guess of the number of bodies to allocate space for.
@@ -104,10 +113,148 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
  * and then ticking each body (see body_tick()).
  * If any bodies are marked for removal, they should be removed from the scene
  * and freed, along with any force creators acting on them.
+ * The remaining bodies and force creators keep their order.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param dt the time elapsed since the last tick, in seconds
  */
 void scene_tick(scene_t *scene, double dt);
 
+/**
+ * Makes scene_advance() step the scene in ticks of a fixed length.
+ * Frame times are added to an accumulator and whole ticks are taken from it,
+ * so the simulation gives the same results however fast frames are drawn
+ * and a slow frame can never make one huge tick that skips past thin walls.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param dt the length of each tick, in seconds,
+ *   or 0 to pass each frame's time straight to scene_tick() again
+ * @param max_substeps the most ticks to take in one call to scene_advance();
+ *   time beyond that is dropped, so the simulation slows down under load
+ *   instead of falling further behind every frame
+ */
+void scene_set_fixed_timestep(scene_t *scene, double dt, size_t max_substeps);
+
+/**
+ * Advances a scene by the time elapsed since the last frame.
+ * Without a fixed timestep, this is a single call to scene_tick().
+ * Game logic that must keep pace with the physics goes in before_tick,
+ * which is called before every tick with that tick's length,
+ * so it never runs with a whole frame's time or on frames with no ticks.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param elapsed the time elapsed since the last frame, in seconds
+ * @param before_tick a function to call before each tick, or NULL
+ * @param aux the auxiliary value to pass to before_tick
+ * @return the number of ticks taken
+ */
+size_t scene_advance(scene_t *scene, double elapsed, tick_handler_t before_tick,
+                     void *aux);
+
+/**
+ * Gets how far the scene's accumulated time is between the previous tick
+ * and the next one, for blending body positions when rendering.
+ * A body should be drawn at previous + alpha * (current - previous),
+ * using body_get_previous_centroid() and body_get_centroid().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return a fraction in [0, 1); always 1 without a fixed timestep
+ */
+double scene_get_interpolation_alpha(scene_t *scene);
+
+/**
+ * A copy of the state of every body in a scene at one moment,
+ * so the scene can be put back to that moment without rebuilding it.
+ */
+typedef struct scene_snapshot scene_snapshot_t;
+
+/**
+ * Saves the position, rotation, velocity, visibility, and removal flag
+ * of every body in a scene, along with the time it has accumulated.
+ * Force creators are not saved; they are assumed to keep no state
+ * that matters across a restore.
+ * Asserts that the required memory is allocated.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return a pointer to the newly allocated snapshot
+ */
+scene_snapshot_t *scene_snapshot(scene_t *scene);
+
+/**
+ * Puts a scene back to the state saved in a snapshot.
+ * Bodies added since the snapshot are marked for removal.
+ * This only copies saved values back, so it is much cheaper than
+ * building the scene again, but it is impossible once any body
+ * from the snapshot has been removed from the scene and freed.
+ *
+ * @param scene the scene the snapshot was taken of
+ * @param snapshot a pointer to a snapshot returned from scene_snapshot()
+ * @return whether the scene was restored; if not, it is unchanged
+ */
+bool scene_restore(scene_t *scene, scene_snapshot_t *snapshot);
+
+/**
+ * Releases the memory allocated for a snapshot.
+ *
+ * @param snapshot a pointer to a snapshot returned from scene_snapshot()
+ */
+void scene_snapshot_free(scene_snapshot_t *snapshot);
+
+/**
+ * Makes the scene keep a spatial hash of its bodies as a collision broad phase.
+ * The bodies are rebinned once per tick, the first time the grid is needed,
+ * so scene_query_bounds() and scene_for_each_pair() only do work
+ * proportional to the bodies near each other instead of all pairs.
+ * Calling this again replaces the grid with one of the new cell size,
+ * and it replaces a sweep-and-prune broad phase if one was enabled.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param cell_size the side length of each grid cell;
+ *   about the size of the typical moving body works well
+ */
+void scene_enable_spatial_hash(scene_t *scene, double cell_size);
+
+/**
+ * Makes the scene keep a sweep-and-prune broad phase over its bodies,
+ * replacing any spatial hash.
+ * Bodies are sorted by the x-extents of their bounding boxes, and the order
+ * and overlapping pairs are repaired incrementally once per tick,
+ * so the cost follows how much the bodies move rather than how many there are.
+ * Best suited to scenes of mostly static bodies with a few movers.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_enable_sweep_prune(scene_t *scene);
+
+/**
+ * Finds all bodies in a scene whose bounding boxes overlap a given box.
+ * Bodies marked for removal are skipped.
+ * Uses the broad phase if one is enabled, or checks every body otherwise.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param bounds the box to search
+ * @param results a list to append the matching body_t * to;
+ *   it should not own its elements
+ */
+void scene_query_bounds(scene_t *scene, aabb_t bounds, list_t *results);
+
+/**
+ * Calls a handler on every pair of bodies in a scene
+ * whose bounding boxes overlap.
+ * Each unordered pair is reported once.
+ * Uses the broad phase if one is enabled, or checks every pair otherwise.
+ *
+ * Like force creators registered on individual pairs, bodies marked for
+ * removal are still reported until the end of the tick.
+ * Bodies moved earlier in the tick (e.g. by another force creator calling
+ * body_set_centroid()) are found where they are now.
+ * Bodies added by the handler are not seen until the next call.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param handler the function to call on each pair
+ * @param aux an auxiliary value to pass to the handler
+ */
+void scene_for_each_pair(scene_t *scene, body_pair_handler_t handler,
+                         void *aux);
+
 #endif // #ifndef __SCENE_H__
@@ -2,7 +2,10 @@
 #define __SDL_WRAPPER_H__
 
 #include "color.h"
+#include "frame_stats.h"
 #include "list.h"
+#include "polygon.h"
+#include "render_backend.h"
 #include "scene.h"
 #include "state.h"
 #include "vector.h"
@@ -64,7 +67,8 @@ typedef void (*key_handler_t)(state_t *state, char key, key_event_type_t type,
                               double held_time);
 
 /**
- * Initializes the SDL window and renderer.
+ * Initializes the SDL window and renderer,
+ * and makes SDL the active render backend (see render_set_backend()).
  * Must be called once before any of the other SDL functions.
  *
  * @param min the x and y coordinates of the bottom left of the scene
@@ -87,16 +91,18 @@ bool sdl_is_done(state_t *state);
 void sdl_clear(void);
 
 /**
- * Draws a polygon from the given list of vertices and a color.
+ * Draws a polygon from the given packed vertices and a color.
  *
- * @param points the list of vertices of the polygon
+ * @param points the packed vertices of the polygon
  * @param color the color used to fill in the polygon
  */
-void sdl_draw_polygon(list_t *points, rgb_color_t color);
+void sdl_draw_polygon(polygon_t *points, rgb_color_t color);
 
 /**
  * Displays the rendered frame on the SDL window.
  * Must be called after drawing the polygons in order to show them.
+ * Images and text are batched by texture and only submitted here
+ * (or before the next polygon drawn with sdl_draw_polygon()).
  */
 void sdl_show(void);
 
@@ -104,11 +110,21 @@ void sdl_show(void);
  * Draws all bodies in a scene.
  * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
  * so those functions should not be called directly.
+ * If the scene uses a fixed timestep, each body is drawn between its
+ * previous and current positions (see scene_get_interpolation_alpha()).
  *
  * @param scene the scene to draw
  */
 void sdl_render_scene(scene_t *scene);
 
+/**
+ * Gets the render backend that draws with SDL.
+ * It is made active by sdl_init(), and is never freed.
+ *
+ * @return the SDL backend
+ */
+render_backend_t *sdl_get_backend(void);
+
 /**
  * Registers a function to be called every time a key is pressed.
  * Overwrites any existing handler.
@@ -132,8 +148,70 @@ vector_t sdl_get_mouse_pos();
 */
 SDL_Texture *sdl_load_image(const char *image_filename);
 
+/**
+ * Gets an image from a file, loading it the first time it is requested,
+ * and takes a reference to it.
+ * Images stay loaded after their last reference is released,
+ * so reloading a level that uses the same images costs nothing;
+ * sdl_trim_images() unloads the unreferenced ones.
+ *
+ * @param image_filename a pointer to the filepath of the image
+ * @return the cached image, or NULL if it could not be loaded
+ */
+image_t *sdl_acquire_image(const char *image_filename);
+
+/**
+ * Takes another reference to an image.
+ *
+ * @param image an image returned from sdl_acquire_image()
+ * @return the same image
+ */
+image_t *sdl_retain_image(image_t *image);
+
+/**
+ * Releases a reference to an image taken by sdl_acquire_image()
+ * or sdl_retain_image().
+ *
+ * @param image the image to release
+ */
+void sdl_release_image(image_t *image);
+
+/**
+ * Unloads every cached image that no longer has any references.
+ */
+void sdl_trim_images(void);
+
+/**
+ * Unloads every cached image, referenced or not.
+ * Meant to be called when the program exits.
+ */
+void sdl_free_images(void);
+
+/**
+ * Loads a set of small images into one shared texture,
+ * so drawing any of them uses the same texture and can be batched.
+ * Images that are already loaded or larger than 256 pixels on a side
+ * are left out. Packed images are then returned by sdl_acquire_image().
+ *
+ * @param image_filenames the filepaths of the images to pack
+ * @param num_images the number of filepaths
+ */
+void sdl_pack_images(const char *image_filenames[], size_t num_images);
+
+/**
+ * Draws an image stretched to fill a rectangle.
+ * Consecutive draws from the same texture are submitted together.
+ *
+ * @param image an image returned from sdl_acquire_image()
+ * @param dest_rect the rectangle on screen to draw the image in
+ */
+void sdl_draw_image(image_t *image, SDL_Rect *dest_rect);
+
 /**
  * Creates a text object to be rendered.
+ * The font is opened once and cached (see sdl_get_font()),
+ * but each call still rasterizes a new texture;
+ * text that changes often should use body_set_label() instead.
  * 
  * @param text string representing the text to be rendered
  * @param text_color color of the text
@@ -146,12 +224,66 @@ SDL_Texture *sdl_load_text(char *text, rgb_color_t text_color,
                            const char *font_filename, size_t font_size);
 
 /**
- * Initializes and plays the sound effect with the inputted sound file.
+ * Gets a font at a given size, opening it the first time it is requested.
+ * Later calls with the same file and size return the same font.
+ *
+ * @param font_filename filepath containing the font file
+ * @param font_size size of the font
+ * @return the cached font, or NULL if the file could not be opened
+ */
+font_t *sdl_get_font(const char *font_filename, size_t font_size);
+
+/**
+ * Draws a line of text, stretched to fill a rectangle.
+ * Each character is copied from a texture holding all of the font's
+ * printable ASCII glyphs, which is rasterized the first time the font
+ * draws anything; other characters are skipped.
+ *
+ * @param font a font returned from sdl_get_font()
+ * @param text the text to draw
+ * @param color the color of the text
+ * @param dest_rect the rectangle on screen to draw the text in
+ */
+void sdl_draw_text(font_t *font, const char *text, rgb_color_t color,
+                   SDL_Rect *dest_rect);
+
+/**
+ * Closes every cached font and frees its glyphs.
+ * Labels must not be drawn with those fonts afterwards.
+ */
+void sdl_free_fonts(void);
+
+/**
+ * Plays the sound effect in the inputted sound file.
+ * The file is only read and decoded the first time it is played
+ * (or preloaded); later calls reuse the decoded sound.
  * 
  * @param sound_filename a pointer to the filepath
 */
 void sdl_play_sound(const char *sound_filename);
 
+/**
+ * Reads and decodes a sound effect ahead of time,
+ * so the first sdl_play_sound() of it doesn't wait on the disk.
+ * Meant to be called while a level is loading.
+ *
+ * @param sound_filename a pointer to the filepath
+ */
+void sdl_preload_sound(const char *sound_filename);
+
+/**
+ * Turns off sound effects and music for the rest of the program,
+ * e.g. when running without a display. Must be called before any sound
+ * is played. Sounds are also turned off if the mixer fails to open.
+ */
+void sdl_disable_audio(void);
+
+/**
+ * Stops all sound effects and frees every decoded sound.
+ * Sounds played afterwards are loaded again.
+ */
+void sdl_free_sounds(void);
+
 /**
  * Initializes and starts playing the background music.
  * 
@@ -170,11 +302,22 @@ void sdl_pause_background_music();
 void sdl_resume_background_music();
 
 /**
- * Gets the amount of time that has passed since the last time
+ * Gets the amount of wall-clock time that has passed since the last time
  * this function was called, in seconds.
+ * Uses SDL's monotonic high-resolution counter, so the result includes
+ * time spent waiting (e.g. on vsync) and never goes backwards.
+ * Each result is recorded for sdl_get_frame_stats().
  *
  * @return the number of seconds that have elapsed
  */
 double time_since_last_tick(void);
 
+/**
+ * Gets statistics over the most recent frame times
+ * returned by time_since_last_tick().
+ *
+ * @return the minimum, maximum, mean, and 99th percentile frame times
+ */
+frame_summary_t sdl_get_frame_stats(void);
+
 #endif // #ifndef __SDL_WRAPPER_H__
@@ -1,4 +1,5 @@
 #include "../include/list.h"
+#include "../include/polygon.h"
 #include <math.h>
 
 /**
@@ -9,8 +10,28 @@
  */
 double deg_to_rad(double deg);
 
+/**
+ * Create a packed polygon for a rectangular body.
+ * The bottom-left corner is at (0, 0).
+ *
+ * @param width width of the rectangle
+ * @param height height of the rectangle
+ * @return a polygon with 4 vertices
+ */
+polygon_t *make_rect_polygon(double width, double height);
+
+/**
+ * Create a packed polygon for a circular body centered at (0, 0).
+ *
+ * @param radius radius of the circle
+ * @param num_points number of vertices; i.e. resolution of circle
+ * @return a polygon with num_points vertices
+ */
+polygon_t *make_circ_polygon(double radius, size_t num_points);
+
 /**
  * Create a list of points for a rectangular body.
+ * Legacy wrapper around make_rect_polygon().
  *
  * @param width width of the rectangle
  * @param height height of the rectangle
@@ -20,6 +41,7 @@ list_t *make_rect_shape(double width, double height);
 
 /**
  * Create a list of points for a circular body.
+ * Legacy wrapper around make_circ_polygon().
  *
  * @param radius radius of the circle
  * @param num_points number of points in list; i.e. resolution of circle
@@ -0,0 +1,94 @@
+#ifndef __SPATIAL_HASH_H__
+#define __SPATIAL_HASH_H__
+
+#include "body.h"
+#include "polygon.h"
+#include <stddef.h>
+
+/**
+ * A uniform grid of square cells used as a collision broad phase.
+ * Each body is binned into every cell its bounding box touches,
+ * and the cells are stored in a hash table keyed by cell coordinates,
+ * so the grid is unbounded and only occupied cells use memory.
+ *
+ * Bodies are not tracked after insertion: when they move,
+ * the grid must be cleared and rebuilt.
+ */
+typedef struct spatial_hash spatial_hash_t;
+
+/**
+ * A function called on a pair of bodies found by the broad phase.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param aux an auxiliary value passed through from the caller
+ */
+typedef void (*body_pair_handler_t)(body_t *body1, body_t *body2, void *aux);
+
+/**
+ * Allocates memory for an empty spatial hash.
+ * Asserts that the cell size is positive and that the required memory
+ * is allocated.
+ *
+ * @param cell_size the side length of each cell; a good choice is about
+ *   the size of the typical moving body
+ * @return a pointer to the newly allocated spatial hash
+ */
+spatial_hash_t *spatial_hash_init(double cell_size);
+
+/**
+ * Releases the memory allocated for a spatial hash.
+ * Does not free the bodies inserted into it.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ */
+void spatial_hash_free(spatial_hash_t *hash);
+
+/**
+ * Removes all bodies from a spatial hash, keeping its memory for reuse.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ */
+void spatial_hash_clear(spatial_hash_t *hash);
+
+/**
+ * Gets the number of bodies inserted since the hash was last cleared.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @return the number of bodies in the hash
+ */
+size_t spatial_hash_size(spatial_hash_t *hash);
+
+/**
+ * Bins a body into every cell its current bounding box touches.
+ * The bounding box is copied, so later movement of the body is not seen
+ * until the hash is rebuilt.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @param body the body to insert; each body should be inserted at most once
+ */
+void spatial_hash_insert(spatial_hash_t *hash, body_t *body);
+
+/**
+ * Finds every body whose bounding box overlaps a given box.
+ * Each body is reported once.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @param bounds the box to search
+ * @param results a list to append the matching body_t * to;
+ *   it should not own its elements
+ */
+void spatial_hash_query(spatial_hash_t *hash, aabb_t bounds, list_t *results);
+
+/**
+ * Calls a handler on every pair of bodies whose bounding boxes overlap.
+ * Each unordered pair is reported once, in no particular order.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @param handler the function to call on each pair
+ * @param aux an auxiliary value to pass to the handler
+ */
+void spatial_hash_for_each_pair(spatial_hash_t *hash,
+                                body_pair_handler_t handler, void *aux);
+
+#endif // #ifndef __SPATIAL_HASH_H__
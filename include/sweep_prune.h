@@ -0,0 +1,102 @@
+#ifndef __SWEEP_PRUNE_H__
+#define __SWEEP_PRUNE_H__
+
+#include "body.h"
+#include "list.h"
+#include "polygon.h"
+#include "spatial_hash.h"
+#include <stddef.h>
+
+/**
+ * A sweep-and-prune collision broad phase.
+ * Keeps the x-extents of every body's bounding box as one sorted array of
+ * endpoints, plus the set of pairs whose x-extents overlap.
+ *
+ * The array is kept between updates and repaired with insertion sort,
+ * and the pair set is updated from the swaps the sort makes,
+ * so an update costs time proportional to how much the bodies moved
+ * relative to each other rather than to the number of pairs.
+ */
+typedef struct sweep_prune sweep_prune_t;
+
+/**
+ * Allocates memory for an empty sweep-and-prune broad phase.
+ * Asserts that the required memory is allocated.
+ *
+ * @return a pointer to the newly allocated broad phase
+ */
+sweep_prune_t *sweep_prune_init(void);
+
+/**
+ * Releases the memory allocated for a sweep-and-prune broad phase.
+ * Does not free the bodies added to it.
+ *
+ * @param sap a pointer to a broad phase returned from sweep_prune_init()
+ */
+void sweep_prune_free(sweep_prune_t *sap);
+
+/**
+ * Gets the number of bodies tracked by a sweep-and-prune broad phase.
+ *
+ * @param sap a pointer to a broad phase returned from sweep_prune_init()
+ * @return the number of bodies added and not yet removed
+ */
+size_t sweep_prune_size(sweep_prune_t *sap);
+
+/**
+ * Starts tracking a body, using its current bounding box.
+ *
+ * @param sap a pointer to a broad phase returned from sweep_prune_init()
+ * @param body the body to add; it must not already be tracked
+ */
+void sweep_prune_add(sweep_prune_t *sap, body_t *body);
+
+/**
+ * Stops tracking a body. Must be called before the body is freed.
+ * Asserts that the body is tracked.
+ *
+ * @param sap a pointer to a broad phase returned from sweep_prune_init()
+ * @param body the body to remove
+ */
+void sweep_prune_remove(sweep_prune_t *sap, body_t *body);
+
+/**
+ * Stops tracking every body marked for removal with body_remove(),
+ * in a single pass. Must be called before those bodies are freed.
+ *
+ * @param sap a pointer to a broad phase returned from sweep_prune_init()
+ */
+void sweep_prune_remove_marked(sweep_prune_t *sap);
+
+/**
+ * Rereads the bounding boxes of all tracked bodies
+ * and repairs the sorted order and the set of overlapping pairs.
+ *
+ * @param sap a pointer to a broad phase returned from sweep_prune_init()
+ */
+void sweep_prune_update(sweep_prune_t *sap);
+
+/**
+ * Finds every tracked body whose bounding box overlaps a given box,
+ * as of the last update.
+ *
+ * @param sap a pointer to a broad phase returned from sweep_prune_init()
+ * @param bounds the box to search
+ * @param results a list to append the matching body_t * to;
+ *   it should not own its elements
+ */
+void sweep_prune_query(sweep_prune_t *sap, aabb_t bounds, list_t *results);
+
+/**
+ * Calls a handler on every pair of tracked bodies whose bounding boxes
+ * overlap, as of the last update.
+ * Each unordered pair is reported once, in no particular order.
+ *
+ * @param sap a pointer to a broad phase returned from sweep_prune_init()
+ * @param handler the function to call on each pair
+ * @param aux an auxiliary value to pass to the handler
+ */
+void sweep_prune_for_each_pair(sweep_prune_t *sap, body_pair_handler_t handler,
+                               void *aux);
+
+#endif // #ifndef __SWEEP_PRUNE_H__
@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "body.h"
 #include "vector.h"
 
 /**
@@ -76,4 +77,54 @@ void read_testname(char *filename, char *testname, size_t testname_size);
  */
 bool test_assert_fail(void (*run)(void *aux), void *aux);
 
+/**
+ * Returns a random double between min and max, using rand().
+ */
+double rand_range(double min, double max);
+
+/**
+ * Makes a body of mass 1 shaped like a width x height rectangle,
+ * centered at the given point.
+ */
+body_t *make_rect_body(vector_t center, double width, double height);
+
+/**
+ * Returns the index of a body in an array of bodies.
+ * Asserts that the body is in the array.
+ */
+size_t find_body_index(body_t **bodies, size_t num_bodies, body_t *body);
+
+/**
+ * How many times each pair of bodies in an array was reported,
+ * e.g. by a broad phase. Filled in by count_pair().
+ */
+typedef struct pair_counts {
+  body_t **bodies;
+  size_t num_bodies;
+  // num_bodies x num_bodies counts, where pair (i, j) adds to [i][j] and [j][i]
+  int *counts;
+} pair_counts_t;
+
+/**
+ * Allocates pair counts for an array of bodies, all starting at 0.
+ * The array must outlive the counts.
+ */
+pair_counts_t *pair_counts_init(body_t **bodies, size_t num_bodies);
+
+/**
+ * Returns how many times the bodies at indices i and j were reported together.
+ */
+int pair_counts_get(pair_counts_t *pair_counts, size_t i, size_t j);
+
+/**
+ * Releases the memory allocated for pair counts.
+ */
+void pair_counts_free(pair_counts_t *pair_counts);
+
+/**
+ * A body_pair_handler_t that counts each pair it is called with.
+ * aux must be a pair_counts_t *. Asserts that the bodies are distinct.
+ */
+void count_pair(body_t *body1, body_t *body2, void *aux);
+
 #endif // #ifndef __TEST_UTIL_H__
@@ -96,6 +96,33 @@ double vec_cross(vector_t v1, vector_t v2);
  */
 vector_t vec_rotate(vector_t v, double angle);
 
+/**
+ * A rotation by a fixed angle, stored as the cosine and sine of the angle
+ * so that applying it to many vectors doesn't recompute them.
+ */
+typedef struct {
+  double cos;
+  double sin;
+} rotation_t;
+
+/**
+ * Computes the cosine and sine of an angle for rotating by it.
+ *
+ * @param angle the angle in radians. Positive is counterclockwise.
+ * @return the rotation by the angle
+ */
+rotation_t rotation_from_angle(double angle);
+
+/**
+ * Rotates a vector around (0, 0) by a precomputed rotation.
+ * Gives the same result as vec_rotate() with the rotation's angle.
+ *
+ * @param v the vector to rotate
+ * @param rotation a rotation returned from rotation_from_angle()
+ * @return v rotated by the rotation
+ */
+vector_t vec_rotate_by(vector_t v, rotation_t rotation);
+
 double vec_direction_angle(vector_t v);
 
 #endif // #ifndef __VECTOR_H__
@@ -0,0 +1,342 @@
+#include "../include/barnes_hut.h"
+#include "../include/vector.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+const size_t INITIAL_NUM_NODES = 64;
+// Bits of each coordinate in a Morton key, which is also the deepest level
+// of the tree; points closer together than the smallest cell share a leaf
+#define MORTON_BITS 16
+// A node with at most this many points is a leaf and is summed directly
+const size_t LEAF_SIZE = 8;
+// Radix sort digits
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+
+typedef struct bh_node {
+  // Center of mass and total mass of the points under the node
+  vector_t mass_center;
+  double mass;
+  // Width of the node's square
+  double size;
+  // The node's points are sorted[first, first + count)
+  uint32_t first;
+  uint32_t count;
+  // Index of the first of num_children consecutive children;
+  // a leaf has no children
+  int32_t first_child;
+  int32_t num_children;
+} bh_node_t;
+
+typedef struct barnes_hut {
+  bh_node_t *nodes;
+  size_t num_nodes;
+  size_t node_capacity;
+  size_t num_points;
+  size_t point_capacity;
+  // The points in Morton order, copied so leaves are contiguous in memory
+  vector_t *sorted_positions;
+  double *sorted_masses;
+  // order[i] is the original index of sorted point i; slots is its inverse
+  uint32_t *order;
+  uint32_t *slots;
+  // Morton keys of the sorted points, plus scratch for the radix sort
+  uint32_t *keys;
+  uint32_t *scratch_keys;
+  uint32_t *scratch_order;
+} barnes_hut_t;
+
+barnes_hut_t *barnes_hut_init(void) {
+  barnes_hut_t *tree = calloc(1, sizeof(barnes_hut_t));
+  assert(tree);
+  tree->nodes = malloc(INITIAL_NUM_NODES * sizeof(bh_node_t));
+  assert(tree->nodes);
+  tree->node_capacity = INITIAL_NUM_NODES;
+  return tree;
+}
+
+void barnes_hut_free(barnes_hut_t *tree) {
+  free(tree->nodes);
+  free(tree->sorted_positions);
+  free(tree->sorted_masses);
+  free(tree->order);
+  free(tree->slots);
+  free(tree->keys);
+  free(tree->scratch_keys);
+  free(tree->scratch_order);
+  free(tree);
+}
+
+/** Grows the per-point arrays to hold at least num_points points */
+void bh_reserve_points(barnes_hut_t *tree, size_t num_points) {
+  if (num_points <= tree->point_capacity) {
+    return;
+  }
+  size_t capacity = num_points;
+  tree->sorted_positions =
+      realloc(tree->sorted_positions, capacity * sizeof(vector_t));
+  tree->sorted_masses = realloc(tree->sorted_masses, capacity * sizeof(double));
+  tree->order = realloc(tree->order, capacity * sizeof(uint32_t));
+  tree->slots = realloc(tree->slots, capacity * sizeof(uint32_t));
+  tree->keys = realloc(tree->keys, capacity * sizeof(uint32_t));
+  tree->scratch_keys = realloc(tree->scratch_keys, capacity * sizeof(uint32_t));
+  tree->scratch_order =
+      realloc(tree->scratch_order, capacity * sizeof(uint32_t));
+  assert(tree->sorted_positions && tree->sorted_masses && tree->order &&
+         tree->slots && tree->keys && tree->scratch_keys &&
+         tree->scratch_order);
+  tree->point_capacity = capacity;
+}
+
+/**
+ * Appends uninitialized nodes to the tree's pool, growing it if needed.
+ * Since the pool may move, node pointers must be refetched afterwards.
+ */
+int32_t bh_add_nodes(barnes_hut_t *tree, size_t num_nodes) {
+  while (tree->num_nodes + num_nodes > tree->node_capacity) {
+    tree->node_capacity *= 2;
+    tree->nodes =
+        realloc(tree->nodes, tree->node_capacity * sizeof(bh_node_t));
+    assert(tree->nodes);
+  }
+  int32_t index = tree->num_nodes;
+  tree->num_nodes += num_nodes;
+  return index;
+}
+
+/** Spreads the low 16 bits of x out to the even bits of the result */
+uint32_t bh_spread_bits(uint32_t x) {
+  x &= 0xFFFF;
+  x = (x | (x << 8)) & 0x00FF00FF;
+  x = (x | (x << 4)) & 0x0F0F0F0F;
+  x = (x | (x << 2)) & 0x33333333;
+  x = (x | (x << 1)) & 0x55555555;
+  return x;
+}
+
+/** Quantizes a coordinate in [min, min + size] to MORTON_BITS bits */
+uint32_t bh_quantize(double value, double min, double scale) {
+  double cell = (value - min) * scale;
+  uint32_t max_cell = (1 << MORTON_BITS) - 1;
+  return cell >= max_cell ? max_cell : cell <= 0 ? 0 : (uint32_t)cell;
+}
+
+/** Sorts tree->order by tree->keys with an LSD radix sort */
+void bh_sort_by_key(barnes_hut_t *tree) {
+  uint32_t *keys = tree->keys;
+  uint32_t *order = tree->order;
+  uint32_t *scratch_keys = tree->scratch_keys;
+  uint32_t *scratch_order = tree->scratch_order;
+  for (int shift = 0; shift < 2 * MORTON_BITS; shift += RADIX_BITS) {
+    size_t offsets[RADIX_SIZE] = {0};
+    for (size_t i = 0; i < tree->num_points; i++) {
+      offsets[(keys[i] >> shift) & (RADIX_SIZE - 1)]++;
+    }
+    size_t total = 0;
+    for (size_t digit = 0; digit < RADIX_SIZE; digit++) {
+      size_t count = offsets[digit];
+      offsets[digit] = total;
+      total += count;
+    }
+    for (size_t i = 0; i < tree->num_points; i++) {
+      size_t slot = offsets[(keys[i] >> shift) & (RADIX_SIZE - 1)]++;
+      scratch_keys[slot] = keys[i];
+      scratch_order[slot] = order[i];
+    }
+    uint32_t *swap_keys = keys;
+    keys = scratch_keys;
+    scratch_keys = swap_keys;
+    uint32_t *swap_order = order;
+    order = scratch_order;
+    scratch_order = swap_order;
+  }
+  // An even number of passes leaves the result back in the original arrays
+  assert(keys == tree->keys && order == tree->order);
+}
+
+/**
+ * Fills in a node over sorted[first, first + count), whose keys all share
+ * their top 2 * depth bits, and builds its subtree.
+ */
+void bh_build_node(barnes_hut_t *tree, int32_t node, uint32_t first,
+                   uint32_t count, int depth, double size) {
+  tree->nodes[node] = (bh_node_t){.size = size,
+                                  .first = first,
+                                  .count = count,
+                                  .first_child = -1,
+                                  .num_children = 0};
+  if (count <= LEAF_SIZE || depth == MORTON_BITS) {
+    double mass = 0;
+    vector_t weighted = VEC_ZERO;
+    for (uint32_t i = first; i < first + count; i++) {
+      double point_mass = tree->sorted_masses[i];
+      mass += point_mass;
+      weighted.x += point_mass * tree->sorted_positions[i].x;
+      weighted.y += point_mass * tree->sorted_positions[i].y;
+    }
+    tree->nodes[node].mass = mass;
+    tree->nodes[node].mass_center =
+        mass > 0 ? vec_multiply(1 / mass, weighted) : weighted;
+    return;
+  }
+
+  // The points are sorted, so each quadrant is a contiguous run
+  int shift = 2 * (MORTON_BITS - 1 - depth);
+  uint32_t starts[5];
+  uint32_t i = first;
+  for (uint32_t quadrant = 0; quadrant < 4; quadrant++) {
+    starts[quadrant] = i;
+    while (i < first + count && ((tree->keys[i] >> shift) & 3) == quadrant) {
+      i++;
+    }
+  }
+  starts[4] = first + count;
+  int32_t num_children = 0;
+  for (int quadrant = 0; quadrant < 4; quadrant++) {
+    if (starts[quadrant + 1] > starts[quadrant]) {
+      num_children++;
+    }
+  }
+
+  // Reserve all the children together so they stay consecutive
+  int32_t first_child = bh_add_nodes(tree, num_children);
+  tree->nodes[node].first_child = first_child;
+  tree->nodes[node].num_children = num_children;
+  int32_t child = first_child;
+  double mass = 0;
+  vector_t weighted = VEC_ZERO;
+  for (int quadrant = 0; quadrant < 4; quadrant++) {
+    uint32_t child_count = starts[quadrant + 1] - starts[quadrant];
+    if (child_count == 0) {
+      continue;
+    }
+    bh_build_node(tree, child, starts[quadrant], child_count, depth + 1,
+                  size / 2);
+    bh_node_t *built = &tree->nodes[child];
+    mass += built->mass;
+    weighted = vec_add(weighted, vec_multiply(built->mass, built->mass_center));
+    child++;
+  }
+  tree->nodes[node].mass = mass;
+  tree->nodes[node].mass_center =
+      mass > 0 ? vec_multiply(1 / mass, weighted) : weighted;
+}
+
+void barnes_hut_build(barnes_hut_t *tree, vector_t *positions, double *masses,
+                      size_t num_points) {
+  assert(num_points < INT32_MAX);
+  bh_reserve_points(tree, num_points);
+  tree->num_points = num_points;
+  tree->num_nodes = 0;
+
+  // The root is the smallest square around all the points
+  vector_t min = {INFINITY, INFINITY};
+  vector_t max = {-INFINITY, -INFINITY};
+  for (size_t i = 0; i < num_points; i++) {
+    min.x = fmin(min.x, positions[i].x);
+    min.y = fmin(min.y, positions[i].y);
+    max.x = fmax(max.x, positions[i].x);
+    max.y = fmax(max.y, positions[i].y);
+  }
+  double size = 2;
+  if (num_points > 0) {
+    size = fmax(fmax(max.x - min.x, max.y - min.y), 2);
+  }
+
+  // Sort the points along a Z-order curve, so nearby points are
+  // next to each other in memory and every node is a contiguous run
+  double scale = (1 << MORTON_BITS) / size;
+  for (size_t i = 0; i < num_points; i++) {
+    uint32_t x = bh_quantize(positions[i].x, min.x, scale);
+    uint32_t y = bh_quantize(positions[i].y, min.y, scale);
+    tree->keys[i] = bh_spread_bits(x) | bh_spread_bits(y) << 1;
+    tree->order[i] = i;
+  }
+  bh_sort_by_key(tree);
+  for (size_t i = 0; i < num_points; i++) {
+    uint32_t point = tree->order[i];
+    tree->sorted_positions[i] = positions[point];
+    tree->sorted_masses[i] = masses[point];
+    tree->slots[point] = i;
+  }
+
+  int32_t root = bh_add_nodes(tree, 1);
+  bh_build_node(tree, root, 0, num_points, 0, size);
+}
+
+/** Computes the field at the sorted point with the given slot */
+vector_t bh_field_at_slot(barnes_hut_t *tree, uint32_t slot, double theta,
+                          double min_distance) {
+  vector_t position = tree->sorted_positions[slot];
+  double field_x = 0;
+  double field_y = 0;
+  // Compare squared distances so only the masses actually used need a sqrt
+  double theta_squared = theta * theta;
+  double min_distance_squared = min_distance * min_distance;
+
+  // Each level pushes at most 4 nodes and pops one
+  int32_t stack[3 * MORTON_BITS + 4];
+  size_t stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size > 0) {
+    bh_node_t *node = &tree->nodes[stack[--stack_size]];
+    if (node->mass == 0) {
+      continue;
+    }
+    // A node containing the point itself is never far enough to approximate
+    bool contains = slot - node->first < node->count;
+    double dx = node->mass_center.x - position.x;
+    double dy = node->mass_center.y - position.y;
+    double distance_squared = dx * dx + dy * dy;
+    bool far = !contains &&
+               node->size * node->size < theta_squared * distance_squared;
+
+    if (far) {
+      if (distance_squared >= min_distance_squared) {
+        double distance = sqrt(distance_squared);
+        double scale = node->mass / (distance_squared * distance);
+        field_x += scale * dx;
+        field_y += scale * dy;
+      }
+    } else if (node->num_children > 0) {
+      for (int32_t i = 0; i < node->num_children; i++) {
+        stack[stack_size++] = node->first_child + i;
+      }
+    } else {
+      // Sum a leaf's points directly
+      for (uint32_t i = node->first; i < node->first + node->count; i++) {
+        double point_dx = tree->sorted_positions[i].x - position.x;
+        double point_dy = tree->sorted_positions[i].y - position.y;
+        double point_distance_squared =
+            point_dx * point_dx + point_dy * point_dy;
+        if (i != slot && point_distance_squared >= min_distance_squared) {
+          double distance = sqrt(point_distance_squared);
+          double scale = tree->sorted_masses[i] /
+                         (point_distance_squared * distance);
+          field_x += scale * point_dx;
+          field_y += scale * point_dy;
+        }
+      }
+    }
+  }
+  return (vector_t){field_x, field_y};
+}
+
+vector_t barnes_hut_field(barnes_hut_t *tree, size_t index, double theta,
+                          double min_distance) {
+  assert(index < tree->num_points);
+  return bh_field_at_slot(tree, tree->slots[index], theta, min_distance);
+}
+
+void barnes_hut_fields(barnes_hut_t *tree, double theta, double min_distance,
+                       vector_t *fields) {
+  // Consecutive points in Morton order walk nearly the same nodes,
+  // so visiting them in that order keeps the walk in cache
+  for (size_t slot = 0; slot < tree->num_points; slot++) {
+    fields[tree->order[slot]] =
+        bh_field_at_slot(tree, slot, theta, min_distance);
+  }
+}
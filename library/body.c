@@ -2,7 +2,7 @@
 #include "../include/color.h"
 #include "../include/list.h"
 #include "../include/polygon.h"
-#include "../include/sdl_wrapper.h"
+#include "../include/render_backend.h"
 #include "../include/shapes.h"
 #include "../include/vector.h"
 #include <assert.h>
@@ -12,20 +12,48 @@
 #include <stdlib.h>
 #include <string.h>
 
+/**
+ * The identifier given to the next body created.
+ */
+uint64_t next_body_id = 0;
+
 typedef struct body {
-  list_t *shape;
+  uint64_t id;
+  // Where the fields that change every tick are stored:
+  // the own_* fields below, or the arrays of the body's scene
+  body_kinematics_t kinematics;
+  // The vertices relative to the body's origin, before any rotation
+  polygon_t *local_shape;
+  // Where the origin of the local shape is, relative to the centroid.
+  // Zero unless the body was rotated around some other point.
+  vector_t origin_offset;
+  // The world-space vertices and their bounds, built from the local shape
+  // when they are needed. If shape_is_stale, they must be rebuilt;
+  // otherwise, they only need to be moved from shape_centroid to the
+  // current centroid.
+  polygon_t *shape;
+  aabb_t bounds;
+  vector_t shape_centroid;
+  bool shape_is_stale;
   rgb_color_t color;
   double mass;
-  vector_t vel;
-  vector_t centroid;
-  vector_t force;
-  vector_t impulse;
+  vector_t own_centroid;
+  vector_t own_prev_centroid;
+  vector_t own_velocity;
+  vector_t own_force;
+  vector_t own_impulse;
+  double own_inverse_mass;
+  bool own_is_removed;
+  bool own_moved;
   void *info;
   free_func_t info_freer;
-  bool is_removed;
   double rotation;
   SDL_Texture *text;
-  SDL_Texture *image;
+  char *label;
+  size_t label_capacity;
+  font_t *label_font;
+  rgb_color_t label_color;
+  image_t *image;
   const char *image_path;
   bool is_visible;
 } body_t;
@@ -42,22 +70,51 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
 body_t *body_init_with_image(list_t *shape, double mass, rgb_color_t color,
                              void *info, free_func_t info_freer,
                              const char *image_path) {
+  polygon_t *polygon = polygon_from_list(shape);
+  list_free(shape);
+  return body_init_with_polygon(polygon, mass, color, info, info_freer,
+                                image_path);
+}
+
+body_t *body_init_with_polygon(polygon_t *shape, double mass,
+                               rgb_color_t color, void *info,
+                               free_func_t info_freer, const char *image_path) {
   body_t *new_body = calloc(1, sizeof(body_t));
   assert(new_body);
+  new_body->id = next_body_id++;
+  new_body->kinematics =
+      (body_kinematics_t){.centroid = &new_body->own_centroid,
+                          .prev_centroid = &new_body->own_prev_centroid,
+                          .velocity = &new_body->own_velocity,
+                          .force = &new_body->own_force,
+                          .impulse = &new_body->own_impulse,
+                          .inverse_mass = &new_body->own_inverse_mass,
+                          .is_removed = &new_body->own_is_removed,
+                          .moved = &new_body->own_moved};
   new_body->shape = shape;
+  new_body->bounds = polygon_bounds(shape);
+  new_body->local_shape = polygon_copy(shape);
   new_body->color = color;
   new_body->mass = mass;
-  new_body->vel = (vector_t){0.0, 0.0};
-  new_body->centroid = polygon_centroid(shape);
-  new_body->force = (vector_t){0.0, 0.0};
-  new_body->impulse = (vector_t){0.0, 0.0};
+  new_body->own_velocity = (vector_t){0.0, 0.0};
+  new_body->own_centroid = polygon_centroid_packed(shape);
+  new_body->own_prev_centroid = new_body->own_centroid;
+  new_body->shape_centroid = new_body->own_centroid;
+  polygon_translate_packed(new_body->local_shape,
+                           vec_negate(new_body->own_centroid));
+  new_body->origin_offset = VEC_ZERO;
+  new_body->shape_is_stale = false;
+  new_body->own_force = (vector_t){0.0, 0.0};
+  new_body->own_impulse = (vector_t){0.0, 0.0};
+  new_body->own_inverse_mass = 1 / mass;
   new_body->info = info;
   new_body->info_freer = info_freer;
-  new_body->is_removed = false;
+  new_body->own_is_removed = false;
+  new_body->own_moved = false;
   new_body->rotation = 0;
   new_body->text = NULL;
   if (image_path) {
-    new_body->image = sdl_load_image(image_path);
+    new_body->image = render_acquire_image(image_path);
   } else {
     new_body->image = NULL;
   }
@@ -68,26 +125,76 @@ body_t *body_init_with_image(list_t *shape, double mass, rgb_color_t color,
 }
 
 void body_free(body_t *body) {
-  list_free(body->shape);
+  polygon_free(body->shape);
+  polygon_free(body->local_shape);
   if (body->info_freer && body->info) {
     body->info_freer(body->info);
   }
+  if (body->image) {
+    render_release_image(body->image);
+  }
+  free(body->label);
   free(body);
 }
 
+/**
+ * Brings a body's world-space vertices and bounds up to date:
+ * rebuilds them from the local shape if the body has rotated,
+ * or moves them to where its centroid has moved since they were placed.
+ */
+void body_place_shape(body_t *body) {
+  vector_t centroid = *body->kinematics.centroid;
+  if (body->shape_is_stale) {
+    polygon_transform_packed(body->shape, body->local_shape,
+                             rotation_from_angle(body->rotation),
+                             vec_add(centroid, body->origin_offset));
+    body->bounds = polygon_bounds(body->shape);
+    body->shape_centroid = centroid;
+    body->shape_is_stale = false;
+    return;
+  }
+  if (centroid.x == body->shape_centroid.x &&
+      centroid.y == body->shape_centroid.y) {
+    return;
+  }
+  vector_t translation = vec_subtract(centroid, body->shape_centroid);
+  polygon_translate_packed(body->shape, translation);
+  body->bounds = aabb_translate(body->bounds, translation);
+  body->shape_centroid = centroid;
+}
+
 list_t *body_get_shape(body_t *body) {
-  list_t *shape_copy = list_init(list_size(body->shape), free);
-  for (size_t i = 0; i < list_size(body->shape); i++) {
-    vector_t *new_p = malloc(sizeof(vector_t));
-    *new_p = *(vector_t *)list_get(body->shape, i);
-    list_add(shape_copy, new_p);
+  body_place_shape(body);
+  return polygon_to_list(body->shape);
+}
+
+polygon_t *body_peek_shape(body_t *body) {
+  body_place_shape(body);
+  return body->shape;
+}
+
+aabb_t body_get_bounds(body_t *body) {
+  if (body->shape_is_stale) {
+    body_place_shape(body);
+  }
+  vector_t centroid = *body->kinematics.centroid;
+  if (centroid.x == body->shape_centroid.x &&
+      centroid.y == body->shape_centroid.y) {
+    return body->bounds;
   }
-  return shape_copy;
+  return aabb_translate(body->bounds,
+                        vec_subtract(centroid, body->shape_centroid));
 }
 
-vector_t body_get_centroid(body_t *body) { return body->centroid; }
+vector_t body_get_centroid(body_t *body) { return *body->kinematics.centroid; }
 
-vector_t body_get_velocity(body_t *body) { return body->vel; }
+vector_t body_get_previous_centroid(body_t *body) {
+  return *body->kinematics.prev_centroid;
+}
+
+vector_t body_get_velocity(body_t *body) {
+  return *body->kinematics.velocity;
+}
 
 rgb_color_t body_get_color(body_t *body) { return body->color; }
 
@@ -95,15 +202,23 @@ void *body_get_info(body_t *body) { return body->info; }
 
 double body_get_mass(body_t *body) { return body->mass; }
 
-vector_t body_get_force(body_t *body) { return body->force; }
+vector_t body_get_force(body_t *body) { return *body->kinematics.force; }
 
-vector_t body_get_impulse(body_t *body) { return body->impulse; }
+vector_t body_get_impulse(body_t *body) { return *body->kinematics.impulse; }
 
 double body_get_rotation(body_t *body) { return body->rotation; }
 
 SDL_Texture *body_get_text(body_t *body) { return body->text; }
 
-SDL_Texture *body_get_image(body_t *body) { return body->image; }
+const char *body_get_label(body_t *body) {
+  return body->label_font ? body->label : NULL;
+}
+
+font_t *body_get_label_font(body_t *body) { return body->label_font; }
+
+rgb_color_t body_get_label_color(body_t *body) { return body->label_color; }
+
+image_t *body_get_image(body_t *body) { return body->image; }
 
 bool body_get_is_visible(body_t *body) { return body->is_visible; }
 
@@ -113,20 +228,56 @@ void body_set_visibility(body_t *body, bool is_visible) {
 
 void body_set_text(body_t *body, SDL_Texture *text) { body->text = text; }
 
-void body_set_image(body_t *body, SDL_Texture *image) { body->image = image; }
+void body_set_label(body_t *body, const char *label, font_t *font,
+                    rgb_color_t color) {
+  if (!label) {
+    body->label_font = NULL;
+    return;
+  }
+  assert(font);
+  size_t length = strlen(label);
+  if (length + 1 > body->label_capacity) {
+    body->label = realloc(body->label, length + 1);
+    assert(body->label);
+    body->label_capacity = length + 1;
+  }
+  memcpy(body->label, label, length + 1);
+  body->label_font = font;
+  body->label_color = color;
+}
+
+void body_set_image(body_t *body, image_t *image) {
+  if (image) {
+    render_retain_image(image);
+  }
+  if (body->image) {
+    render_release_image(body->image);
+  }
+  body->image = image;
+}
 
 void body_set_centroid(body_t *body, vector_t x) {
-  vector_t translation = vec_subtract(x, body->centroid);
-  polygon_translate(body->shape, translation);
-  body->centroid = x;
+  body_kinematics_t *kinematics = &body->kinematics;
+  vector_t translation = vec_subtract(x, *kinematics->centroid);
+  *kinematics->prev_centroid = vec_add(*kinematics->prev_centroid, translation);
+  *kinematics->centroid = x;
+  *kinematics->moved = true;
 }
 
-void body_set_velocity(body_t *body, vector_t v) { body->vel = v; }
+void body_set_velocity(body_t *body, vector_t v) {
+  *body->kinematics.velocity = v;
+}
 
 void body_set_rotation_around_point(body_t *body, double angle,
                                     vector_t point) {
+  // Turn the origin of the local shape around the point with it
+  vector_t centroid = *body->kinematics.centroid;
+  vector_t origin = vec_add(centroid, body->origin_offset);
+  origin = vec_add(vec_rotate(vec_subtract(origin, point), angle), point);
+  body->origin_offset = vec_subtract(origin, centroid);
   body->rotation += angle;
-  polygon_rotate(body->shape, angle, point);
+  body->shape_is_stale = true;
+  *body->kinematics.moved = true;
 }
 
 void body_set_rotation(body_t *body, double angle) {
@@ -134,28 +285,85 @@ void body_set_rotation(body_t *body, double angle) {
 }
 
 void body_add_force(body_t *body, vector_t force) {
-  body->force = vec_add(body->force, force);
+  *body->kinematics.force = vec_add(*body->kinematics.force, force);
 }
 
 void body_add_impulse(body_t *body, vector_t impulse) {
-  body->impulse = vec_add(body->impulse, impulse);
+  *body->kinematics.impulse = vec_add(*body->kinematics.impulse, impulse);
 }
 
 void body_tick(body_t *body, double dt) {
-  vector_t acceleration = vec_multiply(1 / body->mass, body->force);
-  vector_t new_vel = vec_add(body->vel, vec_multiply(dt, acceleration));
-  new_vel = vec_add(new_vel, vec_multiply(1 / body->mass, body->impulse));
-  vector_t avg_vel = vec_multiply(0.5, vec_add(new_vel, body->vel));
+  body_kinematics_t *kinematics = &body->kinematics;
+  double inverse_mass = *kinematics->inverse_mass;
+  vector_t velocity = *kinematics->velocity;
+  vector_t acceleration = vec_multiply(inverse_mass, *kinematics->force);
+  vector_t new_vel = vec_add(velocity, vec_multiply(dt, acceleration));
+  new_vel = vec_add(new_vel, vec_multiply(inverse_mass, *kinematics->impulse));
+  vector_t avg_vel = vec_multiply(0.5, vec_add(new_vel, velocity));
 
-  vector_t new_centroid = vec_add(body->centroid, vec_multiply(dt, avg_vel));
+  vector_t old_centroid = *kinematics->centroid;
+  vector_t new_centroid = vec_add(old_centroid, vec_multiply(dt, avg_vel));
 
   body_set_centroid(body, new_centroid);
+  *kinematics->prev_centroid = old_centroid;
   body_set_velocity(body, new_vel);
 
-  body->force = (vector_t){0, 0};
-  body->impulse = (vector_t){0, 0};
+  *kinematics->force = VEC_ZERO;
+  *kinematics->impulse = VEC_ZERO;
 }
 
-void body_remove(body_t *body) { body->is_removed = true; }
+void body_remove(body_t *body) { *body->kinematics.is_removed = true; }
 
-bool body_is_removed(body_t *body) { return body->is_removed; }
+bool body_is_removed(body_t *body) { return *body->kinematics.is_removed; }
+
+uint64_t body_get_id(body_t *body) { return body->id; }
+
+void body_move_kinematics(body_t *body, body_kinematics_t kinematics) {
+  *kinematics.centroid = *body->kinematics.centroid;
+  *kinematics.prev_centroid = *body->kinematics.prev_centroid;
+  *kinematics.velocity = *body->kinematics.velocity;
+  *kinematics.force = *body->kinematics.force;
+  *kinematics.impulse = *body->kinematics.impulse;
+  *kinematics.inverse_mass = *body->kinematics.inverse_mass;
+  *kinematics.is_removed = *body->kinematics.is_removed;
+  // The flag is shared, so it isn't copied; a body added to a scene
+  // makes the scene update its broad phase anyway
+  body->kinematics = kinematics;
+}
+
+void body_set_kinematics(body_t *body, body_kinematics_t kinematics) {
+  body->kinematics = kinematics;
+}
+
+void body_save_state(body_t *body, body_state_t *state, vector_t *vertices) {
+  body_place_shape(body);
+  *state = (body_state_t){.centroid = *body->kinematics.centroid,
+                          .prev_centroid = *body->kinematics.prev_centroid,
+                          .velocity = *body->kinematics.velocity,
+                          .rotation = body->rotation,
+                          .origin_offset = body->origin_offset,
+                          .bounds = body->bounds,
+                          .is_visible = body->is_visible,
+                          .is_removed = *body->kinematics.is_removed};
+  memcpy(vertices, polygon_vertices(body->shape),
+         polygon_size(body->shape) * sizeof(vector_t));
+}
+
+void body_restore_state(body_t *body, const body_state_t *state,
+                        const vector_t *vertices) {
+  *body->kinematics.centroid = state->centroid;
+  *body->kinematics.prev_centroid = state->prev_centroid;
+  *body->kinematics.velocity = state->velocity;
+  body->rotation = state->rotation;
+  body->origin_offset = state->origin_offset;
+  body->bounds = state->bounds;
+  body->shape_centroid = state->centroid;
+  body->shape_is_stale = false;
+  body->is_visible = state->is_visible;
+  *body->kinematics.is_removed = state->is_removed;
+  memcpy(polygon_vertices(body->shape), vertices,
+         polygon_size(body->shape) * sizeof(vector_t));
+  polygon_vertices_changed(body->shape);
+  *body->kinematics.force = VEC_ZERO;
+  *body->kinematics.impulse = VEC_ZERO;
+}
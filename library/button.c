@@ -121,23 +121,18 @@ void button_unpress(button_t *button, double dt) { button_press(button, -dt); }
 
 void button_tick(button_t *button, list_t *pressing_bodies, double dt) {
   body_t *button_body = button->button_body;
-  list_t *button_shape = body_get_shape(button_body);
   button->is_pressed = false;
 
   // Check whether or not button should be pressed
   for (size_t i = 0; i < list_size(pressing_bodies); i++) {
-    list_t *pressing_shape = body_get_shape(list_get(pressing_bodies, i));
     collision_info_t collision_info =
-        find_collision(button_shape, pressing_shape);
+        find_body_collision(button_body, list_get(pressing_bodies, i));
 
     if (collision_info.collided) {
       button->is_pressed = true;
       break;
     }
-
-    list_free(pressing_shape);
   }
-  list_free(button_shape);
 
   if (button->is_pressed) {
     button_press(button, dt);
@@ -155,4 +150,12 @@ void button_tick(button_t *button, list_t *pressing_bodies, double dt) {
     }
     platform_tick(platform, dt);
   }
-}
\ No newline at end of file
+}
+
+double button_get_motion_time(button_t *button) {
+  return button->sum_motion_time;
+}
+
+void button_set_motion_time(button_t *button, double sum_motion_time) {
+  button->sum_motion_time = sum_motion_time;
+}
@@ -1,28 +1,28 @@
 #include "../include/collision.h"
+#include "../include/body.h"
 #include "../include/list.h"
+#include "../include/polygon.h"
 #include "../include/vector.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-vector_t compute_normal(vector_t v1, vector_t v2) {
-  vector_t edge = vec_subtract(v1, v2);
-  double dist = sqrt(vec_dot(edge, edge));
-  vector_t unit = vec_multiply(1.0 / dist, edge);
-  vector_t normal = {-unit.y, unit.x};
-  return normal;
-}
-
-double *find_min_max_interval(list_t *shape, vector_t normal) {
-  double *interval = calloc(2, sizeof(double));
-  // Min: "left-most" projection on normal line
-  // Max: "right-most" projection on normal line
+/**
+ * The projection of a shape onto a line.
+ * Min: "left-most" projection on normal line
+ * Max: "right-most" projection on normal line
+ */
+typedef struct {
+  double min;
+  double max;
+} interval_t;
 
+interval_t find_min_max_interval(vector_t *vertices, size_t n,
+                                 vector_t normal) {
   double min = 1.0 / 0.0;  //  inf
   double max = -1.0 / 0.0; // -inf
-  for (size_t i = 0; i < list_size(shape); i++) {
-    vector_t v = *(vector_t *)list_get(shape, i);
-    double proj = vec_dot(v, normal);
+  for (size_t i = 0; i < n; i++) {
+    double proj = vertices[i].x * normal.x + vertices[i].y * normal.y;
     if (proj < min) {
       min = proj;
     }
@@ -30,41 +30,52 @@ double *find_min_max_interval(list_t *shape, vector_t normal) {
       max = proj;
     }
   }
-  interval[0] = min;
-  interval[1] = max;
-  return interval;
+  return (interval_t){min, max};
 }
 
-collision_info_t find_collision(list_t *shape1, list_t *shape2) {
+collision_info_t find_polygon_collision(polygon_t *shape1, polygon_t *shape2) {
   collision_info_t collision_info;
 
   double shortest_overlap = 1.0 / 0.0;
 
-  list_t *shape;
-  list_t *other_shape;
-  for (size_t i = 0; i < list_size(shape1) + list_size(shape2); i++) {
+  size_t n1 = polygon_size(shape1);
+  size_t n2 = polygon_size(shape2);
+  vector_t *vertices1 = polygon_vertices(shape1);
+  vector_t *vertices2 = polygon_vertices(shape2);
+  // The normals are cached in the polygons, and kept as they move
+  const vector_t *normals1 = polygon_edge_normals(shape1);
+  const vector_t *normals2 = polygon_edge_normals(shape2);
+
+  vector_t *shape;
+  const vector_t *normals;
+  vector_t *other_shape;
+  size_t n;
+  size_t other_n;
+  for (size_t i = 0; i < n1 + n2; i++) {
     size_t j;
-    if (i < list_size(shape1)) {
+    if (i < n1) {
       j = i;
-      shape = shape1;
-      other_shape = shape2;
+      shape = vertices1;
+      normals = normals1;
+      n = n1;
+      other_shape = vertices2;
+      other_n = n2;
     } else {
-      j = i - list_size(shape1);
-      shape = shape2;
-      other_shape = shape1;
+      j = i - n1;
+      shape = vertices2;
+      normals = normals2;
+      n = n2;
+      other_shape = vertices1;
+      other_n = n1;
     }
-    vector_t v1 = *(vector_t *)list_get(shape, j);
-    vector_t v2 = *(vector_t *)list_get(shape, (j + 1) % list_size(shape));
-    vector_t normal = compute_normal(v1, v2);
+    vector_t normal = normals[j];
 
-    double *interval1 = find_min_max_interval(shape, normal);
-    double *interval2 = find_min_max_interval(other_shape, normal);
-    double min1 = interval1[0];
-    double min2 = interval2[0];
-    double max1 = interval1[1];
-    double max2 = interval2[1];
-    free(interval1);
-    free(interval2);
+    interval_t interval1 = find_min_max_interval(shape, n, normal);
+    interval_t interval2 = find_min_max_interval(other_shape, other_n, normal);
+    double min1 = interval1.min;
+    double min2 = interval2.min;
+    double max1 = interval1.max;
+    double max2 = interval2.max;
 
     if (max1 < min2 || max2 < min1) {
       collision_info.collided = false;
@@ -80,3 +91,20 @@ collision_info_t find_collision(list_t *shape1, list_t *shape2) {
   collision_info.collided = true;
   return collision_info;
 }
+
+collision_info_t find_collision(list_t *shape1, list_t *shape2) {
+  polygon_t *polygon1 = polygon_from_list(shape1);
+  polygon_t *polygon2 = polygon_from_list(shape2);
+  collision_info_t collision_info = find_polygon_collision(polygon1, polygon2);
+  polygon_free(polygon1);
+  polygon_free(polygon2);
+  return collision_info;
+}
+
+collision_info_t find_body_collision(body_t *body1, body_t *body2) {
+  // Broad phase: bodies whose boxes don't overlap can't be colliding
+  if (!aabb_overlaps(body_get_bounds(body1), body_get_bounds(body2))) {
+    return (collision_info_t){.collided = false};
+  }
+  return find_polygon_collision(body_peek_shape(body1), body_peek_shape(body2));
+}
@@ -1,8 +1,10 @@
 #include "../include/forces.h"
+#include "../include/barnes_hut.h"
 #include "../include/collision.h"
 #include "../include/scene.h"
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -47,6 +49,7 @@ typedef struct force_applier {
   void *aux;
   list_t *bodies;
   free_func_t freer;
+  bool is_removed;
 } force_applier_t;
 
 force_applier_t *force_applier_init(force_creator_t forcer, void *aux,
@@ -84,6 +87,14 @@ void force_applier_free(force_applier_t *force_applier) {
   free(force_applier);
 }
 
+void force_applier_remove(force_applier_t *force_applier) {
+  force_applier->is_removed = true;
+}
+
+bool force_applier_is_removed(force_applier_t *force_applier) {
+  return force_applier->is_removed;
+}
+
 void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2) {
   force_aux_t *force_aux =
@@ -128,6 +139,117 @@ void apply_newtonian_gravity(void *aux) {
   }
 }
 
+typedef struct barnes_hut_aux {
+  scene_t *scene;
+  double G;
+  double theta;
+  barnes_hut_t *tree;
+  // Scratch arrays reused every tick, indexed like the tree's points
+  body_t **bodies;
+  vector_t *positions;
+  double *masses;
+  vector_t *fields;
+  size_t capacity;
+} barnes_hut_aux_t;
+
+void barnes_hut_aux_free(barnes_hut_aux_t *bh_aux) {
+  barnes_hut_free(bh_aux->tree);
+  free(bh_aux->bodies);
+  free(bh_aux->positions);
+  free(bh_aux->masses);
+  free(bh_aux->fields);
+  free(bh_aux);
+}
+
+void create_barnes_hut_gravity(scene_t *scene, double G, double theta) {
+  assert(theta >= 0);
+  barnes_hut_aux_t *bh_aux = calloc(1, sizeof(barnes_hut_aux_t));
+  assert(bh_aux);
+  bh_aux->scene = scene;
+  bh_aux->G = G;
+  bh_aux->theta = theta;
+  bh_aux->tree = barnes_hut_init();
+
+  // Not tied to any bodies, so it lives as long as the scene
+  scene_add_bodies_force_creator(
+      scene, (force_creator_t)apply_barnes_hut_gravity, bh_aux,
+      list_init(0, NULL), (free_func_t)barnes_hut_aux_free);
+}
+
+void apply_barnes_hut_gravity(void *aux) {
+  barnes_hut_aux_t *bh_aux = aux;
+  scene_t *scene = bh_aux->scene;
+  size_t num_bodies = scene_bodies(scene);
+  if (num_bodies > bh_aux->capacity) {
+    bh_aux->capacity = num_bodies;
+    bh_aux->bodies = realloc(bh_aux->bodies, num_bodies * sizeof(body_t *));
+    bh_aux->positions =
+        realloc(bh_aux->positions, num_bodies * sizeof(vector_t));
+    bh_aux->masses = realloc(bh_aux->masses, num_bodies * sizeof(double));
+    bh_aux->fields = realloc(bh_aux->fields, num_bodies * sizeof(vector_t));
+    assert(bh_aux->bodies && bh_aux->positions && bh_aux->masses &&
+           bh_aux->fields);
+  }
+
+  size_t num_points = 0;
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = scene_get_body(scene, i);
+    double mass = body_get_mass(body);
+    if (isinf(mass)) {
+      continue;
+    }
+    bh_aux->bodies[num_points] = body;
+    bh_aux->positions[num_points] = body_get_centroid(body);
+    bh_aux->masses[num_points] = mass;
+    num_points++;
+  }
+
+  barnes_hut_build(bh_aux->tree, bh_aux->positions, bh_aux->masses,
+                   num_points);
+  barnes_hut_fields(bh_aux->tree, bh_aux->theta, MINIMUM_DISTANCE,
+                    bh_aux->fields);
+  for (size_t i = 0; i < num_points; i++) {
+    double scale = bh_aux->G * bh_aux->masses[i];
+    body_add_force(bh_aux->bodies[i], vec_multiply(scale, bh_aux->fields[i]));
+  }
+}
+
+typedef struct uniform_field_aux {
+  scene_t *scene;
+  vector_t g;
+  body_filter_t filter;
+} uniform_field_aux_t;
+
+void create_uniform_field(scene_t *scene, vector_t g) {
+  create_filtered_uniform_field(scene, g, NULL);
+}
+
+void create_filtered_uniform_field(scene_t *scene, vector_t g,
+                                   body_filter_t filter) {
+  uniform_field_aux_t *field_aux = calloc(1, sizeof(uniform_field_aux_t));
+  assert(field_aux);
+  field_aux->scene = scene;
+  field_aux->g = g;
+  field_aux->filter = filter;
+
+  // Not tied to any bodies, so it lives as long as the scene
+  scene_add_bodies_force_creator(scene, (force_creator_t)apply_uniform_field,
+                                 field_aux, list_init(0, NULL), free);
+}
+
+void apply_uniform_field(void *aux) {
+  uniform_field_aux_t *field_aux = aux;
+  scene_t *scene = field_aux->scene;
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    double mass = body_get_mass(body);
+    if (isinf(mass) || (field_aux->filter && !field_aux->filter(body))) {
+      continue;
+    }
+    body_add_force(body, vec_multiply(mass, field_aux->g));
+  }
+}
+
 void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2) {
   force_aux_t *force_aux =
       force_aux_init(k, body1, body2, NULL, NULL, NULL, false);
@@ -195,12 +317,7 @@ void apply_collision(void *aux) {
   collision_handler_t handler = force_aux->collision_handler;
   void *aux_ = (void *)force_aux->aux;
 
-  list_t *shape1 = body_get_shape(body1);
-  list_t *shape2 = body_get_shape(body2);
-  collision_info_t collision_info = find_collision(shape1, shape2);
-
-  list_free(shape1);
-  list_free(shape2);
+  collision_info_t collision_info = find_body_collision(body1, body2);
 
   if (collision_info.collided && !force_aux->collided_last_tick) {
     handler(body1, body2, collision_info.axis, aux_);
@@ -315,10 +432,7 @@ void apply_normal_force(void *aux) {
   body_t *body2 = force_aux->body2;
   bool *is_teleporting = force_aux->aux;
 
-  list_t *shape1 = body_get_shape(body1);
-  list_t *shape2 = body_get_shape(body2);
-
-  collision_info_t collision_info = find_collision(shape1, shape2);
+  collision_info_t collision_info = find_body_collision(body1, body2);
   vector_t axis = collision_info.axis;
 
   bool can_apply_normal_force = false;
@@ -357,9 +471,6 @@ void apply_normal_force(void *aux) {
     body_add_force(body1, normal_force_1);
     body_add_force(body2, normal_force_2);
   }
-
-  list_free(shape1);
-  list_free(shape2);
 }
 
 void create_jump_force(scene_t *scene, double jump_speed, body_t *jump_body,
@@ -381,19 +492,172 @@ void apply_jump_force(void *aux) {
   bool *is_jumping = force_aux->aux;
   body_t *jump_body = force_aux->body1;
   body_t *stationary_body = force_aux->body2;
-  list_t *shape_jump = body_get_shape(jump_body);
-  list_t *shape_stationary = body_get_shape(stationary_body);
   vector_t centroid_jump = body_get_centroid(jump_body);
   vector_t centroid_stationary = body_get_centroid(stationary_body);
 
-  collision_info_t collision_info =
-      find_collision(shape_jump, shape_stationary);
-
-  // Jump only when colliding, jumping, and when moving body above stationary
-  if (collision_info.collided && *is_jumping &&
-      centroid_jump.y >= centroid_stationary.y) {
+  // Jump only when jumping, when moving body above stationary, and when
+  // colliding; the collision test is the expensive one, so it goes last
+  if (*is_jumping && centroid_jump.y >= centroid_stationary.y &&
+      find_body_collision(jump_body, stationary_body).collided) {
     vector_t new_velocity = {body_get_velocity(jump_body).x, jump_speed};
     body_set_velocity(jump_body, new_velocity);
     *is_jumping = false;
   }
-}
\ No newline at end of file
+}
+
+/** Two bodies, stored with the lower address first */
+typedef struct body_pair {
+  body_t *body1;
+  body_t *body2;
+} body_pair_t;
+
+typedef struct type_collision_aux {
+  scene_t *scene;
+  body_filter_t is_body1;
+  body_filter_t is_body2;
+  collision_handler_t handler;
+  void *aux;
+  free_func_t freer;
+  // Pairs colliding as of the last tick, sorted for binary search
+  body_pair_t *colliding;
+  size_t num_colliding;
+  // Pairs colliding this tick, built up by apply_type_collision()
+  body_pair_t *next_colliding;
+  size_t num_next_colliding;
+  size_t capacity;
+} type_collision_aux_t;
+
+type_collision_aux_t *type_collision_aux_init(scene_t *scene,
+                                              body_filter_t is_body1,
+                                              body_filter_t is_body2,
+                                              collision_handler_t handler,
+                                              void *aux, free_func_t freer) {
+  type_collision_aux_t *type_aux = calloc(1, sizeof(type_collision_aux_t));
+  assert(type_aux);
+  type_aux->scene = scene;
+  type_aux->is_body1 = is_body1;
+  type_aux->is_body2 = is_body2;
+  type_aux->handler = handler;
+  type_aux->aux = aux;
+  type_aux->freer = freer;
+  return type_aux;
+}
+
+void type_collision_aux_free(type_collision_aux_t *type_aux) {
+  if (type_aux->aux && type_aux->freer) {
+    type_aux->freer(type_aux->aux);
+  }
+  free(type_aux->colliding);
+  free(type_aux->next_colliding);
+  free(type_aux);
+}
+
+body_pair_t make_body_pair(body_t *body1, body_t *body2) {
+  if ((uintptr_t)body1 < (uintptr_t)body2) {
+    return (body_pair_t){body1, body2};
+  }
+  return (body_pair_t){body2, body1};
+}
+
+int compare_body_pairs(const void *a, const void *b) {
+  const body_pair_t *pair1 = a;
+  const body_pair_t *pair2 = b;
+  if (pair1->body1 != pair2->body1) {
+    return (uintptr_t)pair1->body1 < (uintptr_t)pair2->body1 ? -1 : 1;
+  }
+  if (pair1->body2 != pair2->body2) {
+    return (uintptr_t)pair1->body2 < (uintptr_t)pair2->body2 ? -1 : 1;
+  }
+  return 0;
+}
+
+void create_type_collision(scene_t *scene, body_filter_t is_body1,
+                           body_filter_t is_body2, collision_handler_t handler,
+                           void *aux, free_func_t freer) {
+  type_collision_aux_t *type_aux =
+      type_collision_aux_init(scene, is_body1, is_body2, handler, aux, freer);
+
+  // Not tied to any bodies, so it lives as long as the scene
+  scene_add_bodies_force_creator(scene, (force_creator_t)apply_type_collision,
+                                 type_aux, list_init(0, NULL),
+                                 (free_func_t)type_collision_aux_free);
+}
+
+/**
+ * Runs the narrow phase on one nearby pair from the broad phase,
+ * calling the handler if the pair has just started colliding.
+ */
+void type_collision_pair(body_t *body_a, body_t *body_b,
+                         type_collision_aux_t *type_aux) {
+  body_t *body1;
+  body_t *body2;
+  if (type_aux->is_body1(body_a) && type_aux->is_body2(body_b)) {
+    body1 = body_a;
+    body2 = body_b;
+  } else if (type_aux->is_body1(body_b) && type_aux->is_body2(body_a)) {
+    body1 = body_b;
+    body2 = body_a;
+  } else {
+    return;
+  }
+
+  collision_info_t collision_info = find_body_collision(body1, body2);
+  if (!collision_info.collided) {
+    return;
+  }
+
+  body_pair_t pair = make_body_pair(body1, body2);
+  bool collided_last_tick =
+      type_aux->num_colliding > 0 &&
+      bsearch(&pair, type_aux->colliding, type_aux->num_colliding,
+              sizeof(body_pair_t), compare_body_pairs) != NULL;
+  if (!collided_last_tick) {
+    type_aux->handler(body1, body2, collision_info.axis, type_aux->aux);
+  }
+
+  // Removed bodies are freed at the end of the tick; forget them now so a
+  // new body allocated at the same address isn't mistaken for them
+  if (body_is_removed(body1) || body_is_removed(body2)) {
+    return;
+  }
+  if (type_aux->num_next_colliding == type_aux->capacity) {
+    size_t new_capacity = type_aux->capacity > 0 ? type_aux->capacity * 2 : 8;
+    body_pair_t *next =
+        realloc(type_aux->next_colliding, new_capacity * sizeof(body_pair_t));
+    assert(next);
+    body_pair_t *colliding =
+        realloc(type_aux->colliding, new_capacity * sizeof(body_pair_t));
+    assert(colliding);
+    type_aux->next_colliding = next;
+    type_aux->colliding = colliding;
+    type_aux->capacity = new_capacity;
+  }
+  type_aux->next_colliding[type_aux->num_next_colliding++] = pair;
+}
+
+void apply_type_collision(void *aux) {
+  type_collision_aux_t *type_aux = aux;
+  type_aux->num_next_colliding = 0;
+  scene_for_each_pair(type_aux->scene, (body_pair_handler_t)type_collision_pair,
+                      type_aux);
+
+  if (type_aux->num_next_colliding > 0) {
+    qsort(type_aux->next_colliding, type_aux->num_next_colliding,
+          sizeof(body_pair_t), compare_body_pairs);
+  }
+  body_pair_t *colliding = type_aux->colliding;
+  type_aux->colliding = type_aux->next_colliding;
+  type_aux->num_colliding = type_aux->num_next_colliding;
+  type_aux->next_colliding = colliding;
+}
+
+void create_type_physics_collision(scene_t *scene, double elasticity,
+                                   body_filter_t is_body1,
+                                   body_filter_t is_body2) {
+  double *aux = calloc(1, sizeof(double));
+  assert(aux);
+  *aux = elasticity;
+  create_type_collision(scene, is_body1, is_body2,
+                        (collision_handler_t)physics_collision_handler, aux,
+                        free);
+}
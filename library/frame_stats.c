@@ -0,0 +1,71 @@
+#include "../include/frame_stats.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct frame_stats {
+  double *times;
+  size_t window;
+  size_t num_frames;
+  // Index of the slot the next frame is written to
+  size_t next;
+} frame_stats_t;
+
+frame_stats_t *frame_stats_init(size_t window) {
+  assert(window > 0);
+  frame_stats_t *stats = malloc(sizeof(frame_stats_t));
+  assert(stats);
+  stats->times = malloc(window * sizeof(double));
+  assert(stats->times);
+  stats->window = window;
+  stats->num_frames = 0;
+  stats->next = 0;
+  return stats;
+}
+
+void frame_stats_free(frame_stats_t *stats) {
+  free(stats->times);
+  free(stats);
+}
+
+void frame_stats_record(frame_stats_t *stats, double frame_time) {
+  stats->times[stats->next] = frame_time;
+  stats->next = (stats->next + 1) % stats->window;
+  if (stats->num_frames < stats->window) {
+    stats->num_frames++;
+  }
+}
+
+int compare_frame_times(const void *time1, const void *time2) {
+  double difference = *(const double *)time1 - *(const double *)time2;
+  return (difference > 0) - (difference < 0);
+}
+
+frame_summary_t frame_stats_summarize(frame_stats_t *stats) {
+  frame_summary_t summary = {0};
+  size_t n = stats->num_frames;
+  if (n == 0) {
+    return summary;
+  }
+  // The ring is unordered once it wraps, and the slots past num_frames
+  // are unused, so sort a copy of just the recorded frames
+  double *sorted = malloc(n * sizeof(double));
+  assert(sorted);
+  memcpy(sorted, stats->times, n * sizeof(double));
+  qsort(sorted, n, sizeof(double), compare_frame_times);
+
+  double total = 0;
+  for (size_t i = 0; i < n; i++) {
+    total += sorted[i];
+  }
+  summary.num_frames = n;
+  summary.min = sorted[0];
+  summary.max = sorted[n - 1];
+  summary.mean = total / n;
+  // Nearest-rank percentile
+  size_t rank = (size_t)ceil(0.99 * n);
+  summary.p99 = sorted[rank - 1];
+  free(sorted);
+  return summary;
+}
@@ -0,0 +1,259 @@
+#include "../include/input_journal.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char JOURNAL_MAGIC[4] = {'I', 'J', 'N', 'L'};
+const uint8_t JOURNAL_VERSION = 1;
+
+// Tags at the start of each record
+const uint8_t KEY_RECORD = 'K';
+const uint8_t MOUSE_RECORD = 'M';
+const uint8_t END_RECORD = 'E';
+
+const size_t INITIAL_NUM_EVENTS = 64;
+
+typedef struct input_recorder {
+  FILE *file;
+  uint32_t last_frame;
+  bool has_mouse_pos;
+  vector_t last_mouse_pos;
+} input_recorder_t;
+
+typedef struct input_player {
+  double dt;
+  uint32_t num_frames;
+  journal_event_t *events;
+  size_t num_events;
+  size_t next_event;
+} input_player_t;
+
+void journal_write_byte(FILE *file, uint8_t byte) { fputc(byte, file); }
+
+/** Writes 7 bits at a time, low bits first; the top bit marks more bytes */
+void journal_write_varint(FILE *file, uint32_t value) {
+  while (value >= 0x80) {
+    journal_write_byte(file, (value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  journal_write_byte(file, value);
+}
+
+/** Writes the bits of a double in little-endian order */
+void journal_write_double(FILE *file, double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  for (size_t i = 0; i < sizeof(bits); i++) {
+    journal_write_byte(file, bits >> (8 * i));
+  }
+}
+
+/** Starts a record, storing its frame relative to the previous record */
+void journal_write_header(input_recorder_t *recorder, uint8_t tag,
+                          uint32_t frame) {
+  assert(frame >= recorder->last_frame);
+  journal_write_byte(recorder->file, tag);
+  journal_write_varint(recorder->file, frame - recorder->last_frame);
+  recorder->last_frame = frame;
+}
+
+input_recorder_t *input_recorder_init(const char *filename, double dt) {
+  assert(dt > 0);
+  FILE *file = fopen(filename, "wb");
+  if (!file) {
+    printf("Unable to create input journal %s\n", filename);
+    return NULL;
+  }
+  input_recorder_t *recorder = calloc(1, sizeof(input_recorder_t));
+  assert(recorder);
+  recorder->file = file;
+  fwrite(JOURNAL_MAGIC, 1, sizeof(JOURNAL_MAGIC), file);
+  journal_write_byte(file, JOURNAL_VERSION);
+  journal_write_double(file, dt);
+  return recorder;
+}
+
+void input_recorder_key(input_recorder_t *recorder, uint32_t frame, char key,
+                        int type, double held_time) {
+  assert(0 <= type && type <= UINT8_MAX);
+  journal_write_header(recorder, KEY_RECORD, frame);
+  journal_write_byte(recorder->file, key);
+  journal_write_byte(recorder->file, type);
+  journal_write_double(recorder->file, held_time);
+}
+
+void input_recorder_mouse(input_recorder_t *recorder, uint32_t frame,
+                          vector_t mouse_pos) {
+  if (recorder->has_mouse_pos && mouse_pos.x == recorder->last_mouse_pos.x &&
+      mouse_pos.y == recorder->last_mouse_pos.y) {
+    return;
+  }
+  journal_write_header(recorder, MOUSE_RECORD, frame);
+  journal_write_double(recorder->file, mouse_pos.x);
+  journal_write_double(recorder->file, mouse_pos.y);
+  recorder->has_mouse_pos = true;
+  recorder->last_mouse_pos = mouse_pos;
+}
+
+void input_recorder_free(input_recorder_t *recorder, uint32_t num_frames) {
+  journal_write_header(recorder, END_RECORD, num_frames);
+  if (fclose(recorder->file) != 0) {
+    printf("Unable to finish input journal\n");
+  }
+  free(recorder);
+}
+
+/** The unread part of a journal file */
+typedef struct journal_reader {
+  uint8_t *data;
+  size_t size;
+  size_t position;
+} journal_reader_t;
+
+bool journal_read_byte(journal_reader_t *reader, uint8_t *byte) {
+  if (reader->position == reader->size) {
+    return false;
+  }
+  *byte = reader->data[reader->position++];
+  return true;
+}
+
+bool journal_read_varint(journal_reader_t *reader, uint32_t *value) {
+  *value = 0;
+  for (size_t shift = 0; shift < 32; shift += 7) {
+    uint8_t byte;
+    if (!journal_read_byte(reader, &byte)) {
+      return false;
+    }
+    *value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool journal_read_double(journal_reader_t *reader, double *value) {
+  uint64_t bits = 0;
+  for (size_t i = 0; i < sizeof(bits); i++) {
+    uint8_t byte;
+    if (!journal_read_byte(reader, &byte)) {
+      return false;
+    }
+    bits |= (uint64_t)byte << (8 * i);
+  }
+  memcpy(value, &bits, sizeof(bits));
+  return true;
+}
+
+/** Reads every record after the header, up to and including the end */
+bool journal_read_events(journal_reader_t *reader, input_player_t *player) {
+  size_t capacity = INITIAL_NUM_EVENTS;
+  player->events = malloc(capacity * sizeof(journal_event_t));
+  assert(player->events);
+  uint32_t frame = 0;
+  while (true) {
+    uint8_t tag;
+    uint32_t frame_delta;
+    if (!journal_read_byte(reader, &tag) ||
+        !journal_read_varint(reader, &frame_delta) ||
+        frame_delta > UINT32_MAX - frame) {
+      return false;
+    }
+    frame += frame_delta;
+    if (tag == END_RECORD) {
+      player->num_frames = frame;
+      return reader->position == reader->size;
+    }
+
+    if (player->num_events == capacity) {
+      capacity *= 2;
+      player->events =
+          realloc(player->events, capacity * sizeof(journal_event_t));
+      assert(player->events);
+    }
+    journal_event_t *event = &player->events[player->num_events];
+    *event = (journal_event_t){.frame = frame};
+    if (tag == KEY_RECORD) {
+      uint8_t key, type;
+      event->kind = JOURNAL_KEY;
+      if (!journal_read_byte(reader, &key) ||
+          !journal_read_byte(reader, &type) ||
+          !journal_read_double(reader, &event->held_time)) {
+        return false;
+      }
+      event->key = key;
+      event->type = type;
+    } else if (tag == MOUSE_RECORD) {
+      event->kind = JOURNAL_MOUSE;
+      if (!journal_read_double(reader, &event->mouse_pos.x) ||
+          !journal_read_double(reader, &event->mouse_pos.y)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+    player->num_events++;
+  }
+}
+
+input_player_t *input_player_init(const char *filename) {
+  FILE *file = fopen(filename, "rb");
+  if (!file) {
+    printf("Unable to open input journal %s\n", filename);
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  journal_reader_t reader = {.data = malloc(size > 0 ? size : 1),
+                             .size = size > 0 ? size : 0,
+                             .position = 0};
+  assert(reader.data);
+  bool ok = fread(reader.data, 1, reader.size, file) == reader.size;
+  fclose(file);
+
+  input_player_t *player = calloc(1, sizeof(input_player_t));
+  assert(player);
+  uint8_t version;
+  ok = ok && reader.size >= sizeof(JOURNAL_MAGIC) &&
+       memcmp(reader.data, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) == 0;
+  reader.position = sizeof(JOURNAL_MAGIC);
+  ok = ok && journal_read_byte(&reader, &version) &&
+       version == JOURNAL_VERSION &&
+       journal_read_double(&reader, &player->dt) && player->dt > 0 &&
+       journal_read_events(&reader, player);
+  free(reader.data);
+  if (!ok) {
+    printf("Invalid input journal %s\n", filename);
+    input_player_free(player);
+    return NULL;
+  }
+  return player;
+}
+
+void input_player_free(input_player_t *player) {
+  free(player->events);
+  free(player);
+}
+
+double input_player_dt(input_player_t *player) { return player->dt; }
+
+uint32_t input_player_num_frames(input_player_t *player) {
+  return player->num_frames;
+}
+
+bool input_player_next(input_player_t *player, uint32_t frame,
+                       journal_event_t *event) {
+  while (player->next_event < player->num_events &&
+         player->events[player->next_event].frame < frame) {
+    player->next_event++;
+  }
+  if (player->next_event == player->num_events ||
+      player->events[player->next_event].frame != frame) {
+    return false;
+  }
+  *event = player->events[player->next_event++];
+  return true;
+}
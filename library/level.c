@@ -0,0 +1,505 @@
+#include "../include/level.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char LEVEL_MAGIC[4] = {'L', 'V', 'L', 'B'};
+const uint32_t LEVEL_VERSION = 1;
+
+// Marks a record without a string
+const uint32_t NO_STRING = UINT32_MAX;
+
+const size_t INITIAL_LEVEL_CAPACITY = 64;
+
+/**
+ * The start of the binary form. It is followed by the records,
+ * then the values of all the records, then their strings.
+ */
+typedef struct level_header {
+  char magic[4];
+  uint32_t version;
+  uint32_t num_records;
+  uint32_t num_values;
+  uint32_t strings_size;
+  // Pads the header so the values that follow are aligned
+  uint32_t reserved;
+} level_header_t;
+
+/** A record as it is stored in the binary form */
+typedef struct level_file_record {
+  uint32_t kind;
+  uint32_t first_value;
+  uint32_t num_values;
+  // The offset of the record's string, or NO_STRING
+  uint32_t string;
+} level_file_record_t;
+
+typedef struct level {
+  // The binary form of the level; the pointers below point into it
+  uint8_t *data;
+  size_t size;
+  const level_header_t *header;
+  const level_file_record_t *records;
+  const double *values;
+  const char *strings;
+} level_t;
+
+/**
+ * How a kind of record is written. A record has num_values values,
+ * followed by any number of groups of repeated_values more.
+ */
+typedef struct level_syntax {
+  const char *keyword;
+  size_t num_values;
+  size_t repeated_values;
+  bool has_string;
+} level_syntax_t;
+
+const level_syntax_t LEVEL_SYNTAX[LEVEL_NUM_KINDS] = {
+    [LEVEL_RESTRICT_PORTALS] = {"restrict_portals", 0, 0, false},
+    [LEVEL_BACKGROUND] = {"background", 0, 0, true},
+    [LEVEL_GRAVITY] = {"gravity", 0, 0, false},
+    [LEVEL_WALL] = {"wall", 4, 0, false},
+    [LEVEL_SURFACE] = {"surface", 4, 0, false},
+    [LEVEL_PORTAL_SURFACE] = {"portal_surface", 4, 0, false},
+    // A centroid, then at least three vertices
+    [LEVEL_PORTAL_SURFACE_POLYGON] = {"portal_surface_polygon", 8, 2, false},
+    [LEVEL_PORTAL] = {"portal", 5, 0, false},
+    [LEVEL_EXIT] = {"exit", 2, 0, false},
+    [LEVEL_PLATFORM] = {"platform", 8, 0, false},
+    [LEVEL_BUTTON] = {"button", 3, 1, false},
+    [LEVEL_PLAYER] = {"player", 3, 0, false},
+    [LEVEL_BOX] = {"box", 2, 0, false},
+    [LEVEL_TIMER] = {"timer", 1, 0, false},
+    [LEVEL_PORTAL_GUN] = {"portal_gun", 0, 0, false}};
+
+/**
+ * Checks the values of a record.
+ *
+ * @param kind the kind of the record
+ * @param values the record's values
+ * @param num_values the number of values
+ * @param num_before the number of records of each kind before this one
+ * @return a description of what is wrong, or NULL if the record is valid
+ */
+const char *level_check_record(level_record_kind_t kind, const double *values,
+                               size_t num_values,
+                               const size_t num_before[LEVEL_NUM_KINDS]) {
+  const level_syntax_t *syntax = &LEVEL_SYNTAX[kind];
+  if (num_values < syntax->num_values ||
+      (syntax->repeated_values == 0 && num_values != syntax->num_values) ||
+      (syntax->repeated_values != 0 &&
+       (num_values - syntax->num_values) % syntax->repeated_values != 0)) {
+    return "wrong number of values";
+  }
+  for (size_t i = 0; i < num_values; i++) {
+    if (!isfinite(values[i])) {
+      return "values must be finite";
+    }
+  }
+
+  switch (kind) {
+  case LEVEL_WALL:
+  case LEVEL_SURFACE:
+  case LEVEL_PORTAL_SURFACE:
+    if (!(values[2] > 0 && values[3] > 0)) {
+      return "size must be positive";
+    }
+    break;
+  case LEVEL_PORTAL:
+    if (values[0] != 1 && values[0] != 2) {
+      return "portal must be 1 or 2";
+    }
+    break;
+  case LEVEL_PLATFORM:
+    if (!(values[3] > 0)) {
+      return "motion time must be positive";
+    }
+    break;
+  case LEVEL_BUTTON:
+    for (size_t i = 2; i < num_values; i++) {
+      double platform = values[i];
+      if (!(0 <= platform && platform < num_before[LEVEL_PLATFORM]) ||
+          platform != (size_t)platform) {
+        return "no such platform";
+      }
+    }
+    break;
+  case LEVEL_PLAYER:
+    if (num_before[LEVEL_PLAYER] > 0) {
+      return "more than one player";
+    }
+    break;
+  case LEVEL_BOX:
+  case LEVEL_PORTAL_GUN:
+    // Both are attached to the player
+    if (num_before[LEVEL_PLAYER] == 0) {
+      return "must come after the player";
+    }
+    break;
+  case LEVEL_TIMER:
+    if (!(values[0] > 0)) {
+      return "time must be positive";
+    }
+    if (num_before[LEVEL_TIMER] > 0) {
+      return "more than one timer";
+    }
+    break;
+  default:
+    break;
+  }
+  return NULL;
+}
+
+/**
+ * Checks that a level has everything a game needs,
+ * once each of its records has been checked.
+ *
+ * @param counts the number of records of each kind in the level
+ * @return a description of what is missing, or NULL if the level is valid
+ */
+const char *level_check_counts(const size_t counts[LEVEL_NUM_KINDS]) {
+  if (counts[LEVEL_PLAYER] == 0) {
+    return "no player";
+  }
+  if (counts[LEVEL_EXIT] == 0) {
+    return "no exit";
+  }
+  if (counts[LEVEL_TIMER] == 0) {
+    return "no timer";
+  }
+  return NULL;
+}
+
+/**
+ * Makes a level from its binary form, checking that it is valid.
+ *
+ * @param data the binary form; the level takes ownership of it
+ * @param size the number of bytes in data
+ * @param name the name to print in error messages
+ * @return a pointer to the newly allocated level, or NULL if it is invalid
+ */
+level_t *level_from_data(uint8_t *data, size_t size, const char *name) {
+  level_t *level = malloc(sizeof(level_t));
+  assert(level);
+  level->data = data;
+  level->size = size;
+  level->header = (const level_header_t *)data;
+
+  const level_header_t *header = level->header;
+  if (size < sizeof(level_header_t) ||
+      memcmp(header->magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) != 0 ||
+      header->version != LEVEL_VERSION ||
+      size != sizeof(level_header_t) +
+                  (uint64_t)header->num_records * sizeof(level_file_record_t) +
+                  (uint64_t)header->num_values * sizeof(double) +
+                  header->strings_size) {
+    printf("Invalid level %s\n", name);
+    level_free(level);
+    return NULL;
+  }
+  level->records =
+      (const level_file_record_t *)(data + sizeof(level_header_t));
+  level->values = (const double *)(level->records + header->num_records);
+  level->strings = (const char *)(level->values + header->num_values);
+  if (header->strings_size > 0 &&
+      level->strings[header->strings_size - 1] != '\0') {
+    printf("Invalid level %s\n", name);
+    level_free(level);
+    return NULL;
+  }
+
+  size_t counts[LEVEL_NUM_KINDS] = {0};
+  for (size_t i = 0; i < header->num_records; i++) {
+    const level_file_record_t *record = &level->records[i];
+    const char *error = NULL;
+    if (record->kind >= LEVEL_NUM_KINDS ||
+        (uint64_t)record->first_value + record->num_values >
+            header->num_values) {
+      error = "bad record";
+    } else if (LEVEL_SYNTAX[record->kind].has_string
+                   ? record->string >= header->strings_size
+                   : record->string != NO_STRING) {
+      error = "bad string";
+    } else {
+      error = level_check_record(record->kind,
+                                 &level->values[record->first_value],
+                                 record->num_values, counts);
+    }
+    if (error) {
+      printf("Invalid level %s: record %zu: %s\n", name, i, error);
+      level_free(level);
+      return NULL;
+    }
+    counts[record->kind]++;
+  }
+  const char *error = level_check_counts(counts);
+  if (error) {
+    printf("Invalid level %s: %s\n", name, error);
+    level_free(level);
+    return NULL;
+  }
+  return level;
+}
+
+/** The records of a level as they are parsed from text */
+typedef struct level_builder {
+  level_file_record_t *records;
+  size_t num_records;
+  size_t records_capacity;
+  double *values;
+  size_t num_values;
+  size_t values_capacity;
+  char *strings;
+  size_t strings_size;
+  size_t strings_capacity;
+} level_builder_t;
+
+/** Makes room for at least num_extra more elements in a growable array */
+void level_builder_reserve(void **elements, size_t *capacity, size_t size,
+                           size_t num_extra, size_t element_size) {
+  if (size + num_extra <= *capacity) {
+    return;
+  }
+  while (size + num_extra > *capacity) {
+    *capacity = *capacity ? *capacity * 2 : INITIAL_LEVEL_CAPACITY;
+  }
+  *elements = realloc(*elements, *capacity * element_size);
+  assert(*elements);
+}
+
+void level_builder_add_value(level_builder_t *builder, double value) {
+  level_builder_reserve((void **)&builder->values, &builder->values_capacity,
+                        builder->num_values, 1, sizeof(double));
+  builder->values[builder->num_values++] = value;
+}
+
+/** Stores a string of the given length, returning its offset */
+uint32_t level_builder_add_string(level_builder_t *builder,
+                                  const char *string, size_t length) {
+  level_builder_reserve((void **)&builder->strings,
+                        &builder->strings_capacity, builder->strings_size,
+                        length + 1, sizeof(char));
+  uint32_t offset = builder->strings_size;
+  memcpy(&builder->strings[offset], string, length);
+  builder->strings[offset + length] = '\0';
+  builder->strings_size += length + 1;
+  return offset;
+}
+
+/** Packs the parsed records into the binary form */
+level_t *level_builder_finish(level_builder_t *builder, const char *name) {
+  level_header_t header = {.version = LEVEL_VERSION,
+                           .num_records = builder->num_records,
+                           .num_values = builder->num_values,
+                           .strings_size = builder->strings_size};
+  memcpy(header.magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+  size_t records_size = builder->num_records * sizeof(level_file_record_t);
+  size_t values_size = builder->num_values * sizeof(double);
+  size_t size = sizeof(header) + records_size + values_size +
+                builder->strings_size;
+
+  uint8_t *data = malloc(size);
+  assert(data);
+  uint8_t *position = data;
+  memcpy(position, &header, sizeof(header));
+  position += sizeof(header);
+  // The arrays are NULL if nothing was added to them
+  if (records_size > 0) {
+    memcpy(position, builder->records, records_size);
+    position += records_size;
+  }
+  if (values_size > 0) {
+    memcpy(position, builder->values, values_size);
+    position += values_size;
+  }
+  if (builder->strings_size > 0) {
+    memcpy(position, builder->strings, builder->strings_size);
+  }
+  return level_from_data(data, size, name);
+}
+
+void level_builder_free(level_builder_t *builder) {
+  free(builder->records);
+  free(builder->values);
+  free(builder->strings);
+}
+
+bool level_is_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+bool level_is_line_end(char c) { return c == '\n' || c == '\0'; }
+
+/**
+ * Parses one non-empty line of the text form into a record.
+ *
+ * @param builder the records parsed so far
+ * @param line the start of the line's keyword
+ * @param num_before the number of records of each kind before the line
+ * @return a description of what is wrong, or NULL if the line was parsed
+ */
+const char *level_parse_line(level_builder_t *builder, const char *line,
+                             const size_t num_before[LEVEL_NUM_KINDS]) {
+  size_t keyword_length = 0;
+  while (!level_is_line_end(line[keyword_length]) &&
+         !level_is_space(line[keyword_length])) {
+    keyword_length++;
+  }
+  level_record_kind_t kind = LEVEL_NUM_KINDS;
+  for (size_t i = 0; i < LEVEL_NUM_KINDS; i++) {
+    if (strlen(LEVEL_SYNTAX[i].keyword) == keyword_length &&
+        strncmp(LEVEL_SYNTAX[i].keyword, line, keyword_length) == 0) {
+      kind = i;
+    }
+  }
+  if (kind == LEVEL_NUM_KINDS) {
+    return "unknown keyword";
+  }
+
+  level_file_record_t record = {.kind = kind,
+                                .first_value = builder->num_values,
+                                .num_values = 0,
+                                .string = NO_STRING};
+  const char *position = line + keyword_length;
+  while (level_is_space(*position)) {
+    position++;
+  }
+  if (LEVEL_SYNTAX[kind].has_string) {
+    // The string is the rest of the line, without trailing spaces
+    size_t length = 0;
+    while (!level_is_line_end(position[length])) {
+      length++;
+    }
+    while (length > 0 && level_is_space(position[length - 1])) {
+      length--;
+    }
+    if (length == 0) {
+      return "missing path";
+    }
+    record.string = level_builder_add_string(builder, position, length);
+  } else {
+    while (!level_is_line_end(*position)) {
+      char *end;
+      double value = strtod(position, &end);
+      if (end == position ||
+          !(level_is_space(*end) || level_is_line_end(*end))) {
+        return "expected a number";
+      }
+      level_builder_add_value(builder, value);
+      record.num_values++;
+      position = end;
+      while (level_is_space(*position)) {
+        position++;
+      }
+    }
+  }
+
+  const char *error =
+      level_check_record(kind, &builder->values[record.first_value],
+                         record.num_values, num_before);
+  if (error) {
+    return error;
+  }
+  level_builder_reserve((void **)&builder->records,
+                        &builder->records_capacity, builder->num_records, 1,
+                        sizeof(level_file_record_t));
+  builder->records[builder->num_records++] = record;
+  return NULL;
+}
+
+level_t *level_parse(const char *text, const char *name) {
+  level_builder_t builder = {0};
+  size_t counts[LEVEL_NUM_KINDS] = {0};
+  size_t line_number = 1;
+  const char *line = text;
+  while (*line != '\0') {
+    const char *start = line;
+    while (level_is_space(*start)) {
+      start++;
+    }
+    if (!level_is_line_end(*start) && *start != '#') {
+      const char *error = level_parse_line(&builder, start, counts);
+      if (error) {
+        printf("Invalid level %s: line %zu: %s\n", name, line_number, error);
+        level_builder_free(&builder);
+        return NULL;
+      }
+      counts[builder.records[builder.num_records - 1].kind]++;
+    }
+
+    const char *line_end = strchr(line, '\n');
+    if (!line_end) {
+      break;
+    }
+    line = line_end + 1;
+    line_number++;
+  }
+
+  level_t *level = level_builder_finish(&builder, name);
+  level_builder_free(&builder);
+  return level;
+}
+
+level_t *level_load(const char *filename) {
+  FILE *file = fopen(filename, "rb");
+  if (!file) {
+    printf("Unable to open level %s\n", filename);
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  size_t data_size = size > 0 ? size : 0;
+  // One more byte, so the text form can be read as a string
+  uint8_t *data = malloc(data_size + 1);
+  assert(data);
+  bool ok = fread(data, 1, data_size, file) == data_size;
+  fclose(file);
+  if (!ok) {
+    printf("Unable to read level %s\n", filename);
+    free(data);
+    return NULL;
+  }
+  data[data_size] = '\0';
+
+  if (data_size >= sizeof(LEVEL_MAGIC) &&
+      memcmp(data, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) == 0) {
+    return level_from_data(data, data_size, filename);
+  }
+  level_t *level = level_parse((const char *)data, filename);
+  free(data);
+  return level;
+}
+
+bool level_write_binary(level_t *level, const char *filename) {
+  FILE *file = fopen(filename, "wb");
+  if (!file) {
+    printf("Unable to create level %s\n", filename);
+    return false;
+  }
+  bool ok = fwrite(level->data, 1, level->size, file) == level->size;
+  return fclose(file) == 0 && ok;
+}
+
+void level_free(level_t *level) {
+  free(level->data);
+  free(level);
+}
+
+size_t level_num_records(level_t *level) {
+  return level->header->num_records;
+}
+
+level_record_t level_get_record(level_t *level, size_t index) {
+  assert(index < level_num_records(level));
+  const level_file_record_t *record = &level->records[index];
+  return (level_record_t){
+      .kind = record->kind,
+      .values = &level->values[record->first_value],
+      .num_values = record->num_values,
+      .string = record->string == NO_STRING
+                    ? NULL
+                    : &level->strings[record->string]};
+}
@@ -79,3 +79,28 @@ void *list_remove(list_t *lst, size_t index) {
   lst->size -= 1;
   return output;
 }
+
+void *list_swap_remove(list_t *lst, size_t index) {
+  assert(index < list_size(lst));
+  void *output = lst->arr[index];
+  lst->size -= 1;
+  lst->arr[index] = lst->arr[lst->size];
+  return output;
+}
+
+size_t list_compact(list_t *lst, list_predicate_t should_remove, void *aux) {
+  size_t kept = 0;
+  for (size_t i = 0; i < list_size(lst); i++) {
+    void *element = lst->arr[i];
+    if (should_remove(element, aux)) {
+      if (lst->freer) {
+        lst->freer(element);
+      }
+    } else {
+      lst->arr[kept++] = element;
+    }
+  }
+  size_t removed = list_size(lst) - kept;
+  lst->size = kept;
+  return removed;
+}
@@ -85,4 +85,12 @@ void platform_tick(platform_t *platform, double dt) {
   } else {
     platform_reset(platform, dt);
   }
-}
\ No newline at end of file
+}
+
+double platform_get_motion_time(platform_t *platform) {
+  return platform->sum_motion_time;
+}
+
+void platform_set_motion_time(platform_t *platform, double sum_motion_time) {
+  platform->sum_motion_time = sum_motion_time;
+}
@@ -1,67 +1,296 @@
 #include "../include/polygon.h"
+#include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
-double polygon_area(list_t *polygon) {
-  /*
-    The function computes the area of the polygon using this formula:
-
-    A = (1/2) * \sum_{i=0}^{n-1} (y_i + y_{i+1}) * (x_i - x_{i+1})
-  */
+typedef struct polygon {
+  size_t size;
+  // Whether the shape data below describes the current vertices.
+  // It is computed when first asked for, and moved along with the vertices
+  // by translations and rotations.
+  bool has_shape_data;
+  double area;
+  vector_t centroid;
+  double radius;
+  double moment_of_inertia;
+  // The vertices, followed by the normal of each edge
+  // (see polygon_normal_array())
+  vector_t vertices[];
+} polygon_t;
 
-  double sum_area = 0;
-  for (size_t i = 0; i < list_size(polygon); i++) {
-    vector_t curr = *(vector_t *)list_get(polygon, i);
-    vector_t next =
-        *(vector_t *)list_get(polygon, (i + 1) % list_size(polygon));
-    sum_area += (curr.y + next.y) * (curr.x - next.x);
-  }
+/** Gets where a polygon's edge normals are stored, after its vertices */
+vector_t *polygon_normal_array(polygon_t *polygon) {
+  return polygon->vertices + polygon->size;
+}
 
-  return sum_area / 2;
+/** Computes the outward unit normal of the edge from v1 to v2 */
+vector_t polygon_edge_normal(vector_t v1, vector_t v2) {
+  vector_t edge = vec_subtract(v1, v2);
+  double dist = sqrt(vec_dot(edge, edge));
+  vector_t unit = vec_multiply(1.0 / dist, edge);
+  return (vector_t){-unit.y, unit.x};
 }
 
-vector_t polygon_centroid(list_t *polygon) {
+/**
+ * Computes the area, centroid, moment of inertia, and edge normals
+ * of a polygon in one pass over its vertices,
+ * then its radius, which depends on the centroid.
+ */
+void polygon_compute_shape_data(polygon_t *polygon) {
   /*
-    The function computes the centroid of the polygon using this formula:
+    The area and centroid are computed using these formulas:
 
+    A = (1/2) * \sum_{i=0}^{n-1} (y_i + y_{i+1}) * (x_i - x_{i+1})
     c_x = (1/6A) * \sum_{i=0}^{n-1} (x_i + x_{i+1})*(x_i * y_{i+1} - x_{i+1} *
     y_i) c_y = (1/6A) * \sum_{i=0}^{n-1} (y_i + y_{i+1})*(x_i * y_{i+1} -
     x_{i+1} * y_i)
 
-    where the A is the area of the polygon and the centroid is c = (c_x, c_y)
+    and the moment of inertia about a point p, for a unit density, using:
+
+    J_p = (1/12) * \sum_{i=0}^{n-1} (a_i x a_{i+1}) *
+          (a_i . a_i + a_i . a_{i+1} + a_{i+1} . a_{i+1}),  a_i = v_i - p
+
+    taking p to be the first vertex, which avoids cancellation in polygons
+    far from (0, 0). Dividing by A gives it for a unit mass, and the parallel
+    axis theorem moves it to the centroid.
   */
 
-  double area = polygon_area(polygon);
+  size_t n = polygon->size;
+  vector_t *v = polygon->vertices;
+  vector_t *normals = polygon_normal_array(polygon);
+  vector_t first = n > 0 ? v[0] : VEC_ZERO;
+  double sum_area = 0;
   double c_x = 0;
   double c_y = 0;
-  for (size_t i = 0; i < list_size(polygon); i++) {
-    vector_t curr = *(vector_t *)list_get(polygon, i);
-    vector_t next =
-        *(vector_t *)list_get(polygon, (i + 1) % list_size(polygon));
-    c_x += (curr.x + next.x) * ((curr.x) * (next.y) - (next.x) * (curr.y));
-    c_y += (curr.y + next.y) * ((curr.x) * (next.y) - (next.x) * (curr.y));
+  double sum_moment = 0;
+  for (size_t i = 0; i < n; i++) {
+    vector_t curr = v[i];
+    vector_t next = v[i + 1 < n ? i + 1 : 0];
+    sum_area += (curr.y + next.y) * (curr.x - next.x);
+    double cross = (curr.x) * (next.y) - (next.x) * (curr.y);
+    c_x += (curr.x + next.x) * cross;
+    c_y += (curr.y + next.y) * cross;
+    vector_t a = vec_subtract(curr, first);
+    vector_t b = vec_subtract(next, first);
+    sum_moment +=
+        vec_cross(a, b) * (vec_dot(a, a) + vec_dot(a, b) + vec_dot(b, b));
+    normals[i] = polygon_edge_normal(curr, next);
   }
 
-  vector_t c = {c_x / (6 * area), c_y / (6 * area)};
-  return c;
+  double area = sum_area / 2;
+  vector_t centroid = {c_x / (6 * area), c_y / (6 * area)};
+  vector_t offset = vec_subtract(centroid, first);
+  double max_distance_squared = 0;
+  for (size_t i = 0; i < n; i++) {
+    vector_t from_centroid = vec_subtract(v[i], centroid);
+    max_distance_squared =
+        fmax(max_distance_squared, vec_dot(from_centroid, from_centroid));
+  }
+
+  polygon->area = area;
+  polygon->centroid = centroid;
+  polygon->moment_of_inertia =
+      sum_moment / (12 * area) - vec_dot(offset, offset);
+  polygon->radius = sqrt(max_distance_squared);
+  polygon->has_shape_data = true;
 }
 
-void polygon_translate(list_t *polygon, vector_t translation) {
-  for (size_t i = 0; i < list_size(polygon); i++) {
-    vector_t *v = list_get(polygon, i);
-    *v = vec_add(*v, translation);
+/** Computes a polygon's shape data if it isn't up to date */
+void polygon_ensure_shape_data(polygon_t *polygon) {
+  if (!polygon->has_shape_data) {
+    polygon_compute_shape_data(polygon);
   }
 }
 
-void polygon_rotate(list_t *polygon, double angle, vector_t point) {
-  // Translate polygon to origin
-  polygon_translate(polygon, vec_negate(point));
+polygon_t *polygon_init(size_t num_vertices) {
+  // Room for the vertices and the edge normals
+  polygon_t *polygon =
+      calloc(1, sizeof(polygon_t) + 2 * num_vertices * sizeof(vector_t));
+  assert(polygon);
+  polygon->size = num_vertices;
+  polygon->has_shape_data = false;
+  return polygon;
+}
+
+polygon_t *polygon_from_list(list_t *shape) {
+  size_t n = list_size(shape);
+  polygon_t *polygon = polygon_init(n);
+  for (size_t i = 0; i < n; i++) {
+    polygon->vertices[i] = *(vector_t *)list_get(shape, i);
+  }
+  return polygon;
+}
+
+list_t *polygon_to_list(polygon_t *polygon) {
+  list_t *shape = list_init(polygon->size, free);
+  for (size_t i = 0; i < polygon->size; i++) {
+    vector_t *v = malloc(sizeof(vector_t));
+    assert(v);
+    *v = polygon->vertices[i];
+    list_add(shape, v);
+  }
+  return shape;
+}
+
+polygon_t *polygon_copy(polygon_t *polygon) {
+  polygon_t *copy = polygon_init(polygon->size);
+  memcpy(copy, polygon,
+         sizeof(polygon_t) + 2 * polygon->size * sizeof(vector_t));
+  return copy;
+}
 
-  for (size_t i = 0; i < list_size(polygon); i++) {
-    vector_t *v = list_get(polygon, i);
-    *v = vec_rotate(*v, angle);
+void polygon_free(polygon_t *polygon) { free(polygon); }
+
+size_t polygon_size(polygon_t *polygon) { return polygon->size; }
+
+vector_t *polygon_vertices(polygon_t *polygon) { return polygon->vertices; }
+
+void polygon_vertices_changed(polygon_t *polygon) {
+  polygon->has_shape_data = false;
+}
+
+/**
+ * Writes the vertices of a packed polygon back into a list of vectors
+ * with the same number of elements.
+ *
+ * @param polygon the packed polygon to read from
+ * @param shape the list of vector_t * to overwrite
+ */
+void polygon_store_list(polygon_t *polygon, list_t *shape) {
+  assert(list_size(shape) == polygon->size);
+  for (size_t i = 0; i < polygon->size; i++) {
+    *(vector_t *)list_get(shape, i) = polygon->vertices[i];
   }
+}
+
+double polygon_area_packed(polygon_t *polygon) {
+  polygon_ensure_shape_data(polygon);
+  return polygon->area;
+}
 
-  // Translate polygon back to original point
-  polygon_translate(polygon, point);
-}
\ No newline at end of file
+vector_t polygon_centroid_packed(polygon_t *polygon) {
+  polygon_ensure_shape_data(polygon);
+  return polygon->centroid;
+}
+
+double polygon_radius(polygon_t *polygon) {
+  polygon_ensure_shape_data(polygon);
+  return polygon->radius;
+}
+
+double polygon_moment_of_inertia(polygon_t *polygon) {
+  polygon_ensure_shape_data(polygon);
+  return polygon->moment_of_inertia;
+}
+
+const vector_t *polygon_edge_normals(polygon_t *polygon) {
+  polygon_ensure_shape_data(polygon);
+  return polygon_normal_array(polygon);
+}
+
+void polygon_translate_packed(polygon_t *polygon, vector_t translation) {
+  vector_t *v = polygon->vertices;
+  for (size_t i = 0; i < polygon->size; i++) {
+    v[i].x += translation.x;
+    v[i].y += translation.y;
+  }
+  // Translating doesn't change the edges, so only the centroid moves
+  polygon->centroid = vec_add(polygon->centroid, translation);
+}
+
+void polygon_rotate_packed(polygon_t *polygon, double angle, vector_t point) {
+  rotation_t rotation = rotation_from_angle(angle);
+  // Move each vertex to the origin, rotate it, and move it back in one pass
+  vector_t *v = polygon->vertices;
+  for (size_t i = 0; i < polygon->size; i++) {
+    double x = v[i].x - point.x;
+    double y = v[i].y - point.y;
+    v[i].x = (x * rotation.cos - y * rotation.sin) + point.x;
+    v[i].y = (x * rotation.sin + y * rotation.cos) + point.y;
+  }
+  if (polygon->has_shape_data) {
+    vector_t *normals = polygon_normal_array(polygon);
+    for (size_t i = 0; i < polygon->size; i++) {
+      normals[i] = vec_rotate_by(normals[i], rotation);
+    }
+    polygon->centroid = vec_add(
+        vec_rotate_by(vec_subtract(polygon->centroid, point), rotation),
+        point);
+  }
+}
+
+void polygon_transform_packed(polygon_t *polygon, polygon_t *source,
+                              rotation_t rotation, vector_t translation) {
+  assert(polygon->size == source->size);
+  vector_t *v = polygon->vertices;
+  vector_t *s = source->vertices;
+  for (size_t i = 0; i < polygon->size; i++) {
+    v[i].x = translation.x + (s[i].x * rotation.cos - s[i].y * rotation.sin);
+    v[i].y = translation.y + (s[i].x * rotation.sin + s[i].y * rotation.cos);
+  }
+  polygon->has_shape_data = source->has_shape_data;
+  if (source->has_shape_data) {
+    vector_t *normals = polygon_normal_array(polygon);
+    vector_t *source_normals = polygon_normal_array(source);
+    for (size_t i = 0; i < polygon->size; i++) {
+      normals[i] = vec_rotate_by(source_normals[i], rotation);
+    }
+    polygon->area = source->area;
+    polygon->centroid =
+        vec_add(vec_rotate_by(source->centroid, rotation), translation);
+    polygon->radius = source->radius;
+    polygon->moment_of_inertia = source->moment_of_inertia;
+  }
+}
+
+aabb_t polygon_bounds(polygon_t *polygon) {
+  assert(polygon->size > 0);
+  vector_t *v = polygon->vertices;
+  aabb_t box = {v[0], v[0]};
+  for (size_t i = 1; i < polygon->size; i++) {
+    box.min.x = fmin(box.min.x, v[i].x);
+    box.min.y = fmin(box.min.y, v[i].y);
+    box.max.x = fmax(box.max.x, v[i].x);
+    box.max.y = fmax(box.max.y, v[i].y);
+  }
+  return box;
+}
+
+aabb_t aabb_translate(aabb_t box, vector_t translation) {
+  return (aabb_t){vec_add(box.min, translation),
+                  vec_add(box.max, translation)};
+}
+
+bool aabb_overlaps(aabb_t box1, aabb_t box2) {
+  return box1.min.x <= box2.max.x && box2.min.x <= box1.max.x &&
+         box1.min.y <= box2.max.y && box2.min.y <= box1.max.y;
+}
+
+double polygon_area(list_t *polygon) {
+  polygon_t *packed = polygon_from_list(polygon);
+  double area = polygon_area_packed(packed);
+  polygon_free(packed);
+  return area;
+}
+
+vector_t polygon_centroid(list_t *polygon) {
+  polygon_t *packed = polygon_from_list(polygon);
+  vector_t centroid = polygon_centroid_packed(packed);
+  polygon_free(packed);
+  return centroid;
+}
+
+void polygon_translate(list_t *polygon, vector_t translation) {
+  polygon_t *packed = polygon_from_list(polygon);
+  polygon_translate_packed(packed, translation);
+  polygon_store_list(packed, polygon);
+  polygon_free(packed);
+}
+
+void polygon_rotate(list_t *polygon, double angle, vector_t point) {
+  polygon_t *packed = polygon_from_list(polygon);
+  polygon_rotate_packed(packed, angle, point);
+  polygon_store_list(packed, polygon);
+  polygon_free(packed);
+}
@@ -1,5 +1,6 @@
 #include "../include/portal.h"
 #include "../include/collision.h"
+#include "../include/render_backend.h"
 #include <assert.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -35,6 +36,10 @@ body_t *portal_get_body(portal_t *portal) { return portal->body; }
 
 vector_t portal_get_direction(portal_t *portal) { return portal->direction; }
 
+void portal_preload_sound(void) {
+  render_preload_sound(PORTAL_SOUND_EFFECT_PATH);
+}
+
 void portal_tick(portal_t *portal, portal_t *other_portal,
                  body_t *transport_body, bool *is_teleporting) {
   if (portal && other_portal && transport_body) {
@@ -47,17 +52,10 @@ void portal_tick(portal_t *portal, portal_t *other_portal,
 
     vector_t direction_vec = vec_subtract(transport_centroid, portal_centroid);
 
-    list_t *portal_shape = body_get_shape(portal->body);
-    list_t *other_portal_shape = body_get_shape(other_portal->body);
-    list_t *transport_shape = body_get_shape(transport_body);
-
     collision_info_t collision_info =
-        find_collision(portal_shape, transport_shape);
+        find_body_collision(portal->body, transport_body);
     collision_info_t collision_info_other =
-        find_collision(other_portal_shape, transport_shape);
-    list_free(portal_shape);
-    list_free(transport_shape);
-    list_free(other_portal_shape);
+        find_body_collision(other_portal->body, transport_body);
 
     if (collision_info.collided || collision_info_other.collided) {
       *is_teleporting = true;
@@ -80,7 +78,7 @@ void portal_tick(portal_t *portal, portal_t *other_portal,
       body_set_centroid(transport_body, new_centroid);
       body_set_velocity(transport_body, new_velocity);
       
-      sdl_play_sound(PORTAL_SOUND_EFFECT_PATH);
+      render_play_sound(PORTAL_SOUND_EFFECT_PATH);
     }
   }
 }
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include "../include/raster_backend.h"
+#include "../include/body.h"
+#include "../include/list.h"
+#include "../include/polygon.h"
+#include "../include/scene.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t RASTER_BYTES_PER_PIXEL = 4;
+const uint8_t RASTER_BACKGROUND[4] = {255, 255, 255, 255};
+const uint8_t RASTER_BOUNDARY[4] = {0, 0, 0, 255};
+
+/**
+ * A stand-in for an image file, handed to bodies as an image_t *.
+ * Only the path is kept; it picks the color the image is drawn in.
+ */
+typedef struct raster_image {
+  char *path;
+  uint8_t color[4];
+  size_t refcount;
+} raster_image_t;
+
+void raster_image_free(raster_image_t *image) {
+  free(image->path);
+  free(image);
+}
+
+typedef struct raster_target {
+  size_t width;
+  size_t height;
+  uint8_t *pixels;
+  // The same mapping sdl_wrapper.c uses, for a window of this size
+  vector_t center;
+  vector_t max_diff;
+  vector_t window_center;
+  double scale;
+  // Scratch space for drawing polygons, kept between frames
+  vector_t *points;
+  double *crossings;
+  size_t scratch_capacity;
+  list_t *images;
+  size_t frames;
+} raster_target_t;
+
+void raster_target_free(raster_target_t *target) {
+  free(target->pixels);
+  free(target->points);
+  free(target->crossings);
+  list_free(target->images);
+  free(target);
+}
+
+/** Maps a scene coordinate to a pixel coordinate, like get_window_position */
+vector_t raster_position(raster_target_t *target, vector_t scene_pos) {
+  vector_t scene_center_offset = vec_subtract(scene_pos, target->center);
+  vector_t pixel_center_offset =
+      vec_multiply(target->scale, scene_center_offset);
+  return (vector_t){round(target->window_center.x + pixel_center_offset.x),
+                    round(target->window_center.y - pixel_center_offset.y)};
+}
+
+void raster_color(rgb_color_t color, uint8_t rgba[4]) {
+  assert(0 <= color.r && color.r <= 1);
+  assert(0 <= color.g && color.g <= 1);
+  assert(0 <= color.b && color.b <= 1);
+  rgba[0] = color.r * 255;
+  rgba[1] = color.g * 255;
+  rgba[2] = color.b * 255;
+  rgba[3] = 255;
+}
+
+/** Fills the pixels [x_min, x_max) of a row, clipped to the image */
+void raster_fill_span(raster_target_t *target, int64_t y, int64_t x_min,
+                      int64_t x_max, const uint8_t rgba[4]) {
+  if (y < 0 || y >= (int64_t)target->height) {
+    return;
+  }
+  if (x_min < 0) {
+    x_min = 0;
+  }
+  if (x_max > (int64_t)target->width) {
+    x_max = (int64_t)target->width;
+  }
+  uint8_t *pixel =
+      &target->pixels[(y * target->width + x_min) * RASTER_BYTES_PER_PIXEL];
+  for (int64_t x = x_min; x < x_max; x++) {
+    memcpy(pixel, rgba, RASTER_BYTES_PER_PIXEL);
+    pixel += RASTER_BYTES_PER_PIXEL;
+  }
+}
+
+void raster_fill_rect(raster_target_t *target, int64_t x, int64_t y,
+                      int64_t w, int64_t h, const uint8_t rgba[4]) {
+  int64_t y_min = y < 0 ? 0 : y;
+  int64_t height = (int64_t)target->height;
+  int64_t y_max = y + h > height ? height : y + h;
+  for (int64_t row = y_min; row < y_max; row++) {
+    raster_fill_span(target, row, x, x + w, rgba);
+  }
+}
+
+/** Fills a box in scene coordinates, rounded to pixels like get_dest_rect */
+void raster_fill_bounds(raster_target_t *target, aabb_t bounds,
+                        const uint8_t rgba[4]) {
+  vector_t top_left =
+      raster_position(target, (vector_t){bounds.min.x, bounds.max.y});
+  vector_t bottom_right =
+      raster_position(target, (vector_t){bounds.max.x, bounds.min.y});
+  raster_fill_rect(target, top_left.x, top_left.y,
+                   bottom_right.x - top_left.x, bottom_right.y - top_left.y,
+                   rgba);
+}
+
+void raster_reserve(raster_target_t *target, size_t num_points) {
+  if (num_points <= target->scratch_capacity) {
+    return;
+  }
+  target->points = realloc(target->points, num_points * sizeof(vector_t));
+  target->crossings = realloc(target->crossings, num_points * sizeof(double));
+  assert(target->points && target->crossings);
+  target->scratch_capacity = num_points;
+}
+
+/**
+ * Fills a polygon with scanlines, sampling each pixel at its center.
+ * Uses the even-odd rule, so concave polygons are drawn correctly too.
+ */
+void raster_fill_polygon(raster_target_t *target, polygon_t *shape,
+                         vector_t offset, const uint8_t rgba[4]) {
+  size_t n = polygon_size(shape);
+  assert(n >= 3);
+  raster_reserve(target, n);
+  vector_t *vertices = polygon_vertices(shape);
+  vector_t *points = target->points;
+  double y_min = INFINITY, y_max = -INFINITY;
+  for (size_t i = 0; i < n; i++) {
+    points[i] = raster_position(target, vec_add(vertices[i], offset));
+    y_min = fmin(y_min, points[i].y);
+    y_max = fmax(y_max, points[i].y);
+  }
+  int64_t row_min = fmax(floor(y_min), 0);
+  int64_t row_max = fmin(ceil(y_max), target->height);
+
+  for (int64_t row = row_min; row < row_max; row++) {
+    double y = row + 0.5;
+    size_t num_crossings = 0;
+    for (size_t i = 0; i < n; i++) {
+      vector_t p0 = points[i];
+      vector_t p1 = points[(i + 1) % n];
+      if ((p0.y <= y) == (p1.y <= y)) {
+        continue;
+      }
+      double x = p0.x + (y - p0.y) * (p1.x - p0.x) / (p1.y - p0.y);
+      // Insertion sort: a row crosses only a few edges
+      size_t j = num_crossings++;
+      while (j > 0 && target->crossings[j - 1] > x) {
+        target->crossings[j] = target->crossings[j - 1];
+        j--;
+      }
+      target->crossings[j] = x;
+    }
+    for (size_t i = 0; i + 1 < num_crossings; i += 2) {
+      // The pixels whose centers lie between the two crossings
+      int64_t x_min = ceil(target->crossings[i] - 0.5);
+      int64_t x_max = ceil(target->crossings[i + 1] - 0.5);
+      raster_fill_span(target, row, x_min, x_max, rgba);
+    }
+  }
+}
+
+/** Outlines the scene's boundary, like sdl_show() */
+void raster_draw_boundary(raster_target_t *target) {
+  vector_t max = raster_position(target, vec_add(target->center,
+                                                 target->max_diff));
+  vector_t min = raster_position(target, vec_subtract(target->center,
+                                                      target->max_diff));
+  int64_t w = max.x - min.x, h = min.y - max.y;
+  raster_fill_rect(target, min.x, max.y, w, 1, RASTER_BOUNDARY);
+  raster_fill_rect(target, min.x, min.y - 1, w, 1, RASTER_BOUNDARY);
+  raster_fill_rect(target, min.x, max.y, 1, h, RASTER_BOUNDARY);
+  raster_fill_rect(target, max.x - 1, max.y, 1, h, RASTER_BOUNDARY);
+}
+
+image_t *raster_backend_acquire_image(void *aux, const char *image_filename) {
+  raster_target_t *target = aux;
+  raster_image_t *image = NULL;
+  for (size_t i = 0; i < list_size(target->images); i++) {
+    raster_image_t *cached = list_get(target->images, i);
+    if (strcmp(cached->path, image_filename) == 0) {
+      image = cached;
+      break;
+    }
+  }
+  if (!image) {
+    image = malloc(sizeof(raster_image_t));
+    assert(image);
+    image->path = strdup(image_filename);
+    assert(image->path);
+    // FNV-1a, so each file gets its own stable color
+    uint32_t hash = 2166136261u;
+    for (const char *c = image_filename; *c; c++) {
+      hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    image->color[0] = hash;
+    image->color[1] = hash >> 8;
+    image->color[2] = hash >> 16;
+    image->color[3] = 255;
+    image->refcount = 0;
+    list_add(target->images, image);
+  }
+  image->refcount++;
+  return (image_t *)image;
+}
+
+void raster_backend_retain_image(void *aux, image_t *image) {
+  ((raster_image_t *)image)->refcount++;
+}
+
+void raster_backend_release_image(void *aux, image_t *image) {
+  raster_image_t *raster_image = (raster_image_t *)image;
+  assert(raster_image->refcount > 0);
+  raster_image->refcount--;
+}
+
+void raster_backend_render_scene(void *aux, scene_t *scene) {
+  raster_target_t *target = aux;
+  size_t num_pixels = target->width * target->height;
+  for (size_t i = 0; i < num_pixels; i++) {
+    memcpy(&target->pixels[i * RASTER_BYTES_PER_PIXEL], RASTER_BACKGROUND,
+           RASTER_BYTES_PER_PIXEL);
+  }
+
+  double alpha = scene_get_interpolation_alpha(scene);
+  size_t body_count = scene_bodies(scene);
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = scene_get_body(scene, i);
+    vector_t offset = render_interpolation_offset(body, alpha);
+    aabb_t bounds = aabb_translate(body_get_bounds(body), offset);
+    uint8_t rgba[4];
+    raster_image_t *image = (raster_image_t *)body_get_image(body);
+    if (image != NULL) {
+      raster_fill_bounds(target, bounds, image->color);
+    } else if (body_get_is_visible(body)) {
+      raster_color(body_get_color(body), rgba);
+      raster_fill_polygon(target, body_peek_shape(body), offset, rgba);
+    }
+
+    const char *label = body_get_label(body);
+    if (body_get_text(body) == NULL && label == NULL) {
+      continue;
+    }
+    // Text covers the middle of the body, as in sdl_render_scene()
+    vector_t size = vec_subtract(bounds.max, bounds.min);
+    aabb_t text_bounds = {vec_add(bounds.min, vec_multiply(0.25, size)),
+                          vec_subtract(bounds.max, vec_multiply(0.25, size))};
+    raster_color(label ? body_get_label_color(body) : (rgb_color_t){0, 0, 0},
+                 rgba);
+    raster_fill_bounds(target, text_bounds, rgba);
+  }
+  raster_draw_boundary(target);
+  target->frames++;
+}
+
+render_backend_t *raster_backend_init(size_t width, size_t height,
+                                      vector_t min, vector_t max) {
+  assert(width > 0 && height > 0);
+  assert(min.x < max.x);
+  assert(min.y < max.y);
+  raster_target_t *target = calloc(1, sizeof(raster_target_t));
+  assert(target);
+  target->width = width;
+  target->height = height;
+  target->pixels = malloc(width * height * RASTER_BYTES_PER_PIXEL);
+  assert(target->pixels);
+  target->center = vec_multiply(0.5, vec_add(min, max));
+  target->max_diff = vec_subtract(max, target->center);
+  target->window_center = (vector_t){0.5 * width, 0.5 * height};
+  target->scale = fmin(target->window_center.x / target->max_diff.x,
+                       target->window_center.y / target->max_diff.y);
+  target->images = list_init(4, (free_func_t)raster_image_free);
+
+  render_backend_t *backend = malloc(sizeof(render_backend_t));
+  assert(backend);
+  *backend =
+      (render_backend_t){.acquire_image = raster_backend_acquire_image,
+                         .retain_image = raster_backend_retain_image,
+                         .release_image = raster_backend_release_image,
+                         .render_scene = raster_backend_render_scene,
+                         .play_sound = NULL,
+                         .preload_sound = NULL,
+                         .aux = target,
+                         .aux_freer = (free_func_t)raster_target_free};
+  return backend;
+}
+
+raster_target_t *raster_backend_target(render_backend_t *backend) {
+  assert(backend->render_scene == raster_backend_render_scene);
+  return backend->aux;
+}
+
+const uint8_t *raster_backend_pixels(render_backend_t *backend) {
+  return raster_backend_target(backend)->pixels;
+}
+
+size_t raster_backend_frames(render_backend_t *backend) {
+  return raster_backend_target(backend)->frames;
+}
+
+bool raster_backend_write_ppm(render_backend_t *backend,
+                              const char *filename) {
+  raster_target_t *target = raster_backend_target(backend);
+  FILE *file = fopen(filename, "wb");
+  if (!file) {
+    return false;
+  }
+  fprintf(file, "P6\n%zu %zu\n255\n", target->width, target->height);
+  size_t row_size = 3 * target->width;
+  uint8_t *row = malloc(row_size);
+  assert(row);
+  bool ok = true;
+  for (size_t y = 0; y < target->height && ok; y++) {
+    uint8_t *pixel =
+        &target->pixels[y * target->width * RASTER_BYTES_PER_PIXEL];
+    for (size_t x = 0; x < target->width; x++) {
+      memcpy(&row[3 * x], &pixel[RASTER_BYTES_PER_PIXEL * x], 3);
+    }
+    ok = fwrite(row, 1, row_size, file) == row_size;
+  }
+  free(row);
+  return fclose(file) == 0 && ok;
+}
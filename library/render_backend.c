@@ -0,0 +1,117 @@
+#include "../include/render_backend.h"
+#include "../include/body.h"
+#include "../include/scene.h"
+#include "../include/vector.h"
+#include <assert.h>
+#include <stdlib.h>
+
+/**
+ * The backend used by the render_* functions, or NULL for none.
+ */
+render_backend_t *active_backend = NULL;
+
+/** What a null backend has been asked to draw */
+typedef struct null_backend_counts {
+  size_t frames;
+  size_t bodies_drawn;
+} null_backend_counts_t;
+
+image_t *null_backend_acquire_image(void *aux, const char *image_filename) {
+  return NULL;
+}
+
+void null_backend_retain_image(void *aux, image_t *image) {}
+
+void null_backend_release_image(void *aux, image_t *image) {}
+
+void null_backend_render_scene(void *aux, scene_t *scene) {
+  null_backend_counts_t *counts = aux;
+  counts->frames++;
+  counts->bodies_drawn += scene_bodies(scene);
+}
+
+render_backend_t *null_backend_init(void) {
+  render_backend_t *backend = malloc(sizeof(render_backend_t));
+  assert(backend);
+  null_backend_counts_t *counts = calloc(1, sizeof(null_backend_counts_t));
+  assert(counts);
+  *backend = (render_backend_t){.acquire_image = null_backend_acquire_image,
+                                .retain_image = null_backend_retain_image,
+                                .release_image = null_backend_release_image,
+                                .render_scene = null_backend_render_scene,
+                                .play_sound = NULL,
+                                .preload_sound = NULL,
+                                .aux = counts,
+                                .aux_freer = free};
+  return backend;
+}
+
+size_t null_backend_frames(render_backend_t *backend) {
+  assert(backend->render_scene == null_backend_render_scene);
+  return ((null_backend_counts_t *)backend->aux)->frames;
+}
+
+size_t null_backend_bodies_drawn(render_backend_t *backend) {
+  assert(backend->render_scene == null_backend_render_scene);
+  return ((null_backend_counts_t *)backend->aux)->bodies_drawn;
+}
+
+void render_backend_free(render_backend_t *backend) {
+  assert(backend != active_backend);
+  if (backend->aux_freer) {
+    backend->aux_freer(backend->aux);
+  }
+  free(backend);
+}
+
+void render_set_backend(render_backend_t *backend) {
+  active_backend = backend;
+}
+
+render_backend_t *render_get_backend(void) { return active_backend; }
+
+image_t *render_acquire_image(const char *image_filename) {
+  if (!active_backend) {
+    return NULL;
+  }
+  return active_backend->acquire_image(active_backend->aux, image_filename);
+}
+
+image_t *render_retain_image(image_t *image) {
+  // Images only come from a backend, so there must be one
+  assert(active_backend);
+  active_backend->retain_image(active_backend->aux, image);
+  return image;
+}
+
+void render_release_image(image_t *image) {
+  assert(active_backend);
+  active_backend->release_image(active_backend->aux, image);
+}
+
+void render_scene(scene_t *scene) {
+  if (active_backend) {
+    active_backend->render_scene(active_backend->aux, scene);
+  }
+}
+
+void render_play_sound(const char *sound_filename) {
+  if (active_backend && active_backend->play_sound) {
+    active_backend->play_sound(active_backend->aux, sound_filename);
+  }
+}
+
+void render_preload_sound(const char *sound_filename) {
+  if (active_backend && active_backend->preload_sound) {
+    active_backend->preload_sound(active_backend->aux, sound_filename);
+  }
+}
+
+vector_t render_interpolation_offset(body_t *body, double alpha) {
+  if (alpha >= 1) {
+    return VEC_ZERO;
+  }
+  vector_t step = vec_subtract(body_get_centroid(body),
+                               body_get_previous_centroid(body));
+  return vec_multiply(alpha - 1, step);
+}
@@ -2,32 +2,290 @@
 #include "../include/body.h"
 #include "../include/forces.h"
 #include "../include/platform.h"
-#include "../include/portal.h"
+#include "../include/spatial_hash.h"
+#include "../include/sweep_prune.h"
 #include <assert.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 const size_t INITIAL_NUM_BODIES = 10;
 const size_t INITIAL_NUM_FORCE_CREATORS = 10;
+const size_t INITIAL_APPLIER_INDEX_CAPACITY = 16;
+
+/** A body and the force appliers acting on it; empty if body is NULL */
+typedef struct applier_index_entry {
+  body_t *body;
+  list_t *appliers;
+} applier_index_entry_t;
+
+/**
+ * The kinematic fields of a scene's bodies, with one packed array per field
+ * so the bodies can be integrated in a single sweep.
+ * Entry i belongs to the body at index i of the scene's list of bodies.
+ */
+typedef struct body_store {
+  vector_t *centroids;
+  vector_t *prev_centroids;
+  vector_t *velocities;
+  vector_t *forces;
+  vector_t *impulses;
+  double *inverse_masses;
+  bool *removed;
+  // Whether any body was moved by something other than integration
+  // since the broad phase was last updated
+  bool bodies_moved;
+  size_t capacity;
+} body_store_t;
 
 typedef struct scene {
   list_t *bodies;
+  body_store_t store;
   list_t *force_appliers;
+  // Open-addressed map from each body to the appliers listing it,
+  // so removing a body only visits the forces that depend on it
+  applier_index_entry_t *applier_index;
+  size_t applier_index_size;
+  size_t applier_index_capacity; // always a power of 2
+  // At most one broad phase is enabled at a time
+  spatial_hash_t *grid;
+  sweep_prune_t *sap;
+  bool broad_phase_dirty;
+  // Fixed timestep mode, if fixed_dt > 0
+  double fixed_dt;
+  size_t max_substeps;
+  double accumulator;
 } scene_t;
 
+/**
+ * Gets where the store keeps the kinematic fields of one body.
+ */
+body_kinematics_t body_store_slot(body_store_t *store, size_t index) {
+  return (body_kinematics_t){.centroid = &store->centroids[index],
+                             .prev_centroid = &store->prev_centroids[index],
+                             .velocity = &store->velocities[index],
+                             .force = &store->forces[index],
+                             .impulse = &store->impulses[index],
+                             .inverse_mass = &store->inverse_masses[index],
+                             .is_removed = &store->removed[index],
+                             .moved = &store->bodies_moved};
+}
+
+/**
+ * Makes room in a scene's store for a number of bodies.
+ * If the arrays move, the scene's bodies are pointed at their new slots.
+ */
+void body_store_reserve(scene_t *scene, size_t num_bodies) {
+  body_store_t *store = &scene->store;
+  if (num_bodies <= store->capacity) {
+    return;
+  }
+  size_t capacity = store->capacity ? store->capacity : INITIAL_NUM_BODIES;
+  while (capacity < num_bodies) {
+    capacity *= 2;
+  }
+  store->centroids = realloc(store->centroids, capacity * sizeof(vector_t));
+  store->prev_centroids =
+      realloc(store->prev_centroids, capacity * sizeof(vector_t));
+  store->velocities = realloc(store->velocities, capacity * sizeof(vector_t));
+  store->forces = realloc(store->forces, capacity * sizeof(vector_t));
+  store->impulses = realloc(store->impulses, capacity * sizeof(vector_t));
+  store->inverse_masses =
+      realloc(store->inverse_masses, capacity * sizeof(double));
+  store->removed = realloc(store->removed, capacity * sizeof(bool));
+  assert(store->centroids && store->prev_centroids && store->velocities);
+  assert(store->forces && store->impulses && store->inverse_masses);
+  assert(store->removed);
+  store->capacity = capacity;
+
+  for (size_t i = 0; i < list_size(scene->bodies); i++) {
+    body_set_kinematics(list_get(scene->bodies, i), body_store_slot(store, i));
+  }
+}
+
+/**
+ * Moves the entries of the bodies that were not marked for removal
+ * to the front of the store, keeping them in order, once the scene's
+ * list of bodies has been compacted to match.
+ *
+ * @param scene the scene whose store to compact
+ * @param num_entries the number of bodies before the list was compacted
+ */
+void body_store_compact(scene_t *scene, size_t num_entries) {
+  body_store_t *store = &scene->store;
+  size_t kept = 0;
+  for (size_t i = 0; i < num_entries; i++) {
+    if (store->removed[i]) {
+      continue;
+    }
+    if (kept != i) {
+      store->centroids[kept] = store->centroids[i];
+      store->prev_centroids[kept] = store->prev_centroids[i];
+      store->velocities[kept] = store->velocities[i];
+      store->forces[kept] = store->forces[i];
+      store->impulses[kept] = store->impulses[i];
+      store->inverse_masses[kept] = store->inverse_masses[i];
+      store->removed[kept] = false;
+      body_set_kinematics(list_get(scene->bodies, kept),
+                          body_store_slot(store, kept));
+    }
+    kept++;
+  }
+  assert(kept == list_size(scene->bodies));
+}
+
+/**
+ * Integrates one body in a store like body_tick().
+ * A body with infinite mass keeps its velocity, whatever acts on it.
+ */
+void body_store_integrate_one(body_store_t *store, size_t i, double dt) {
+  double inverse_mass = store->inverse_masses[i];
+  vector_t velocity = store->velocities[i];
+  vector_t new_velocity = velocity;
+  if (inverse_mass != 0) {
+    vector_t force = store->forces[i];
+    vector_t impulse = store->impulses[i];
+    new_velocity = (vector_t){
+        velocity.x + dt * (inverse_mass * force.x) + inverse_mass * impulse.x,
+        velocity.y + dt * (inverse_mass * force.y) + inverse_mass * impulse.y};
+  }
+  vector_t centroid = store->centroids[i];
+  store->prev_centroids[i] = centroid;
+  store->centroids[i] =
+      (vector_t){centroid.x + dt * (0.5 * (new_velocity.x + velocity.x)),
+                 centroid.y + dt * (0.5 * (new_velocity.y + velocity.y))};
+  store->velocities[i] = new_velocity;
+  store->forces[i] = VEC_ZERO;
+  store->impulses[i] = VEC_ZERO;
+}
+
+/**
+ * Integrates every body in a store like body_tick(), except that the bodies'
+ * shapes are left to catch up when they are next needed.
+ * Uses AVX2 to integrate two bodies at a time, or SSE2 for one at a time,
+ * if the compiler targets them; the arithmetic is the same in every case,
+ * so the results don't depend on which is used.
+ */
+void body_store_integrate(body_store_t *store, size_t num_bodies, double dt) {
+  size_t i = 0;
+  // Each vector_t is two adjacent doubles, so a register holds whole vectors
+  double *centroids = (double *)store->centroids;
+  double *prev_centroids = (double *)store->prev_centroids;
+  double *velocities = (double *)store->velocities;
+  double *forces = (double *)store->forces;
+  double *impulses = (double *)store->impulses;
+#if defined(__AVX2__)
+  __m256d dts = _mm256_set1_pd(dt);
+  __m256d halves = _mm256_set1_pd(0.5);
+  __m256d zeros = _mm256_setzero_pd();
+  for (; i + 2 <= num_bodies; i += 2) {
+    // Each inverse mass is used for both components of its body
+    __m128d masses = _mm_loadu_pd(&store->inverse_masses[i]);
+    __m256d inverse_masses =
+        _mm256_permute4x64_pd(_mm256_castpd128_pd256(masses), 0x50);
+    __m256d velocity = _mm256_loadu_pd(&velocities[2 * i]);
+    __m256d acceleration =
+        _mm256_mul_pd(inverse_masses, _mm256_loadu_pd(&forces[2 * i]));
+    __m256d new_velocity =
+        _mm256_add_pd(velocity, _mm256_mul_pd(dts, acceleration));
+    new_velocity = _mm256_add_pd(
+        new_velocity,
+        _mm256_mul_pd(inverse_masses, _mm256_loadu_pd(&impulses[2 * i])));
+    __m256d fixed = _mm256_cmp_pd(inverse_masses, zeros, _CMP_EQ_OQ);
+    new_velocity = _mm256_blendv_pd(new_velocity, velocity, fixed);
+    __m256d centroid = _mm256_loadu_pd(&centroids[2 * i]);
+    _mm256_storeu_pd(&prev_centroids[2 * i], centroid);
+    __m256d average_velocity =
+        _mm256_mul_pd(halves, _mm256_add_pd(new_velocity, velocity));
+    centroid = _mm256_add_pd(centroid, _mm256_mul_pd(dts, average_velocity));
+    _mm256_storeu_pd(&centroids[2 * i], centroid);
+    _mm256_storeu_pd(&velocities[2 * i], new_velocity);
+    _mm256_storeu_pd(&forces[2 * i], zeros);
+    _mm256_storeu_pd(&impulses[2 * i], zeros);
+  }
+#elif defined(__SSE2__)
+  __m128d dts = _mm_set1_pd(dt);
+  __m128d halves = _mm_set1_pd(0.5);
+  __m128d zeros = _mm_setzero_pd();
+  for (; i < num_bodies; i++) {
+    __m128d inverse_mass = _mm_set1_pd(store->inverse_masses[i]);
+    __m128d velocity = _mm_loadu_pd(&velocities[2 * i]);
+    __m128d acceleration =
+        _mm_mul_pd(inverse_mass, _mm_loadu_pd(&forces[2 * i]));
+    __m128d new_velocity = _mm_add_pd(velocity, _mm_mul_pd(dts, acceleration));
+    new_velocity = _mm_add_pd(
+        new_velocity, _mm_mul_pd(inverse_mass, _mm_loadu_pd(&impulses[2 * i])));
+    __m128d fixed = _mm_cmpeq_pd(inverse_mass, zeros);
+    new_velocity = _mm_or_pd(_mm_and_pd(fixed, velocity),
+                             _mm_andnot_pd(fixed, new_velocity));
+    __m128d centroid = _mm_loadu_pd(&centroids[2 * i]);
+    _mm_storeu_pd(&prev_centroids[2 * i], centroid);
+    __m128d average_velocity =
+        _mm_mul_pd(halves, _mm_add_pd(new_velocity, velocity));
+    centroid = _mm_add_pd(centroid, _mm_mul_pd(dts, average_velocity));
+    _mm_storeu_pd(&centroids[2 * i], centroid);
+    _mm_storeu_pd(&velocities[2 * i], new_velocity);
+    _mm_storeu_pd(&forces[2 * i], zeros);
+    _mm_storeu_pd(&impulses[2 * i], zeros);
+  }
+#endif
+  for (; i < num_bodies; i++) {
+    body_store_integrate_one(store, i, dt);
+  }
+}
+
 scene_t *scene_init(void) {
   scene_t *new_scene = calloc(1, sizeof(scene_t));
   assert(new_scene);
   new_scene->bodies = list_init(INITIAL_NUM_BODIES, (free_func_t)body_free);
+  body_store_reserve(new_scene, INITIAL_NUM_BODIES);
   new_scene->force_appliers =
       list_init(INITIAL_NUM_FORCE_CREATORS, (free_func_t)force_applier_free);
+  new_scene->applier_index = calloc(INITIAL_APPLIER_INDEX_CAPACITY,
+                                    sizeof(applier_index_entry_t));
+  assert(new_scene->applier_index);
+  new_scene->applier_index_capacity = INITIAL_APPLIER_INDEX_CAPACITY;
 
   return new_scene;
 }
 
+/**
+ * Frees whichever broad phase the scene has, if any.
+ */
+void scene_disable_broad_phase(scene_t *scene) {
+  if (scene->grid) {
+    spatial_hash_free(scene->grid);
+    scene->grid = NULL;
+  }
+  if (scene->sap) {
+    sweep_prune_free(scene->sap);
+    scene->sap = NULL;
+  }
+}
+
 void scene_free(scene_t *scene) {
+  for (size_t i = 0; i < scene->applier_index_capacity; i++) {
+    if (scene->applier_index[i].body) {
+      list_free(scene->applier_index[i].appliers);
+    }
+  }
+  free(scene->applier_index);
   list_free(scene->bodies);
+  free(scene->store.centroids);
+  free(scene->store.prev_centroids);
+  free(scene->store.velocities);
+  free(scene->store.forces);
+  free(scene->store.impulses);
+  free(scene->store.inverse_masses);
+  free(scene->store.removed);
   list_free(scene->force_appliers);
+  scene_disable_broad_phase(scene);
   free(scene);
 }
 
@@ -38,13 +296,143 @@ body_t *scene_get_body(scene_t *scene, size_t index) {
 }
 
 void scene_add_body(scene_t *scene, body_t *body) {
+  size_t index = list_size(scene->bodies);
+  body_store_reserve(scene, index + 1);
   list_add(scene->bodies, body);
+  body_move_kinematics(body, body_store_slot(&scene->store, index));
+  if (scene->sap) {
+    sweep_prune_add(scene->sap, body);
+  }
+  scene->broad_phase_dirty = true;
 }
 
 void scene_remove_body(scene_t *scene, size_t index) {
   body_remove(scene_get_body(scene, index));
 }
 
+size_t applier_index_home(scene_t *scene, body_t *body) {
+  uint64_t key = (uint64_t)(uintptr_t)body * 0x9E3779B97F4A7C15ULL;
+  key ^= key >> 31;
+  return key & (scene->applier_index_capacity - 1);
+}
+
+/**
+ * Finds the slot holding a body's entry, or the empty slot where it would go.
+ */
+size_t applier_index_find(scene_t *scene, body_t *body) {
+  size_t mask = scene->applier_index_capacity - 1;
+  size_t i = applier_index_home(scene, body);
+  while (scene->applier_index[i].body && scene->applier_index[i].body != body) {
+    i = (i + 1) & mask;
+  }
+  return i;
+}
+
+void applier_index_grow(scene_t *scene) {
+  applier_index_entry_t *old_entries = scene->applier_index;
+  size_t old_capacity = scene->applier_index_capacity;
+  scene->applier_index_capacity *= 2;
+  scene->applier_index =
+      calloc(scene->applier_index_capacity, sizeof(applier_index_entry_t));
+  assert(scene->applier_index);
+  for (size_t i = 0; i < old_capacity; i++) {
+    if (old_entries[i].body) {
+      scene->applier_index[applier_index_find(scene, old_entries[i].body)] =
+          old_entries[i];
+    }
+  }
+  free(old_entries);
+}
+
+/** Records that a force applier acts on a body */
+void applier_index_add(scene_t *scene, body_t *body,
+                       force_applier_t *force_applier) {
+  size_t i = applier_index_find(scene, body);
+  if (!scene->applier_index[i].body) {
+    scene->applier_index[i] =
+        (applier_index_entry_t){body, list_init(2, NULL)};
+    scene->applier_index_size++;
+  }
+  list_add(scene->applier_index[i].appliers, force_applier);
+  // Keep the table at most half full so probes stay short
+  if (2 * scene->applier_index_size > scene->applier_index_capacity) {
+    applier_index_grow(scene);
+  }
+}
+
+/** Forgets that a force applier acts on a body */
+void applier_index_unlink(scene_t *scene, body_t *body,
+                          force_applier_t *force_applier) {
+  size_t slot = applier_index_find(scene, body);
+  list_t *appliers = scene->applier_index[slot].appliers;
+  for (size_t i = 0; i < list_size(appliers); i++) {
+    if (list_get(appliers, i) == force_applier) {
+      list_swap_remove(appliers, i);
+      return;
+    }
+  }
+}
+
+/** Drops a body's entry, returning its list of appliers or NULL if none */
+list_t *applier_index_take(scene_t *scene, body_t *body) {
+  size_t i = applier_index_find(scene, body);
+  list_t *appliers = scene->applier_index[i].appliers;
+  if (!appliers) {
+    return NULL;
+  }
+  scene->applier_index[i] = (applier_index_entry_t){NULL, NULL};
+  scene->applier_index_size--;
+
+  // Shift later entries of the probe run back so lookups still find them
+  size_t mask = scene->applier_index_capacity - 1;
+  size_t j = i;
+  while (true) {
+    j = (j + 1) & mask;
+    if (!scene->applier_index[j].body) {
+      break;
+    }
+    size_t home = applier_index_home(scene, scene->applier_index[j].body);
+    bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+    if (!stays) {
+      scene->applier_index[i] = scene->applier_index[j];
+      scene->applier_index[j] = (applier_index_entry_t){NULL, NULL};
+      i = j;
+    }
+  }
+  return appliers;
+}
+
+/**
+ * Marks every force applier acting on a removed body for removal,
+ * unlinking them from the index entries of the bodies that remain.
+ *
+ * @return the number of appliers newly marked
+ */
+size_t scene_remove_appliers_of(scene_t *scene, body_t *body) {
+  list_t *appliers = applier_index_take(scene, body);
+  if (!appliers) {
+    return 0;
+  }
+  size_t num_removed = 0;
+  for (size_t i = 0; i < list_size(appliers); i++) {
+    force_applier_t *force_applier = list_get(appliers, i);
+    if (force_applier_is_removed(force_applier)) {
+      continue;
+    }
+    force_applier_remove(force_applier);
+    num_removed++;
+    list_t *bodies = get_force_applier_bodies(force_applier);
+    for (size_t j = 0; j < list_size(bodies); j++) {
+      body_t *other = list_get(bodies, j);
+      if (!body_is_removed(other)) {
+        applier_index_unlink(scene, other, force_applier);
+      }
+    }
+  }
+  list_free(appliers);
+  return num_removed;
+}
+
 void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
                              free_func_t freer) {
   scene_add_bodies_force_creator(scene, forcer, aux, NULL, freer);
@@ -53,8 +441,22 @@ void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
 void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer) {
-  list_add(scene->force_appliers,
-           force_applier_init(forcer, aux, bodies, freer));
+  force_applier_t *force_applier =
+      force_applier_init(forcer, aux, bodies, freer);
+  list_add(scene->force_appliers, force_applier);
+  if (bodies) {
+    for (size_t i = 0; i < list_size(bodies); i++) {
+      applier_index_add(scene, list_get(bodies, i), force_applier);
+    }
+  }
+}
+
+bool applier_is_removed_predicate(void *force_applier, void *aux) {
+  return force_applier_is_removed(force_applier);
+}
+
+bool body_is_removed_predicate(void *body, void *aux) {
+  return body_is_removed(body);
 }
 
 void scene_tick(scene_t *scene, double dt) {
@@ -64,22 +466,231 @@ void scene_tick(scene_t *scene, double dt) {
     void *aux = get_force_applier_aux(force_applier);
     forcer(aux);
   }
-  for (size_t i = list_size(scene->bodies); i > 0; i--) {
-    body_t *body = list_get(scene->bodies, i - 1);
-    if (body_is_removed(body)) {
-      for (size_t j = list_size(scene->force_appliers); j > 0; j--) {
-        force_applier_t *force_applier = list_get(scene->force_appliers, j - 1);
-        list_t *bodies = get_force_applier_bodies(force_applier);
-        for (size_t k = 0; k < list_size(bodies); k++) {
-          if (list_get(bodies, k) == body) {
-            force_applier_free(list_remove(scene->force_appliers, j - 1));
-            break;
-          }
-        }
-      }
-      body_free(list_remove(scene->bodies, i - 1));
+  body_store_integrate(&scene->store, list_size(scene->bodies), dt);
+  size_t num_removed = 0;
+  size_t num_appliers_removed = 0;
+  for (size_t i = 0; i < list_size(scene->bodies); i++) {
+    if (scene->store.removed[i]) {
+      num_removed++;
+      num_appliers_removed +=
+          scene_remove_appliers_of(scene, list_get(scene->bodies, i));
+    }
+  }
+  // Drop every removed body and the forces on it in one pass per list,
+  // keeping the rest in order since forces depend on the order they run in
+  if (num_appliers_removed > 0) {
+    list_compact(scene->force_appliers, applier_is_removed_predicate, NULL);
+  }
+  if (num_removed > 0) {
+    if (scene->sap) {
+      sweep_prune_remove_marked(scene->sap);
+    }
+    size_t num_bodies = list_size(scene->bodies);
+    list_compact(scene->bodies, body_is_removed_predicate, NULL);
+    body_store_compact(scene, num_bodies);
+  }
+  scene->broad_phase_dirty = true;
+}
+
+void scene_set_fixed_timestep(scene_t *scene, double dt, size_t max_substeps) {
+  assert(dt >= 0);
+  assert(max_substeps > 0);
+  scene->fixed_dt = dt;
+  scene->max_substeps = max_substeps;
+  scene->accumulator = 0;
+}
+
+size_t scene_advance(scene_t *scene, double elapsed, tick_handler_t before_tick,
+                     void *aux) {
+  if (scene->fixed_dt == 0) {
+    if (before_tick) {
+      before_tick(aux, elapsed);
+    }
+    scene_tick(scene, elapsed);
+    return 1;
+  }
+  scene->accumulator += elapsed;
+  size_t num_ticks = 0;
+  while (scene->accumulator >= scene->fixed_dt &&
+         num_ticks < scene->max_substeps) {
+    if (before_tick) {
+      before_tick(aux, scene->fixed_dt);
+    }
+    scene_tick(scene, scene->fixed_dt);
+    scene->accumulator -= scene->fixed_dt;
+    num_ticks++;
+  }
+  if (scene->accumulator >= scene->fixed_dt) {
+    scene->accumulator = fmod(scene->accumulator, scene->fixed_dt);
+  }
+  return num_ticks;
+}
+
+double scene_get_interpolation_alpha(scene_t *scene) {
+  if (scene->fixed_dt == 0) {
+    return 1;
+  }
+  return scene->accumulator / scene->fixed_dt;
+}
+
+void scene_enable_spatial_hash(scene_t *scene, double cell_size) {
+  scene_disable_broad_phase(scene);
+  scene->grid = spatial_hash_init(cell_size);
+  scene->broad_phase_dirty = true;
+}
+
+void scene_enable_sweep_prune(scene_t *scene) {
+  scene_disable_broad_phase(scene);
+  scene->sap = sweep_prune_init();
+  for (size_t i = 0; i < list_size(scene->bodies); i++) {
+    sweep_prune_add(scene->sap, list_get(scene->bodies, i));
+  }
+  scene->broad_phase_dirty = true;
+}
+
+/**
+ * Brings the broad phase of a scene up to date if any bodies
+ * may have moved, been added, or been removed since it was last updated.
+ */
+void scene_update_broad_phase(scene_t *scene) {
+  if (!scene->broad_phase_dirty && !scene->store.bodies_moved) {
+    return;
+  }
+  if (scene->grid) {
+    spatial_hash_clear(scene->grid);
+    for (size_t i = 0; i < list_size(scene->bodies); i++) {
+      spatial_hash_insert(scene->grid, list_get(scene->bodies, i));
+    }
+  } else if (scene->sap) {
+    sweep_prune_update(scene->sap);
+  }
+  scene->broad_phase_dirty = false;
+  scene->store.bodies_moved = false;
+}
+
+void scene_query_bounds(scene_t *scene, aabb_t bounds, list_t *results) {
+  if (scene->grid || scene->sap) {
+    scene_update_broad_phase(scene);
+    size_t start = list_size(results);
+    if (scene->grid) {
+      spatial_hash_query(scene->grid, bounds, results);
     } else {
-      body_tick(body, dt);
+      sweep_prune_query(scene->sap, bounds, results);
+    }
+    // The broad phase keeps bodies marked for removal until the tick ends
+    for (size_t i = list_size(results); i > start; i--) {
+      if (body_is_removed(list_get(results, i - 1))) {
+        list_swap_remove(results, i - 1);
+      }
+    }
+    return;
+  }
+  for (size_t i = 0; i < list_size(scene->bodies); i++) {
+    body_t *body = list_get(scene->bodies, i);
+    if (!body_is_removed(body) &&
+        aabb_overlaps(bounds, body_get_bounds(body))) {
+      list_add(results, body);
+    }
+  }
+}
+
+void scene_for_each_pair(scene_t *scene, body_pair_handler_t handler,
+                         void *aux) {
+  if (scene->grid) {
+    scene_update_broad_phase(scene);
+    spatial_hash_for_each_pair(scene->grid, handler, aux);
+    return;
+  }
+  if (scene->sap) {
+    scene_update_broad_phase(scene);
+    sweep_prune_for_each_pair(scene->sap, handler, aux);
+    return;
+  }
+  size_t num_bodies = list_size(scene->bodies);
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body1 = list_get(scene->bodies, i);
+    aabb_t bounds1 = body_get_bounds(body1);
+    for (size_t j = i + 1; j < num_bodies; j++) {
+      body_t *body2 = list_get(scene->bodies, j);
+      if (aabb_overlaps(bounds1, body_get_bounds(body2))) {
+        handler(body1, body2, aux);
+      }
     }
   }
-}
\ No newline at end of file
+}
+
+typedef struct scene_snapshot {
+  size_t num_bodies;
+  body_t **bodies;
+  // Identifiers, to tell a saved body from a later one at the same address
+  uint64_t *body_ids;
+  body_state_t *states;
+  // Every body's vertices, back to back
+  vector_t *vertices;
+  double accumulator;
+} scene_snapshot_t;
+
+scene_snapshot_t *scene_snapshot(scene_t *scene) {
+  scene_snapshot_t *snapshot = malloc(sizeof(scene_snapshot_t));
+  assert(snapshot);
+  size_t num_bodies = list_size(scene->bodies);
+  size_t num_vertices = 0;
+  for (size_t i = 0; i < num_bodies; i++) {
+    num_vertices += polygon_size(body_peek_shape(list_get(scene->bodies, i)));
+  }
+  snapshot->num_bodies = num_bodies;
+  snapshot->bodies = malloc(num_bodies * sizeof(body_t *));
+  snapshot->body_ids = malloc(num_bodies * sizeof(uint64_t));
+  snapshot->states = malloc(num_bodies * sizeof(body_state_t));
+  snapshot->vertices = malloc(num_vertices * sizeof(vector_t));
+  assert(snapshot->bodies && snapshot->body_ids && snapshot->states);
+  assert(snapshot->vertices || num_vertices == 0);
+  snapshot->accumulator = scene->accumulator;
+
+  vector_t *vertices = snapshot->vertices;
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = list_get(scene->bodies, i);
+    snapshot->bodies[i] = body;
+    snapshot->body_ids[i] = body_get_id(body);
+    body_save_state(body, &snapshot->states[i], vertices);
+    vertices += polygon_size(body_peek_shape(body));
+  }
+  return snapshot;
+}
+
+bool scene_restore(scene_t *scene, scene_snapshot_t *snapshot) {
+  // Removing bodies keeps the others in order and new bodies are appended,
+  // so the saved bodies are all still there only if they are a prefix
+  size_t num_bodies = list_size(scene->bodies);
+  if (num_bodies < snapshot->num_bodies) {
+    return false;
+  }
+  for (size_t i = 0; i < snapshot->num_bodies; i++) {
+    body_t *body = list_get(scene->bodies, i);
+    if (body != snapshot->bodies[i] ||
+        body_get_id(body) != snapshot->body_ids[i]) {
+      return false;
+    }
+  }
+
+  vector_t *vertices = snapshot->vertices;
+  for (size_t i = 0; i < snapshot->num_bodies; i++) {
+    body_t *body = snapshot->bodies[i];
+    body_restore_state(body, &snapshot->states[i], vertices);
+    vertices += polygon_size(body_peek_shape(body));
+  }
+  for (size_t i = snapshot->num_bodies; i < num_bodies; i++) {
+    body_remove(list_get(scene->bodies, i));
+  }
+  scene->accumulator = snapshot->accumulator;
+  scene->broad_phase_dirty = true;
+  return true;
+}
+
+void scene_snapshot_free(scene_snapshot_t *snapshot) {
+  free(snapshot->bodies);
+  free(snapshot->body_ids);
+  free(snapshot->states);
+  free(snapshot->vertices);
+  free(snapshot);
+}
@@ -4,17 +4,123 @@
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 
 const char WINDOW_TITLE[] = "CS 3";
 const int WINDOW_WIDTH = 1024;
 const int WINDOW_HEIGHT = 704;
 const double MS_PER_S = 1e3;
+const size_t FRAME_STATS_WINDOW = 1024;
 
 SDL_Texture *texture = NULL;
 
 Mix_Music *background_music = NULL;
 
+/** A decoded sound effect and the path it was loaded from */
+typedef struct sound_entry {
+  char *path;
+  Mix_Chunk *chunk;
+} sound_entry_t;
+
+void sound_entry_free(sound_entry_t *entry) {
+  Mix_FreeChunk(entry->chunk);
+  free(entry->path);
+  free(entry);
+}
+
+// The printable ASCII characters, which are the ones cached in glyph atlases
+#define FIRST_GLYPH ' '
+#define LAST_GLYPH '~'
+#define NUM_GLYPHS (LAST_GLYPH - FIRST_GLYPH + 1)
+const int GLYPH_ATLAS_COLUMNS = 16;
+
+typedef struct font {
+  char *path;
+  size_t size;
+  TTF_Font *ttf_font;
+  // Built the first time the font draws a label
+  SDL_Texture *atlas;
+  int atlas_width;
+  int atlas_height;
+  SDL_Rect glyphs[NUM_GLYPHS];
+  int advances[NUM_GLYPHS];
+  int height;
+} font_t;
+
+void font_free(font_t *font) {
+  if (font->atlas) {
+    SDL_DestroyTexture(font->atlas);
+  }
+  TTF_CloseFont(font->ttf_font);
+  free(font->path);
+  free(font);
+}
+
+// Sprites are packed into rows of an atlas this wide
+const int IMAGE_ATLAS_WIDTH = 1024;
+// Images larger than this on either side get their own texture
+const int MAX_ATLAS_SPRITE_SIZE = 256;
+
+/** A texture shared by several packed images */
+typedef struct texture_atlas {
+  SDL_Texture *texture;
+  size_t num_images;
+} texture_atlas_t;
+
+typedef struct image {
+  char *path;
+  SDL_Texture *texture;
+  // The part of the texture holding this image
+  SDL_Rect src;
+  int texture_width;
+  int texture_height;
+  // The atlas the texture belongs to, or NULL if the image has its own
+  texture_atlas_t *atlas;
+  size_t refcount;
+} image_t;
+
+void image_destroy(image_t *image) {
+  if (image->atlas) {
+    image->atlas->num_images--;
+    if (image->atlas->num_images == 0) {
+      SDL_DestroyTexture(image->atlas->texture);
+      free(image->atlas);
+    }
+  } else {
+    SDL_DestroyTexture(image->texture);
+  }
+  free(image->path);
+  free(image);
+}
+
+/**
+ * Every image loaded so far, including those no longer referenced,
+ * so reloading a level finds its images already decoded.
+ * NULL until the first image is loaded.
+ */
+list_t *image_cache = NULL;
+
+/**
+ * Every font opened so far, so each file and size is only opened once.
+ * NULL until the first font is opened.
+ */
+list_t *font_cache = NULL;
+
+/**
+ * Every sound effect decoded so far, so each file is only read once.
+ * NULL until the first sound is loaded.
+ */
+list_t *sound_bank = NULL;
+/**
+ * Whether the mixer has been opened. It only needs to be opened once.
+ */
+bool audio_is_open = false;
+/**
+ * Whether sdl_disable_audio() was called, or opening the mixer failed.
+ * Sounds are then skipped instead of being loaded.
+ */
+bool audio_is_disabled = false;
+
 TTF_Font *font = NULL;
 
 /**
@@ -43,20 +149,23 @@ key_handler_t key_handler = NULL;
  */
 uint32_t key_start_timestamp;
 /**
- * The value of clock() when time_since_last_tick() was last called.
- * Initially 0.
+ * The value of SDL_GetPerformanceCounter() when time_since_last_tick()
+ * was last called. Initially 0.
+ * Unlike clock(), which counts CPU time, this keeps counting
+ * while the process waits on vsync or is descheduled.
  */
-clock_t last_clock = 0;
+uint64_t last_counter = 0;
+/**
+ * The times between recent calls to time_since_last_tick(),
+ * or NULL until it is first called.
+ */
+frame_stats_t *frame_stats = NULL;
 
 /** Computes the center of the window in pixel coordinates */
 vector_t get_window_center(void) {
-  int *width = malloc(sizeof(*width)), *height = malloc(sizeof(*height));
-  assert(width != NULL);
-  assert(height != NULL);
-  SDL_GetWindowSize(window, width, height);
-  vector_t dimensions = {.x = *width, .y = *height};
-  free(width);
-  free(height);
+  int width, height;
+  SDL_GetWindowSize(window, &width, &height);
+  vector_t dimensions = {.x = width, .y = height};
   return vec_multiply(0.5, dimensions);
 }
 
@@ -85,6 +194,28 @@ vector_t get_window_position(vector_t scene_pos, vector_t window_center) {
   return pixel;
 }
 
+/**
+ * The mapping from scene coordinates to window coordinates for one frame,
+ * so the window size is only looked up once per frame.
+ */
+typedef struct view_transform {
+  vector_t window_center;
+  double scale;
+} view_transform_t;
+
+view_transform_t get_view_transform(void) {
+  vector_t window_center = get_window_center();
+  return (view_transform_t){window_center, get_scene_scale(window_center)};
+}
+
+/** Like get_window_position(), but without rounding to whole pixels */
+SDL_FPoint view_transform_apply(view_transform_t *view, vector_t scene_pos) {
+  return (SDL_FPoint){
+      view->window_center.x + view->scale * (scene_pos.x - center.x),
+      // Flip y axis since positive y is down on the screen
+      view->window_center.y - view->scale * (scene_pos.y - center.y)};
+}
+
 /**
  * Converts an SDL key code to a char.
  * 7-bit ASCII characters are just returned
@@ -158,6 +289,7 @@ void sdl_init(vector_t min, vector_t max) {
                             SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT,
                             SDL_WINDOW_RESIZABLE);
   renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
+  render_set_backend(sdl_get_backend());
 }
 
 bool sdl_is_done(state_t *state) {
@@ -193,14 +325,168 @@ bool sdl_is_done(state_t *state) {
   return false;
 }
 
+SDL_Color to_sdl_color(rgb_color_t color) {
+  assert(0 <= color.r && color.r <= 1);
+  assert(0 <= color.g && color.g <= 1);
+  assert(0 <= color.b && color.b <= 1);
+  return (SDL_Color){color.r * 255, color.g * 255, color.b * 255, 255};
+}
+
+/**
+ * Triangles waiting to be drawn, all with the same texture (or none).
+ * The buffers are kept between frames, so drawing doesn't allocate
+ * once they have grown to fit a frame.
+ */
+typedef struct render_batch {
+  SDL_Texture *texture;
+  SDL_Vertex *vertices;
+  size_t num_vertices;
+  size_t vertices_capacity;
+  int *indices;
+  size_t num_indices;
+  size_t indices_capacity;
+} render_batch_t;
+
+render_batch_t batch = {0};
+
+/** Submits the pending triangles in one SDL_RenderGeometry() call */
+void batch_flush(void) {
+  if (batch.num_indices > 0) {
+    SDL_RenderGeometry(renderer, batch.texture, batch.vertices,
+                       batch.num_vertices, batch.indices, batch.num_indices);
+  }
+  batch.num_vertices = 0;
+  batch.num_indices = 0;
+}
+
+/**
+ * Prepares the batch for triangles with a given texture.
+ * Draw order is kept by flushing whenever the texture changes,
+ * so sharing textures (e.g. through atlases) makes batches longer.
+ */
+void batch_use_texture(SDL_Texture *texture) {
+  if (texture != batch.texture) {
+    batch_flush();
+    batch.texture = texture;
+  }
+}
+
+void batch_reserve(size_t num_vertices, size_t num_indices) {
+  if (batch.num_vertices + num_vertices > batch.vertices_capacity) {
+    size_t capacity = batch.vertices_capacity ? batch.vertices_capacity : 256;
+    while (batch.num_vertices + num_vertices > capacity) {
+      capacity *= 2;
+    }
+    batch.vertices = realloc(batch.vertices, capacity * sizeof(SDL_Vertex));
+    assert(batch.vertices);
+    batch.vertices_capacity = capacity;
+  }
+  if (batch.num_indices + num_indices > batch.indices_capacity) {
+    size_t capacity = batch.indices_capacity ? batch.indices_capacity : 512;
+    while (batch.num_indices + num_indices > capacity) {
+      capacity *= 2;
+    }
+    batch.indices = realloc(batch.indices, capacity * sizeof(int));
+    assert(batch.indices);
+    batch.indices_capacity = capacity;
+  }
+}
+
+/**
+ * Adds a filled polygon to the batch as a fan of triangles around
+ * the polygon's own centroid (not its body's, which rotating a body
+ * around another point leaves behind).
+ * This is exact for convex polygons, and also for shapes like stars
+ * that are visible in full from their centroid.
+ *
+ * @param shape the polygon to draw
+ * @param color the fill color
+ * @param offset a translation to apply to the polygon, in scene coordinates
+ * @param view the scene-to-window mapping for this frame
+ */
+void batch_add_polygon(polygon_t *shape, rgb_color_t color, vector_t offset,
+                       view_transform_t *view) {
+  // Cached in the polygon, so this doesn't walk the vertices
+  vector_t fan_center = polygon_centroid_packed(shape);
+  size_t n = polygon_size(shape);
+  assert(n >= 3);
+  batch_use_texture(NULL);
+  batch_reserve(n + 1, 3 * n);
+  SDL_Color vertex_color = to_sdl_color(color);
+  SDL_Vertex *vertices = &batch.vertices[batch.num_vertices];
+  int *indices = &batch.indices[batch.num_indices];
+  int base = batch.num_vertices;
+
+  vertices[0] = (SDL_Vertex){
+      view_transform_apply(view, vec_add(fan_center, offset)), vertex_color,
+      {0, 0}};
+  vector_t *points = polygon_vertices(shape);
+  for (size_t i = 0; i < n; i++) {
+    vertices[i + 1] = (SDL_Vertex){
+        view_transform_apply(view, vec_add(points[i], offset)), vertex_color,
+        {0, 0}};
+    indices[3 * i] = base;
+    indices[3 * i + 1] = base + 1 + i;
+    indices[3 * i + 2] = base + 1 + (i + 1) % n;
+  }
+  batch.num_vertices += n + 1;
+  batch.num_indices += 3 * n;
+}
+
+/**
+ * Adds a textured rectangle to the batch.
+ *
+ * @param texture the texture to copy from
+ * @param src the part of the texture to copy, in texels
+ * @param texture_width the width of the whole texture
+ * @param texture_height the height of the whole texture
+ * @param dest the rectangle on screen to fill
+ * @param color a color to multiply the texture by; white leaves it unchanged
+ */
+void batch_add_quad(SDL_Texture *texture, SDL_Rect *src, int texture_width,
+                    int texture_height, SDL_Rect *dest, SDL_Color color) {
+  batch_use_texture(texture);
+  batch_reserve(4, 6);
+  float u0 = (float)src->x / texture_width;
+  float v0 = (float)src->y / texture_height;
+  float u1 = (float)(src->x + src->w) / texture_width;
+  float v1 = (float)(src->y + src->h) / texture_height;
+  float x0 = dest->x, y0 = dest->y;
+  float x1 = dest->x + dest->w, y1 = dest->y + dest->h;
+  SDL_Vertex *vertices = &batch.vertices[batch.num_vertices];
+  vertices[0] = (SDL_Vertex){{x0, y0}, color, {u0, v0}};
+  vertices[1] = (SDL_Vertex){{x1, y0}, color, {u1, v0}};
+  vertices[2] = (SDL_Vertex){{x1, y1}, color, {u1, v1}};
+  vertices[3] = (SDL_Vertex){{x0, y1}, color, {u0, v1}};
+  int base = batch.num_vertices;
+  int quad_indices[6] = {0, 1, 2, 0, 2, 3};
+  for (int i = 0; i < 6; i++) {
+    batch.indices[batch.num_indices + i] = base + quad_indices[i];
+  }
+  batch.num_vertices += 4;
+  batch.num_indices += 6;
+}
+
+const SDL_Color WHITE = {255, 255, 255, 255};
+
 void sdl_clear(void) {
+  // Anything batched before the clear would be hidden by it anyway
+  batch.num_vertices = 0;
+  batch.num_indices = 0;
   SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
   SDL_RenderClear(renderer);
 }
 
-void sdl_draw_polygon(list_t *points, rgb_color_t color) {
+/**
+ * Draws a polygon shifted by an offset in scene coordinates,
+ * so that interpolated bodies can be drawn without moving their shapes.
+ */
+void draw_polygon_offset(polygon_t *points, rgb_color_t color,
+                         vector_t offset) {
+  // Keep anything batched earlier underneath this polygon
+  batch_flush();
   // Check parameters
-  size_t n = list_size(points);
+  size_t n = polygon_size(points);
   assert(n >= 3);
   assert(0 <= color.r && color.r <= 1);
   assert(0 <= color.g && color.g <= 1);
@@ -213,9 +499,10 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
           *y_points = malloc(sizeof(*y_points) * n);
   assert(x_points != NULL);
   assert(y_points != NULL);
+  vector_t *vertices = polygon_vertices(points);
   for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
+    vector_t pixel =
+        get_window_position(vec_add(vertices[i], offset), window_center);
     x_points[i] = pixel.x;
     y_points[i] = pixel.y;
   }
@@ -227,7 +514,12 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
   free(y_points);
 }
 
+void sdl_draw_polygon(polygon_t *points, rgb_color_t color) {
+  draw_polygon_offset(points, color, VEC_ZERO);
+}
+
 void sdl_show(void) {
+  batch_flush();
   // Draw boundary lines
   vector_t window_center = get_window_center();
   vector_t max = vec_add(center, max_diff),
@@ -246,72 +538,100 @@ void sdl_show(void) {
   SDL_RenderPresent(renderer);
 }
 
-SDL_Rect *get_dest_rect(list_t *shape) {
-  vector_t window_center = get_window_center();
-  SDL_Rect *rect = malloc(sizeof(SDL_Rect));
-  vector_t *p = list_get(shape, 0);
-  vector_t xy = {p->x, p->y};
-  vector_t wh = {p->x, p->y};
-  for (size_t i = 1; i < list_size(shape); i++) {
-    p = list_get(shape, i);
-    if (p->x < xy.x) {
-      xy.x = p->x;
-    }
-    if (p->y > xy.y) {
-      xy.y = p->y;
-    }
-    if (p->x > wh.x) {
-      wh.x = p->x;
-    }
-    if (p->y < wh.y) {
-      wh.y = p->y;
-    }
-  }
-  xy = get_window_position(xy, window_center);
-  wh = get_window_position(wh, window_center);
-  rect->x = xy.x;
-  rect->y = xy.y;
-  rect->w = wh.x - xy.x;
-  rect->h = wh.y - xy.y;
+/** Finds the window rectangle covering a box in scene coordinates */
+SDL_Rect get_dest_rect(aabb_t bounds, view_transform_t *view) {
+  // The top left corner on screen is the box's min x and max y
+  SDL_FPoint top_left =
+      view_transform_apply(view, (vector_t){bounds.min.x, bounds.max.y});
+  SDL_FPoint bottom_right =
+      view_transform_apply(view, (vector_t){bounds.max.x, bounds.min.y});
+  SDL_Rect rect = {round(top_left.x), round(top_left.y), 0, 0};
+  rect.w = round(bottom_right.x) - rect.x;
+  rect.h = round(bottom_right.y) - rect.y;
   return rect;
 }
 
 void sdl_render_scene(scene_t *scene) {
   sdl_clear();
   size_t body_count = scene_bodies(scene);
-  // for (size_t i = 0; i < body_count; i++) {
-  //   body_t *body = scene_get_body(scene, i);
-  //   list_t *shape = body_get_shape(body);
-  //   sdl_draw_polygon(shape, body_get_color(body));
-  //   list_free(shape);
-  // }
+  // With a fixed timestep, draw each body between its last two positions
+  double alpha = scene_get_interpolation_alpha(scene);
+  view_transform_t view = get_view_transform();
 
+  // Every body is transformed into the shared vertex buffer,
+  // which is submitted once per run of bodies using the same texture
   for (size_t i = 0; i < body_count; i++) {
     body_t *body = scene_get_body(scene, i);
-    list_t *shape = body_get_shape(body);
-    SDL_Texture *image = (SDL_Texture *)body_get_image(body);
+    image_t *image = body_get_image(body);
     SDL_Texture *text = (SDL_Texture *)body_get_text(body);
-    SDL_Rect *dest_rect = get_dest_rect(shape);
+    vector_t offset = render_interpolation_offset(body, alpha);
+    SDL_Rect dest_rect =
+        get_dest_rect(aabb_translate(body_get_bounds(body), offset), &view);
     if (image != NULL) {
-      SDL_RenderCopy(renderer, image, NULL, dest_rect);
+      sdl_draw_image(image, &dest_rect);
     } else if (body_get_is_visible(body)) {
-      sdl_draw_polygon(shape, body_get_color(body));
+      batch_add_polygon(body_peek_shape(body), body_get_color(body), offset,
+                        &view);
     }
-    if (text != NULL) {
+    const char *label = body_get_label(body);
+    if (text != NULL || label != NULL) {
       double shift_factor = 0.25;
       double scale_factor = 0.5;
-      dest_rect->x = dest_rect->x + shift_factor * dest_rect->w;
-      dest_rect->y = dest_rect->y + shift_factor * dest_rect->h;
-      dest_rect->w = dest_rect->w * scale_factor;
-      dest_rect->h = dest_rect->h * scale_factor;
-      SDL_RenderCopy(renderer, text, NULL, dest_rect);
+      dest_rect.x = dest_rect.x + shift_factor * dest_rect.w;
+      dest_rect.y = dest_rect.y + shift_factor * dest_rect.h;
+      dest_rect.w = dest_rect.w * scale_factor;
+      dest_rect.h = dest_rect.h * scale_factor;
+    }
+    if (text != NULL) {
+      int text_width, text_height;
+      SDL_QueryTexture(text, NULL, NULL, &text_width, &text_height);
+      SDL_Rect src = {0, 0, text_width, text_height};
+      batch_add_quad(text, &src, text_width, text_height, &dest_rect, WHITE);
+    }
+    if (label != NULL) {
+      sdl_draw_text(body_get_label_font(body), label,
+                    body_get_label_color(body), &dest_rect);
     }
-    list_free(shape);
-    free(dest_rect);
   }
   sdl_show();
 }
 
+image_t *sdl_backend_acquire_image(void *aux, const char *image_filename) {
+  return sdl_acquire_image(image_filename);
+}
+
+void sdl_backend_retain_image(void *aux, image_t *image) {
+  sdl_retain_image(image);
+}
+
+void sdl_backend_release_image(void *aux, image_t *image) {
+  sdl_release_image(image);
+}
+
+void sdl_backend_render_scene(void *aux, scene_t *scene) {
+  sdl_render_scene(scene);
+}
+
+void sdl_backend_play_sound(void *aux, const char *sound_filename) {
+  sdl_play_sound(sound_filename);
+}
+
+void sdl_backend_preload_sound(void *aux, const char *sound_filename) {
+  sdl_preload_sound(sound_filename);
+}
+
+/** The window and renderer are globals, so the backend needs no aux */
+render_backend_t sdl_backend = {.acquire_image = sdl_backend_acquire_image,
+                                .retain_image = sdl_backend_retain_image,
+                                .release_image = sdl_backend_release_image,
+                                .render_scene = sdl_backend_render_scene,
+                                .play_sound = sdl_backend_play_sound,
+                                .preload_sound = sdl_backend_preload_sound,
+                                .aux = NULL,
+                                .aux_freer = NULL};
+
+render_backend_t *sdl_get_backend(void) { return &sdl_backend; }
+
 void sdl_on_key(key_handler_t handler) { key_handler = handler; }
 
 vector_t sdl_get_mouse_pos() {
@@ -334,6 +654,290 @@ SDL_Texture *sdl_load_image(const char *image_filename) {
   return img_texture;
 }
 
+image_t *find_cached_image(const char *image_filename) {
+  if (!image_cache) {
+    image_cache = list_init(8, (free_func_t)image_destroy);
+  }
+  for (size_t i = 0; i < list_size(image_cache); i++) {
+    image_t *image = list_get(image_cache, i);
+    if (strcmp(image->path, image_filename) == 0) {
+      return image;
+    }
+  }
+  return NULL;
+}
+
+/** Adds an unreferenced image to the cache */
+image_t *add_cached_image(const char *image_filename, SDL_Texture *texture,
+                          int texture_width, int texture_height, SDL_Rect src,
+                          texture_atlas_t *atlas) {
+  image_t *image = malloc(sizeof(image_t));
+  assert(image);
+  image->path = strdup(image_filename);
+  assert(image->path);
+  image->texture = texture;
+  image->src = src;
+  image->texture_width = texture_width;
+  image->texture_height = texture_height;
+  image->atlas = atlas;
+  image->refcount = 0;
+  list_add(image_cache, image);
+  return image;
+}
+
+image_t *sdl_acquire_image(const char *image_filename) {
+  image_t *image = find_cached_image(image_filename);
+  if (!image) {
+    SDL_Surface *surface = IMG_Load(image_filename);
+    if (!surface) {
+      printf("Unable to load image %s! SDL Error: %s\n", image_filename,
+             SDL_GetError());
+      return NULL;
+    }
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_Rect src = {0, 0, surface->w, surface->h};
+    SDL_FreeSurface(surface);
+    assert(texture);
+    image = add_cached_image(image_filename, texture, src.w, src.h, src, NULL);
+  }
+  image->refcount++;
+  return image;
+}
+
+image_t *sdl_retain_image(image_t *image) {
+  image->refcount++;
+  return image;
+}
+
+void sdl_release_image(image_t *image) {
+  assert(image->refcount > 0);
+  image->refcount--;
+}
+
+bool image_is_unused(void *image, void *aux) {
+  return ((image_t *)image)->refcount == 0;
+}
+
+void sdl_trim_images(void) {
+  if (image_cache) {
+    list_compact(image_cache, image_is_unused, NULL);
+  }
+}
+
+void sdl_free_images(void) {
+  if (image_cache) {
+    list_free(image_cache);
+    image_cache = NULL;
+  }
+}
+
+void sdl_pack_images(const char *image_filenames[], size_t num_images) {
+  SDL_Surface **surfaces = malloc(num_images * sizeof(SDL_Surface *));
+  const char **paths = malloc(num_images * sizeof(char *));
+  assert(surfaces && paths);
+  size_t num_packed = 0;
+  for (size_t i = 0; i < num_images; i++) {
+    if (find_cached_image(image_filenames[i])) {
+      continue;
+    }
+    SDL_Surface *surface = IMG_Load(image_filenames[i]);
+    if (!surface) {
+      printf("Unable to load image %s! SDL Error: %s\n", image_filenames[i],
+             SDL_GetError());
+      continue;
+    }
+    if (surface->w > MAX_ATLAS_SPRITE_SIZE ||
+        surface->h > MAX_ATLAS_SPRITE_SIZE) {
+      // Too big to share well; it is loaded on its own when first used
+      SDL_FreeSurface(surface);
+      continue;
+    }
+    surfaces[num_packed] = surface;
+    paths[num_packed] = image_filenames[i];
+    num_packed++;
+  }
+  if (num_packed == 0) {
+    free(surfaces);
+    free(paths);
+    return;
+  }
+
+  // Shelf packing: tallest first, filling rows left to right.
+  // The insertion sort keeps images of equal height in the order given.
+  size_t *order = malloc(num_packed * sizeof(size_t));
+  SDL_Rect *placements = malloc(num_packed * sizeof(SDL_Rect));
+  assert(order && placements);
+  for (size_t i = 0; i < num_packed; i++) {
+    order[i] = i;
+  }
+  for (size_t i = 1; i < num_packed; i++) {
+    size_t current = order[i];
+    size_t j = i;
+    while (j > 0 && surfaces[order[j - 1]]->h < surfaces[current]->h) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = current;
+  }
+  int x = 0, y = 0, row_height = 0;
+  for (size_t i = 0; i < num_packed; i++) {
+    SDL_Surface *surface = surfaces[order[i]];
+    if (x + surface->w > IMAGE_ATLAS_WIDTH) {
+      x = 0;
+      y += row_height + 1;
+      row_height = 0;
+    }
+    placements[order[i]] = (SDL_Rect){x, y, surface->w, surface->h};
+    // Leave a pixel between sprites so filtering doesn't bleed across them
+    x += surface->w + 1;
+    if (surface->h > row_height) {
+      row_height = surface->h;
+    }
+  }
+
+  int atlas_height = y + row_height;
+  SDL_Surface *atlas_surface = SDL_CreateRGBSurfaceWithFormat(
+      0, IMAGE_ATLAS_WIDTH, atlas_height, 32, SDL_PIXELFORMAT_RGBA32);
+  assert(atlas_surface);
+  for (size_t i = 0; i < num_packed; i++) {
+    SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+    SDL_BlitSurface(surfaces[i], NULL, atlas_surface, &placements[i]);
+  }
+  texture_atlas_t *atlas = malloc(sizeof(texture_atlas_t));
+  assert(atlas);
+  atlas->texture = SDL_CreateTextureFromSurface(renderer, atlas_surface);
+  assert(atlas->texture);
+  atlas->num_images = num_packed;
+  SDL_FreeSurface(atlas_surface);
+  for (size_t i = 0; i < num_packed; i++) {
+    add_cached_image(paths[i], atlas->texture, IMAGE_ATLAS_WIDTH, atlas_height,
+                     placements[i], atlas);
+    SDL_FreeSurface(surfaces[i]);
+  }
+  free(placements);
+  free(order);
+  free(paths);
+  free(surfaces);
+}
+
+void sdl_draw_image(image_t *image, SDL_Rect *dest_rect) {
+  batch_add_quad(image->texture, &image->src, image->texture_width,
+                 image->texture_height, dest_rect, WHITE);
+}
+
+font_t *sdl_get_font(const char *font_filename, size_t font_size) {
+  if (!font_cache) {
+    font_cache = list_init(2, (free_func_t)font_free);
+  }
+  for (size_t i = 0; i < list_size(font_cache); i++) {
+    font_t *font = list_get(font_cache, i);
+    if (font->size == font_size && strcmp(font->path, font_filename) == 0) {
+      return font;
+    }
+  }
+
+  TTF_Font *ttf_font = TTF_OpenFont(font_filename, font_size);
+  if (!ttf_font) {
+    printf("Unable to open font! SDL_ttf Error: %s\n", TTF_GetError());
+    return NULL;
+  }
+  font_t *font = calloc(1, sizeof(font_t));
+  assert(font);
+  font->path = strdup(font_filename);
+  assert(font->path);
+  font->size = font_size;
+  font->ttf_font = ttf_font;
+  list_add(font_cache, font);
+  return font;
+}
+
+/**
+ * Rasterizes every printable ASCII glyph of a font into one texture,
+ * laid out in a grid of equal cells.
+ * The glyphs are white so that the vertex color can tint them when drawing.
+ */
+void build_glyph_atlas(font_t *font) {
+  SDL_Color white = {255, 255, 255, 255};
+  SDL_Surface *glyph_surfaces[NUM_GLYPHS];
+  int cell_width = 1;
+  int cell_height = TTF_FontHeight(font->ttf_font);
+  for (int i = 0; i < NUM_GLYPHS; i++) {
+    Uint16 glyph = FIRST_GLYPH + i;
+    glyph_surfaces[i] = TTF_RenderGlyph_Blended(font->ttf_font, glyph, white);
+    int advance = 0;
+    if (TTF_GlyphMetrics(font->ttf_font, glyph, NULL, NULL, NULL, NULL,
+                         &advance) < 0 &&
+        glyph_surfaces[i]) {
+      advance = glyph_surfaces[i]->w;
+    }
+    font->advances[i] = advance;
+    if (glyph_surfaces[i]) {
+      cell_width = fmax(cell_width, glyph_surfaces[i]->w);
+      cell_height = fmax(cell_height, glyph_surfaces[i]->h);
+    }
+  }
+  font->height = cell_height;
+
+  int rows = (NUM_GLYPHS + GLYPH_ATLAS_COLUMNS - 1) / GLYPH_ATLAS_COLUMNS;
+  font->atlas_width = GLYPH_ATLAS_COLUMNS * cell_width;
+  font->atlas_height = rows * cell_height;
+  SDL_Surface *atlas_surface =
+      SDL_CreateRGBSurfaceWithFormat(0, font->atlas_width, font->atlas_height,
+                                     32, SDL_PIXELFORMAT_RGBA32);
+  assert(atlas_surface);
+  for (int i = 0; i < NUM_GLYPHS; i++) {
+    SDL_Rect cell = {(i % GLYPH_ATLAS_COLUMNS) * cell_width,
+                     (i / GLYPH_ATLAS_COLUMNS) * cell_height, 0, 0};
+    if (glyph_surfaces[i]) {
+      cell.w = glyph_surfaces[i]->w;
+      cell.h = glyph_surfaces[i]->h;
+      // Copy the glyph's alpha instead of blending it onto the empty atlas
+      SDL_SetSurfaceBlendMode(glyph_surfaces[i], SDL_BLENDMODE_NONE);
+      SDL_BlitSurface(glyph_surfaces[i], NULL, atlas_surface, &cell);
+      SDL_FreeSurface(glyph_surfaces[i]);
+    }
+    font->glyphs[i] = cell;
+  }
+  font->atlas = SDL_CreateTextureFromSurface(renderer, atlas_surface);
+  SDL_FreeSurface(atlas_surface);
+  assert(font->atlas);
+  SDL_SetTextureBlendMode(font->atlas, SDL_BLENDMODE_BLEND);
+}
+
+void sdl_draw_text(font_t *font, const char *text, rgb_color_t color,
+                   SDL_Rect *dest_rect) {
+  if (!font->atlas) {
+    build_glyph_atlas(font);
+  }
+  int width = 0;
+  for (const char *c = text; *c; c++) {
+    if (FIRST_GLYPH <= *c && *c <= LAST_GLYPH) {
+      width += font->advances[*c - FIRST_GLYPH];
+    }
+  }
+  if (width == 0) {
+    return;
+  }
+
+  // Stretch the line of text to fill the rectangle
+  double x_scale = (double)dest_rect->w / width;
+  double y_scale = (double)dest_rect->h / font->height;
+  SDL_Color tint = to_sdl_color(color);
+  int pen = 0;
+  for (const char *c = text; *c; c++) {
+    if (*c < FIRST_GLYPH || *c > LAST_GLYPH) {
+      continue;
+    }
+    int index = *c - FIRST_GLYPH;
+    SDL_Rect *glyph = &font->glyphs[index];
+    SDL_Rect glyph_dest = {dest_rect->x + pen * x_scale, dest_rect->y,
+                           ceil(glyph->w * x_scale), glyph->h * y_scale};
+    batch_add_quad(font->atlas, glyph, font->atlas_width, font->atlas_height,
+                   &glyph_dest, tint);
+    pen += font->advances[index];
+  }
+}
+
 SDL_Texture *sdl_load_text(char *text, rgb_color_t text_color,
                            const char *font_filename, size_t font_size) {
   // Convert rgb_color_t to SDL_Color
@@ -343,13 +947,12 @@ SDL_Texture *sdl_load_text(char *text, rgb_color_t text_color,
   SDL_Texture *texture = NULL;
 
   // Render text surface
-  TTF_Font *font = TTF_OpenFont(font_filename, font_size);
-  // TTF_Font *font = TTF_OpenFont("assets/fonts/Arial.ttf", 25);
+  font_t *font = sdl_get_font(font_filename, font_size);
   if (!font) {
-    printf("Unable to render font! SDL_ttf Error: %s\n", TTF_GetError());
+    return NULL;
   }
 
-  SDL_Surface *text_surface = TTF_RenderText_Solid(font, text, color);
+  SDL_Surface *text_surface = TTF_RenderText_Solid(font->ttf_font, text, color);
   if (!text_surface) {
     printf("Unable to render text surface! SDL_ttf Error: %s\n",
            TTF_GetError());
@@ -365,35 +968,91 @@ SDL_Texture *sdl_load_text(char *text, rgb_color_t text_color,
     SDL_FreeSurface(text_surface);
   }
 
-  // Return success
-  TTF_CloseFont(font);
   return texture;
 }
 
-Mix_Chunk *sdl_load_sound(const char *sound_filename) {
+void sdl_free_fonts(void) {
+  if (!font_cache) {
+    return;
+  }
+  list_free(font_cache);
+  font_cache = NULL;
+}
+
+/** Opens the mixer the first time a sound or music is needed */
+void sdl_open_audio(void) {
+  if (audio_is_open || audio_is_disabled) {
+    return;
+  }
   // Checking to make sure mixer was initialized
   if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
     printf("SDL_mixer could not initialize! SDL_mixer Error: %s\n",
            Mix_GetError());
+    audio_is_disabled = true;
+    return;
   }
+  audio_is_open = true;
+}
+
+void sdl_disable_audio(void) { audio_is_disabled = true; }
 
+/**
+ * Gets the decoded sound effect for a file,
+ * decoding it and adding it to the sound bank if it isn't there yet.
+ * Returns NULL if audio is disabled.
+ */
+Mix_Chunk *sdl_load_sound(const char *sound_filename) {
+  if (!sound_bank) {
+    sound_bank = list_init(4, (free_func_t)sound_entry_free);
+  }
+  for (size_t i = 0; i < list_size(sound_bank); i++) {
+    sound_entry_t *entry = list_get(sound_bank, i);
+    if (strcmp(entry->path, sound_filename) == 0) {
+      return entry->chunk;
+    }
+  }
+
+  sdl_open_audio();
+  if (!audio_is_open) {
+    return NULL;
+  }
   Mix_Chunk *sound = Mix_LoadWAV(sound_filename);
   assert(sound);
+  sound_entry_t *entry = malloc(sizeof(sound_entry_t));
+  assert(entry);
+  entry->path = strdup(sound_filename);
+  assert(entry->path);
+  entry->chunk = sound;
+  list_add(sound_bank, entry);
   return sound;
 }
 
+void sdl_preload_sound(const char *sound_filename) {
+  sdl_load_sound(sound_filename);
+}
+
 void sdl_play_sound(const char *sound_filename) {
   Mix_Chunk *sound_effect = sdl_load_sound(sound_filename);
-  Mix_PlayChannel(-1, sound_effect, 0);
+  if (sound_effect) {
+    Mix_PlayChannel(-1, sound_effect, 0);
+  }
 }
 
-void sdl_start_background_music(const char *sound_filename) {
-  // Checking to make sure mixer was initialized
-  if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-    printf("SDL_mixer could not initialize! SDL_mixer Error: %s\n",
-           Mix_GetError());
+void sdl_free_sounds(void) {
+  if (!sound_bank) {
+    return;
   }
+  // Chunks must not be freed while a channel is still playing them
+  Mix_HaltChannel(-1);
+  list_free(sound_bank);
+  sound_bank = NULL;
+}
 
+void sdl_start_background_music(const char *sound_filename) {
+  sdl_open_audio();
+  if (!audio_is_open) {
+    return;
+  }
   background_music = Mix_LoadMUS(sound_filename);
   assert(background_music);
   Mix_PlayMusic(background_music, -1);
@@ -404,10 +1063,23 @@ void sdl_pause_background_music() { Mix_PauseMusic(); }
 void sdl_resume_background_music() { Mix_ResumeMusic(); }
 
 double time_since_last_tick(void) {
-  clock_t now = clock();
-  double difference = last_clock
-                          ? (double)(now - last_clock) / CLOCKS_PER_SEC
-                          : 0.0; // return 0 the first time this is called
-  last_clock = now;
+  uint64_t now = SDL_GetPerformanceCounter();
+  if (!last_counter) {
+    // Return 0 the first time this is called
+    last_counter = now;
+    frame_stats = frame_stats_init(FRAME_STATS_WINDOW);
+    return 0.0;
+  }
+  double difference =
+      (double)(now - last_counter) / SDL_GetPerformanceFrequency();
+  last_counter = now;
+  frame_stats_record(frame_stats, difference);
   return difference;
 }
+
+frame_summary_t sdl_get_frame_stats(void) {
+  if (!frame_stats) {
+    return (frame_summary_t){0};
+  }
+  return frame_stats_summarize(frame_stats);
+}
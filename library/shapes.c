@@ -6,40 +6,43 @@ const double TOTAL_CIRCLE_ANGLE = 360;
 
 double deg_to_rad(double deg) { return deg * M_PI / 180; }
 
-list_t *make_rect_shape(double width, double height) {
-  // Initialize the brick shape
-  list_t *shape = list_init(4, free);
-
-  vector_t *v = malloc(sizeof(vector_t));
-  *v = (vector_t){0, 0};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){width, 0};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){width, height};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){0, height};
-  list_add(shape, v);
-
+polygon_t *make_rect_polygon(double width, double height) {
+  polygon_t *shape = polygon_init(4);
+  vector_t *v = polygon_vertices(shape);
+  v[0] = (vector_t){0, 0};
+  v[1] = (vector_t){width, 0};
+  v[2] = (vector_t){width, height};
+  v[3] = (vector_t){0, height};
   return shape;
 }
 
-list_t *make_circ_shape(double radius, size_t num_points) {
-  list_t *shape = list_init(TOTAL_CIRCLE_ANGLE, free);
+polygon_t *make_circ_polygon(double radius, size_t num_points) {
+  polygon_t *shape = polygon_init(num_points);
+  vector_t *v = polygon_vertices(shape);
 
   double curr_angle = 0;
-  double dt = TOTAL_CIRCLE_ANGLE/num_points; // change in angle in each point
+  double dt = TOTAL_CIRCLE_ANGLE / num_points; // change in angle in each point
 
   for (size_t i = 0; i < num_points; i++) {
-    vector_t *new_point = calloc(1, sizeof(vector_t));
-    new_point->x = radius * cos(deg_to_rad(curr_angle));
-    new_point->y = radius * sin(deg_to_rad(curr_angle));
-    list_add(shape, new_point);
+    v[i].x = radius * cos(deg_to_rad(curr_angle));
+    v[i].y = radius * sin(deg_to_rad(curr_angle));
 
     curr_angle += dt;
   }
 
   return shape;
-}
\ No newline at end of file
+}
+
+list_t *make_rect_shape(double width, double height) {
+  polygon_t *polygon = make_rect_polygon(width, height);
+  list_t *shape = polygon_to_list(polygon);
+  polygon_free(polygon);
+  return shape;
+}
+
+list_t *make_circ_shape(double radius, size_t num_points) {
+  polygon_t *polygon = make_circ_polygon(radius, num_points);
+  list_t *shape = polygon_to_list(polygon);
+  polygon_free(polygon);
+  return shape;
+}
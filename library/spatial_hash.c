@@ -0,0 +1,266 @@
+#include "../include/spatial_hash.h"
+#include "../include/body.h"
+#include "../include/list.h"
+#include "../include/polygon.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+const size_t INITIAL_NUM_BUCKETS = 256;
+const size_t INITIAL_NUM_RECORDS = 16;
+// Bodies covering more cells than this are kept out of the grid
+// and tested against everything instead
+const int64_t MAX_CELLS_PER_BODY = 1024;
+
+typedef struct cell_coord {
+  int64_t x;
+  int64_t y;
+} cell_coord_t;
+
+/** A body inserted into the hash, with the cells its box covers */
+typedef struct hashed_body {
+  body_t *body;
+  aabb_t bounds;
+  cell_coord_t min_cell;
+  cell_coord_t max_cell;
+  bool oversized;
+} hashed_body_t;
+
+/** One body's presence in one cell */
+typedef struct cell_entry {
+  cell_coord_t cell;
+  size_t record;
+} cell_entry_t;
+
+/** All the entries whose cells hash to the same slot */
+typedef struct bucket {
+  cell_entry_t *entries;
+  size_t size;
+  size_t capacity;
+} bucket_t;
+
+typedef struct spatial_hash {
+  double cell_size;
+  hashed_body_t *records;
+  size_t num_records;
+  size_t records_capacity;
+  size_t num_oversized;
+  bucket_t *buckets;
+  size_t num_buckets; // always a power of 2
+  size_t num_entries;
+} spatial_hash_t;
+
+spatial_hash_t *spatial_hash_init(double cell_size) {
+  assert(cell_size > 0);
+  spatial_hash_t *hash = calloc(1, sizeof(spatial_hash_t));
+  assert(hash);
+  hash->cell_size = cell_size;
+  hash->records = malloc(INITIAL_NUM_RECORDS * sizeof(hashed_body_t));
+  assert(hash->records);
+  hash->records_capacity = INITIAL_NUM_RECORDS;
+  hash->buckets = calloc(INITIAL_NUM_BUCKETS, sizeof(bucket_t));
+  assert(hash->buckets);
+  hash->num_buckets = INITIAL_NUM_BUCKETS;
+  return hash;
+}
+
+void spatial_hash_free(spatial_hash_t *hash) {
+  for (size_t i = 0; i < hash->num_buckets; i++) {
+    free(hash->buckets[i].entries);
+  }
+  free(hash->buckets);
+  free(hash->records);
+  free(hash);
+}
+
+void spatial_hash_clear(spatial_hash_t *hash) {
+  for (size_t i = 0; i < hash->num_buckets; i++) {
+    hash->buckets[i].size = 0;
+  }
+  hash->num_records = 0;
+  hash->num_oversized = 0;
+  hash->num_entries = 0;
+}
+
+size_t spatial_hash_size(spatial_hash_t *hash) { return hash->num_records; }
+
+cell_coord_t get_cell(spatial_hash_t *hash, vector_t point) {
+  return (cell_coord_t){(int64_t)floor(point.x / hash->cell_size),
+                        (int64_t)floor(point.y / hash->cell_size)};
+}
+
+size_t get_bucket_index(spatial_hash_t *hash, cell_coord_t cell) {
+  uint64_t key = (uint64_t)cell.x * 0x9E3779B97F4A7C15ULL ^
+                 (uint64_t)cell.y * 0xC2B2AE3D27D4EB4FULL;
+  key ^= key >> 29;
+  return key & (hash->num_buckets - 1);
+}
+
+void bucket_add(bucket_t *bucket, cell_entry_t entry) {
+  if (bucket->size == bucket->capacity) {
+    size_t new_capacity = bucket->capacity > 0 ? bucket->capacity * 2 : 4;
+    cell_entry_t *new_entries =
+        realloc(bucket->entries, new_capacity * sizeof(cell_entry_t));
+    assert(new_entries);
+    bucket->entries = new_entries;
+    bucket->capacity = new_capacity;
+  }
+  bucket->entries[bucket->size++] = entry;
+}
+
+/**
+ * Doubles the number of buckets and redistributes the existing entries,
+ * keeping the average bucket short.
+ */
+void spatial_hash_grow(spatial_hash_t *hash) {
+  bucket_t *old_buckets = hash->buckets;
+  size_t old_num_buckets = hash->num_buckets;
+  hash->num_buckets *= 2;
+  hash->buckets = calloc(hash->num_buckets, sizeof(bucket_t));
+  assert(hash->buckets);
+  for (size_t i = 0; i < old_num_buckets; i++) {
+    bucket_t *old = &old_buckets[i];
+    for (size_t j = 0; j < old->size; j++) {
+      cell_entry_t entry = old->entries[j];
+      bucket_add(&hash->buckets[get_bucket_index(hash, entry.cell)], entry);
+    }
+    free(old->entries);
+  }
+  free(old_buckets);
+}
+
+void spatial_hash_insert(spatial_hash_t *hash, body_t *body) {
+  if (hash->num_records == hash->records_capacity) {
+    hash->records_capacity *= 2;
+    hash->records = realloc(hash->records,
+                            hash->records_capacity * sizeof(hashed_body_t));
+    assert(hash->records);
+  }
+  size_t index = hash->num_records++;
+  hashed_body_t *record = &hash->records[index];
+  record->body = body;
+  record->bounds = body_get_bounds(body);
+  record->min_cell = get_cell(hash, record->bounds.min);
+  record->max_cell = get_cell(hash, record->bounds.max);
+
+  int64_t width = record->max_cell.x - record->min_cell.x + 1;
+  int64_t height = record->max_cell.y - record->min_cell.y + 1;
+  record->oversized = width > MAX_CELLS_PER_BODY ||
+                      height > MAX_CELLS_PER_BODY ||
+                      width * height > MAX_CELLS_PER_BODY;
+  if (record->oversized) {
+    hash->num_oversized++;
+    return;
+  }
+
+  for (int64_t x = record->min_cell.x; x <= record->max_cell.x; x++) {
+    for (int64_t y = record->min_cell.y; y <= record->max_cell.y; y++) {
+      cell_coord_t cell = {x, y};
+      cell_entry_t entry = {cell, index};
+      bucket_add(&hash->buckets[get_bucket_index(hash, cell)], entry);
+      hash->num_entries++;
+    }
+  }
+  if (hash->num_entries > 2 * hash->num_buckets) {
+    spatial_hash_grow(hash);
+  }
+}
+
+/**
+ * Two overlapping boxes share a run of cells; this finds the first one,
+ * so that a pair can be reported from exactly one of them.
+ */
+cell_coord_t first_shared_cell(cell_coord_t min1, cell_coord_t min2) {
+  return (cell_coord_t){min1.x > min2.x ? min1.x : min2.x,
+                        min1.y > min2.y ? min1.y : min2.y};
+}
+
+bool cell_equal(cell_coord_t cell1, cell_coord_t cell2) {
+  return cell1.x == cell2.x && cell1.y == cell2.y;
+}
+
+void spatial_hash_query(spatial_hash_t *hash, aabb_t bounds, list_t *results) {
+  cell_coord_t min_cell = get_cell(hash, bounds.min);
+  cell_coord_t max_cell = get_cell(hash, bounds.max);
+  int64_t width = max_cell.x - min_cell.x + 1;
+  int64_t height = max_cell.y - min_cell.y + 1;
+
+  // A huge query is cheaper as a plain scan than as a walk over its cells
+  int64_t num_records = hash->num_records;
+  if (width <= 0 || height <= 0 || width > num_records ||
+      height > num_records || width * height > num_records) {
+    for (size_t i = 0; i < hash->num_records; i++) {
+      if (aabb_overlaps(bounds, hash->records[i].bounds)) {
+        list_add(results, hash->records[i].body);
+      }
+    }
+    return;
+  }
+
+  for (int64_t x = min_cell.x; x <= max_cell.x; x++) {
+    for (int64_t y = min_cell.y; y <= max_cell.y; y++) {
+      cell_coord_t cell = {x, y};
+      bucket_t *bucket = &hash->buckets[get_bucket_index(hash, cell)];
+      for (size_t i = 0; i < bucket->size; i++) {
+        cell_entry_t *entry = &bucket->entries[i];
+        hashed_body_t *record = &hash->records[entry->record];
+        if (cell_equal(entry->cell, cell) &&
+            cell_equal(first_shared_cell(min_cell, record->min_cell), cell) &&
+            aabb_overlaps(bounds, record->bounds)) {
+          list_add(results, record->body);
+        }
+      }
+    }
+  }
+
+  if (hash->num_oversized > 0) {
+    for (size_t i = 0; i < hash->num_records; i++) {
+      hashed_body_t *record = &hash->records[i];
+      if (record->oversized && aabb_overlaps(bounds, record->bounds)) {
+        list_add(results, record->body);
+      }
+    }
+  }
+}
+
+void spatial_hash_for_each_pair(spatial_hash_t *hash,
+                                body_pair_handler_t handler, void *aux) {
+  for (size_t b = 0; b < hash->num_buckets; b++) {
+    bucket_t *bucket = &hash->buckets[b];
+    for (size_t i = 0; i < bucket->size; i++) {
+      cell_entry_t *entry1 = &bucket->entries[i];
+      hashed_body_t *record1 = &hash->records[entry1->record];
+      for (size_t j = i + 1; j < bucket->size; j++) {
+        cell_entry_t *entry2 = &bucket->entries[j];
+        hashed_body_t *record2 = &hash->records[entry2->record];
+        if (cell_equal(entry1->cell, entry2->cell) &&
+            cell_equal(first_shared_cell(record1->min_cell, record2->min_cell),
+                       entry1->cell) &&
+            aabb_overlaps(record1->bounds, record2->bounds)) {
+          handler(record1->body, record2->body, aux);
+        }
+      }
+    }
+  }
+
+  if (hash->num_oversized == 0) {
+    return;
+  }
+  for (size_t i = 0; i < hash->num_records; i++) {
+    hashed_body_t *record1 = &hash->records[i];
+    if (!record1->oversized) {
+      continue;
+    }
+    for (size_t j = 0; j < hash->num_records; j++) {
+      hashed_body_t *record2 = &hash->records[j];
+      // Pairs of two oversized bodies are reported by the lower index only
+      if (j == i || (record2->oversized && j < i)) {
+        continue;
+      }
+      if (aabb_overlaps(record1->bounds, record2->bounds)) {
+        handler(record1->body, record2->body, aux);
+      }
+    }
+  }
+}
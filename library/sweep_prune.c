@@ -0,0 +1,261 @@
+#include "../include/sweep_prune.h"
+#include "../include/body.h"
+#include "../include/list.h"
+#include "../include/polygon.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t INITIAL_NUM_ENDPOINTS = 32;
+const size_t INITIAL_NUM_PAIR_SLOTS = 64;
+
+/** The left or right edge of a body's bounding box */
+typedef struct endpoint {
+  double value;
+  body_t *body;
+  bool is_max;
+} endpoint_t;
+
+/** Two bodies, stored with the lower address first; empty if body1 is NULL */
+typedef struct sap_pair {
+  body_t *body1;
+  body_t *body2;
+} sap_pair_t;
+
+typedef struct sweep_prune {
+  endpoint_t *endpoints;
+  size_t num_endpoints;
+  size_t endpoints_capacity;
+  // Open-addressed hash set of the pairs whose x-extents overlap
+  sap_pair_t *pairs;
+  size_t num_pairs;
+  size_t pairs_capacity; // always a power of 2
+} sweep_prune_t;
+
+sweep_prune_t *sweep_prune_init(void) {
+  sweep_prune_t *sap = calloc(1, sizeof(sweep_prune_t));
+  assert(sap);
+  sap->endpoints = malloc(INITIAL_NUM_ENDPOINTS * sizeof(endpoint_t));
+  assert(sap->endpoints);
+  sap->endpoints_capacity = INITIAL_NUM_ENDPOINTS;
+  sap->pairs = calloc(INITIAL_NUM_PAIR_SLOTS, sizeof(sap_pair_t));
+  assert(sap->pairs);
+  sap->pairs_capacity = INITIAL_NUM_PAIR_SLOTS;
+  return sap;
+}
+
+void sweep_prune_free(sweep_prune_t *sap) {
+  free(sap->endpoints);
+  free(sap->pairs);
+  free(sap);
+}
+
+size_t sweep_prune_size(sweep_prune_t *sap) { return sap->num_endpoints / 2; }
+
+sap_pair_t sap_make_pair(body_t *body1, body_t *body2) {
+  if ((uintptr_t)body1 < (uintptr_t)body2) {
+    return (sap_pair_t){body1, body2};
+  }
+  return (sap_pair_t){body2, body1};
+}
+
+size_t sap_pair_slot(sweep_prune_t *sap, sap_pair_t pair) {
+  uint64_t key = (uint64_t)(uintptr_t)pair.body1 * 0x9E3779B97F4A7C15ULL ^
+                 (uint64_t)(uintptr_t)pair.body2 * 0xC2B2AE3D27D4EB4FULL;
+  key ^= key >> 31;
+  return key & (sap->pairs_capacity - 1);
+}
+
+/**
+ * Finds the slot holding a pair, or the empty slot where it would go.
+ */
+size_t sap_find_pair(sweep_prune_t *sap, sap_pair_t pair) {
+  size_t mask = sap->pairs_capacity - 1;
+  size_t i = sap_pair_slot(sap, pair);
+  while (sap->pairs[i].body1 && (sap->pairs[i].body1 != pair.body1 ||
+                                 sap->pairs[i].body2 != pair.body2)) {
+    i = (i + 1) & mask;
+  }
+  return i;
+}
+
+/**
+ * Moves every pair into a new table, leaving out those involving a body.
+ *
+ * @param sap a pointer to a broad phase returned from sweep_prune_init()
+ * @param capacity the number of slots in the new table; a power of 2
+ * @param except a body whose pairs should be dropped, or NULL
+ * @param drop_marked whether to drop pairs with a body marked for removal
+ */
+void sap_rehash(sweep_prune_t *sap, size_t capacity, body_t *except,
+                bool drop_marked) {
+  sap_pair_t *old_pairs = sap->pairs;
+  size_t old_capacity = sap->pairs_capacity;
+  sap->pairs = calloc(capacity, sizeof(sap_pair_t));
+  assert(sap->pairs);
+  sap->pairs_capacity = capacity;
+  sap->num_pairs = 0;
+  for (size_t i = 0; i < old_capacity; i++) {
+    sap_pair_t pair = old_pairs[i];
+    if (!pair.body1 || pair.body1 == except || pair.body2 == except) {
+      continue;
+    }
+    if (drop_marked &&
+        (body_is_removed(pair.body1) || body_is_removed(pair.body2))) {
+      continue;
+    }
+    sap->pairs[sap_find_pair(sap, pair)] = pair;
+    sap->num_pairs++;
+  }
+  free(old_pairs);
+}
+
+void sap_add_pair(sweep_prune_t *sap, body_t *body1, body_t *body2) {
+  sap_pair_t pair = sap_make_pair(body1, body2);
+  size_t i = sap_find_pair(sap, pair);
+  if (sap->pairs[i].body1) {
+    return;
+  }
+  sap->pairs[i] = pair;
+  sap->num_pairs++;
+  // Keep the table at most half full so probes stay short
+  if (2 * sap->num_pairs > sap->pairs_capacity) {
+    sap_rehash(sap, 2 * sap->pairs_capacity, NULL, false);
+  }
+}
+
+void sap_remove_pair(sweep_prune_t *sap, body_t *body1, body_t *body2) {
+  sap_pair_t pair = sap_make_pair(body1, body2);
+  size_t i = sap_find_pair(sap, pair);
+  if (!sap->pairs[i].body1) {
+    return;
+  }
+  sap->pairs[i] = (sap_pair_t){NULL, NULL};
+  sap->num_pairs--;
+
+  // Shift later entries of the probe run back so lookups still find them
+  size_t mask = sap->pairs_capacity - 1;
+  size_t j = i;
+  while (true) {
+    j = (j + 1) & mask;
+    if (!sap->pairs[j].body1) {
+      break;
+    }
+    size_t home = sap_pair_slot(sap, sap->pairs[j]);
+    bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+    if (!stays) {
+      sap->pairs[i] = sap->pairs[j];
+      sap->pairs[j] = (sap_pair_t){NULL, NULL};
+      i = j;
+    }
+  }
+}
+
+void sap_add_endpoint(sweep_prune_t *sap, endpoint_t endpoint) {
+  if (sap->num_endpoints == sap->endpoints_capacity) {
+    sap->endpoints_capacity *= 2;
+    sap->endpoints = realloc(sap->endpoints,
+                             sap->endpoints_capacity * sizeof(endpoint_t));
+    assert(sap->endpoints);
+  }
+  sap->endpoints[sap->num_endpoints++] = endpoint;
+}
+
+void sweep_prune_add(sweep_prune_t *sap, body_t *body) {
+  // Appended after every other endpoint, the body overlaps nothing yet;
+  // the next update sorts it into place and discovers its pairs
+  aabb_t bounds = body_get_bounds(body);
+  sap_add_endpoint(sap, (endpoint_t){bounds.min.x, body, false});
+  sap_add_endpoint(sap, (endpoint_t){bounds.max.x, body, true});
+}
+
+void sweep_prune_remove(sweep_prune_t *sap, body_t *body) {
+  size_t kept = 0;
+  for (size_t i = 0; i < sap->num_endpoints; i++) {
+    if (sap->endpoints[i].body != body) {
+      sap->endpoints[kept++] = sap->endpoints[i];
+    }
+  }
+  assert(kept + 2 == sap->num_endpoints);
+  sap->num_endpoints = kept;
+  sap_rehash(sap, sap->pairs_capacity, body, false);
+}
+
+void sweep_prune_remove_marked(sweep_prune_t *sap) {
+  size_t kept = 0;
+  for (size_t i = 0; i < sap->num_endpoints; i++) {
+    if (!body_is_removed(sap->endpoints[i].body)) {
+      sap->endpoints[kept++] = sap->endpoints[i];
+    }
+  }
+  if (kept == sap->num_endpoints) {
+    return;
+  }
+  sap->num_endpoints = kept;
+  sap_rehash(sap, sap->pairs_capacity, NULL, true);
+}
+
+/**
+ * Orders endpoints by position; at equal positions, left edges come first
+ * so that boxes which only touch are treated as overlapping.
+ */
+bool endpoint_less(endpoint_t *endpoint1, endpoint_t *endpoint2) {
+  return endpoint1->value < endpoint2->value ||
+         (endpoint1->value == endpoint2->value && !endpoint1->is_max &&
+          endpoint2->is_max);
+}
+
+void sweep_prune_update(sweep_prune_t *sap) {
+  endpoint_t *endpoints = sap->endpoints;
+  for (size_t i = 0; i < sap->num_endpoints; i++) {
+    aabb_t bounds = body_get_bounds(endpoints[i].body);
+    endpoints[i].value = endpoints[i].is_max ? bounds.max.x : bounds.min.x;
+  }
+
+  // Insertion sort: nearly linear when the order barely changed
+  for (size_t i = 1; i < sap->num_endpoints; i++) {
+    endpoint_t endpoint = endpoints[i];
+    size_t j = i;
+    while (j > 0 && endpoint_less(&endpoint, &endpoints[j - 1])) {
+      endpoint_t *passed = &endpoints[j - 1];
+      if (passed->body != endpoint.body) {
+        if (!endpoint.is_max && passed->is_max) {
+          // A left edge moved past a right edge: the boxes now overlap in x
+          sap_add_pair(sap, endpoint.body, passed->body);
+        } else if (endpoint.is_max && !passed->is_max) {
+          // A right edge moved past a left edge: they no longer overlap
+          sap_remove_pair(sap, endpoint.body, passed->body);
+        }
+      }
+      endpoints[j] = *passed;
+      j--;
+    }
+    endpoints[j] = endpoint;
+  }
+}
+
+void sweep_prune_query(sweep_prune_t *sap, aabb_t bounds, list_t *results) {
+  for (size_t i = 0; i < sap->num_endpoints; i++) {
+    endpoint_t *endpoint = &sap->endpoints[i];
+    if (endpoint->value > bounds.max.x) {
+      break;
+    }
+    if (!endpoint->is_max &&
+        aabb_overlaps(bounds, body_get_bounds(endpoint->body))) {
+      list_add(results, endpoint->body);
+    }
+  }
+}
+
+void sweep_prune_for_each_pair(sweep_prune_t *sap, body_pair_handler_t handler,
+                               void *aux) {
+  for (size_t i = 0; i < sap->pairs_capacity; i++) {
+    sap_pair_t pair = sap->pairs[i];
+    // The set tracks x only; the y test finishes the job
+    if (pair.body1 && aabb_overlaps(body_get_bounds(pair.body1),
+                                    body_get_bounds(pair.body2))) {
+      handler(pair.body1, pair.body2, aux);
+    }
+  }
+}
@@ -1,4 +1,5 @@
 #include "test_util.h"
+#include "shapes.h"
 #include <assert.h>
 #include <math.h>
 #include <signal.h>
@@ -106,3 +107,54 @@ bool test_assert_fail(void (*run)(void *aux), void *aux) {
   return SIGABRT_RAISED;
 #endif
 }
+
+double rand_range(double min, double max) {
+  return min + (max - min) * rand() / RAND_MAX;
+}
+
+body_t *make_rect_body(vector_t center, double width, double height) {
+  body_t *body =
+      body_init(make_rect_shape(width, height), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(body, center);
+  return body;
+}
+
+size_t find_body_index(body_t **bodies, size_t num_bodies, body_t *body) {
+  for (size_t i = 0; i < num_bodies; i++) {
+    if (bodies[i] == body) {
+      return i;
+    }
+  }
+  assert(false);
+  return 0;
+}
+
+pair_counts_t *pair_counts_init(body_t **bodies, size_t num_bodies) {
+  pair_counts_t *pair_counts = malloc(sizeof(pair_counts_t));
+  assert(pair_counts);
+  pair_counts->bodies = bodies;
+  pair_counts->num_bodies = num_bodies;
+  pair_counts->counts = calloc(num_bodies * num_bodies, sizeof(int));
+  assert(pair_counts->counts);
+  return pair_counts;
+}
+
+int pair_counts_get(pair_counts_t *pair_counts, size_t i, size_t j) {
+  assert(i < pair_counts->num_bodies && j < pair_counts->num_bodies);
+  return pair_counts->counts[i * pair_counts->num_bodies + j];
+}
+
+void pair_counts_free(pair_counts_t *pair_counts) {
+  free(pair_counts->counts);
+  free(pair_counts);
+}
+
+void count_pair(body_t *body1, body_t *body2, void *aux) {
+  pair_counts_t *pair_counts = aux;
+  size_t n = pair_counts->num_bodies;
+  size_t i = find_body_index(pair_counts->bodies, n, body1);
+  size_t j = find_body_index(pair_counts->bodies, n, body2);
+  assert(i != j);
+  pair_counts->counts[i * n + j]++;
+  pair_counts->counts[j * n + i]++;
+}
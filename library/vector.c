@@ -26,8 +26,16 @@ double vec_dot(vector_t v1, vector_t v2) { return v1.x * v2.x + v1.y * v2.y; }
 double vec_cross(vector_t v1, vector_t v2) { return v1.x * v2.y - v1.y * v2.x; }
 
 vector_t vec_rotate(vector_t v, double angle) {
-  double new_x = v.x * cos(angle) - v.y * sin(angle);
-  double new_y = v.x * sin(angle) + v.y * cos(angle);
+  return vec_rotate_by(v, rotation_from_angle(angle));
+}
+
+rotation_t rotation_from_angle(double angle) {
+  return (rotation_t){cos(angle), sin(angle)};
+}
+
+vector_t vec_rotate_by(vector_t v, rotation_t rotation) {
+  double new_x = v.x * rotation.cos - v.y * rotation.sin;
+  double new_y = v.x * rotation.sin + v.y * rotation.cos;
   v.x = new_x;
   v.y = new_y;
   return v;
@@ -0,0 +1,130 @@
+#include "../include/barnes_hut.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define NUM_POINTS 500
+#define MIN_DISTANCE 0.01
+
+vector_t direct_field(vector_t *positions, double *masses, size_t num_points,
+                      size_t index) {
+  vector_t field = VEC_ZERO;
+  for (size_t j = 0; j < num_points; j++) {
+    vector_t displacement = vec_subtract(positions[j], positions[index]);
+    double distance = sqrt(vec_dot(displacement, displacement));
+    if (j != index && distance >= MIN_DISTANCE) {
+      double scale = masses[j] / (distance * distance * distance);
+      field = vec_add(field, vec_multiply(scale, displacement));
+    }
+  }
+  return field;
+}
+
+double vec_norm(vector_t v) { return sqrt(vec_dot(v, v)); }
+
+void make_points(vector_t positions[NUM_POINTS], double masses[NUM_POINTS]) {
+  for (size_t i = 0; i < NUM_POINTS; i++) {
+    // A dense cluster plus a sparse halo
+    double spread = i % 4 == 0 ? 1000 : 50;
+    positions[i] = (vector_t){rand_range(-spread, spread),
+                              rand_range(-spread, spread)};
+    masses[i] = rand_range(1, 20);
+  }
+}
+
+void test_exact_when_theta_zero() {
+  srand(5);
+  vector_t positions[NUM_POINTS];
+  double masses[NUM_POINTS];
+  make_points(positions, masses);
+  barnes_hut_t *tree = barnes_hut_init();
+  barnes_hut_build(tree, positions, masses, NUM_POINTS);
+  for (size_t i = 0; i < NUM_POINTS; i++) {
+    vector_t expected = direct_field(positions, masses, NUM_POINTS, i);
+    vector_t actual = barnes_hut_field(tree, i, 0, MIN_DISTANCE);
+    assert(vec_norm(vec_subtract(actual, expected)) <=
+           1e-9 * vec_norm(expected));
+  }
+  barnes_hut_free(tree);
+}
+
+void test_approximation_error() {
+  srand(6);
+  vector_t positions[NUM_POINTS];
+  double masses[NUM_POINTS];
+  make_points(positions, masses);
+  barnes_hut_t *tree = barnes_hut_init();
+  // Rebuilding reuses the tree; the second build must give the same answers
+  for (int build = 0; build < 2; build++) {
+    barnes_hut_build(tree, positions, masses, NUM_POINTS);
+    vector_t fields[NUM_POINTS];
+    barnes_hut_fields(tree, 0.5, MIN_DISTANCE, fields);
+    double total_error = 0;
+    double total_field = 0;
+    for (size_t i = 0; i < NUM_POINTS; i++) {
+      vector_t expected = direct_field(positions, masses, NUM_POINTS, i);
+      vector_t actual = barnes_hut_field(tree, i, 0.5, MIN_DISTANCE);
+      total_error += vec_norm(vec_subtract(actual, expected));
+      total_field += vec_norm(expected);
+      // Evaluating every point at once gives the same answers
+      assert(vec_isclose(fields[i], actual));
+    }
+    assert(total_error < 0.01 * total_field);
+  }
+  barnes_hut_free(tree);
+}
+
+void test_coincident_points() {
+  vector_t positions[] = {{3, 3}, {3, 3}, {3, 3}, {10, 3}};
+  double masses[] = {1, 2, 3, 4};
+  barnes_hut_t *tree = barnes_hut_init();
+  barnes_hut_build(tree, positions, masses, 4);
+  // The far point feels all three stacked masses
+  vector_t field = barnes_hut_field(tree, 3, 0.5, MIN_DISTANCE);
+  assert(vec_isclose(field, (vector_t){-6.0 / 49, 0}));
+  // The stacked points only feel the far one
+  field = barnes_hut_field(tree, 0, 0.5, MIN_DISTANCE);
+  assert(vec_isclose(field, (vector_t){4.0 / 49, 0}));
+
+  barnes_hut_build(tree, positions, masses, 0);
+  barnes_hut_free(tree);
+}
+
+void test_full_leaf_at_max_depth() {
+  // More stacked points than fit in a leaf can never be split apart
+  vector_t positions[20];
+  double masses[20];
+  for (size_t i = 0; i < 19; i++) {
+    positions[i] = (vector_t){-5, 0};
+    masses[i] = 1;
+  }
+  positions[19] = (vector_t){5, 0};
+  masses[19] = 2;
+  barnes_hut_t *tree = barnes_hut_init();
+  barnes_hut_build(tree, positions, masses, 20);
+  vector_t fields[20];
+  barnes_hut_fields(tree, 0.5, MIN_DISTANCE, fields);
+  for (size_t i = 0; i < 19; i++) {
+    assert(vec_isclose(fields[i], (vector_t){2.0 / 100, 0}));
+  }
+  assert(vec_isclose(fields[19], (vector_t){-19.0 / 100, 0}));
+  barnes_hut_free(tree);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_exact_when_theta_zero)
+  DO_TEST(test_approximation_error)
+  DO_TEST(test_coincident_points)
+  DO_TEST(test_full_leaf_at_max_depth)
+
+  puts("barnes_hut_test PASS");
+}
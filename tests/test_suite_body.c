@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 void test_body_init() {
   vector_t v[] = {{1, 1}, {2, 1}, {2, 2}, {1, 2}};
@@ -248,6 +249,152 @@ void test_body_info_freer() {
   body_free(body);
 }
 
+void test_body_bounds() {
+  list_t *shape = list_init(3, free);
+  vector_t *v = malloc(sizeof(*v));
+  *v = (vector_t){+1, 0};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){0, +1};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){-1, 0};
+  list_add(shape, v);
+  body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+  aabb_t bounds = body_get_bounds(body);
+  assert(vec_isclose(bounds.min, (vector_t){-1, 0}));
+  assert(vec_isclose(bounds.max, (vector_t){+1, +1}));
+
+  body_set_centroid(body, (vector_t){5, 6});
+  bounds = body_get_bounds(body);
+  assert(vec_isclose(bounds.min, (vector_t){4, 17.0 / 3.0}));
+  assert(vec_isclose(bounds.max, (vector_t){6, 20.0 / 3.0}));
+
+  // After rotating, the cached box must match the rotated vertices
+  body_set_rotation(body, M_PI / 2);
+  bounds = body_get_bounds(body);
+  aabb_t expected = polygon_bounds(body_peek_shape(body));
+  assert(vec_isclose(bounds.min, expected.min));
+  assert(vec_isclose(bounds.max, expected.max));
+  assert(isclose(bounds.max.x - bounds.min.x, 1));
+  assert(isclose(bounds.max.y - bounds.min.y, 2));
+  body_free(body);
+}
+
+void test_lazy_shape() {
+  list_t *shape = list_init(3, free);
+  vector_t *v = malloc(sizeof(*v));
+  *v = (vector_t){+1, 0};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){0, +1};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){-1, 0};
+  list_add(shape, v);
+  list_t *expected = list_init(3, free);
+  for (size_t i = 0; i < list_size(shape); i++) {
+    v = malloc(sizeof(*v));
+    *v = *(vector_t *)list_get(shape, i);
+    list_add(expected, v);
+  }
+  body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+
+  // Move and turn the body many times without looking at its vertices,
+  // including around points other than its centroid
+  vector_t centroid = body_get_centroid(body);
+  for (int i = 0; i < 100; i++) {
+    vector_t translation = {i % 7 - 3, i % 5 - 2};
+    centroid = vec_add(centroid, translation);
+    body_set_centroid(body, centroid);
+    polygon_translate(expected, translation);
+    vector_t point = {i % 3, -1};
+    body_set_rotation_around_point(body, 0.1 * i, point);
+    polygon_rotate(expected, 0.1 * i, point);
+    body_set_rotation(body, -0.05 * i);
+    polygon_rotate(expected, -0.05 * i, centroid);
+  }
+  assert(vec_equal(body_get_centroid(body), centroid));
+
+  // The bounds are rebuilt without asking for the vertices
+  aabb_t bounds = body_get_bounds(body);
+  polygon_t *packed = polygon_from_list(expected);
+  aabb_t expected_bounds = polygon_bounds(packed);
+  polygon_free(packed);
+  assert(vec_isclose(bounds.min, expected_bounds.min));
+  assert(vec_isclose(bounds.max, expected_bounds.max));
+  shape = body_get_shape(body);
+  for (size_t i = 0; i < list_size(shape); i++) {
+    assert(vec_isclose(*(vector_t *)list_get(shape, i),
+                       *(vector_t *)list_get(expected, i)));
+  }
+  list_free(shape);
+  list_free(expected);
+  body_free(body);
+}
+
+void test_previous_centroid() {
+  list_t *shape = list_init(3, free);
+  vector_t *v = malloc(sizeof(*v));
+  *v = (vector_t){+1, 0};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){0, +1};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){-1, 0};
+  list_add(shape, v);
+  body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+  vector_t start = body_get_centroid(body);
+  assert(vec_equal(body_get_previous_centroid(body), start));
+
+  body_set_velocity(body, (vector_t){2, 0});
+  body_tick(body, 0.5);
+  assert(vec_equal(body_get_previous_centroid(body), start));
+  assert(
+      vec_isclose(body_get_centroid(body), vec_add(start, (vector_t){1, 0})));
+
+  // Teleporting carries the previous position along
+  body_set_centroid(body, (vector_t){10, 10});
+  assert(vec_isclose(body_get_previous_centroid(body), (vector_t){9, 10}));
+  body_free(body);
+}
+
+void test_body_label() {
+  list_t *shape = list_init(3, free);
+  vector_t *v = malloc(sizeof(*v));
+  *v = (vector_t){+1, 0};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){0, +1};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){-1, 0};
+  list_add(shape, v);
+  body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+  assert(body_get_label(body) == NULL);
+
+  // Labels never touch the font, so any non-NULL pointer stands in for one
+  int placeholder;
+  font_t *font = (font_t *)&placeholder;
+  char text[20] = "Time left: 10";
+  body_set_label(body, text, font, (rgb_color_t){1, 0, 0});
+  // The body keeps its own copy of the text
+  text[11] = '9';
+  text[12] = '\0';
+  assert(strcmp(body_get_label(body), "Time left: 10") == 0);
+  assert(body_get_label_font(body) == font);
+  body_set_label(body, text, font, (rgb_color_t){1, 0, 0});
+  assert(strcmp(body_get_label(body), "Time left: 9") == 0);
+  body_set_label(body, "A much longer label", font, (rgb_color_t){0, 0, 1});
+  assert(strcmp(body_get_label(body), "A much longer label") == 0);
+  assert(body_get_label_color(body).b == 1);
+
+  body_set_label(body, NULL, NULL, (rgb_color_t){0, 0, 0});
+  assert(body_get_label(body) == NULL);
+  body_free(body);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -265,6 +412,10 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_body_remove)
   DO_TEST(test_body_info)
   DO_TEST(test_body_info_freer)
+  DO_TEST(test_body_bounds)
+  DO_TEST(test_lazy_shape)
+  DO_TEST(test_previous_centroid)
+  DO_TEST(test_body_label)
 
   puts("body_test PASS");
 }
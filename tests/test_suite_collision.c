@@ -1 +1,89 @@
-int main() { return 0; }
\ No newline at end of file
+#include "../include/collision.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// Make square with side length 2 centered at the given point
+list_t *make_square(vector_t center) {
+  list_t *sq = list_init(4, free);
+  vector_t *v = malloc(sizeof(*v));
+  *v = vec_add(center, (vector_t){+1, +1});
+  list_add(sq, v);
+  v = malloc(sizeof(*v));
+  *v = vec_add(center, (vector_t){-1, +1});
+  list_add(sq, v);
+  v = malloc(sizeof(*v));
+  *v = vec_add(center, (vector_t){-1, -1});
+  list_add(sq, v);
+  v = malloc(sizeof(*v));
+  *v = vec_add(center, (vector_t){+1, -1});
+  list_add(sq, v);
+  return sq;
+}
+
+void test_squares_collision() {
+  list_t *sq1 = make_square(VEC_ZERO);
+  list_t *sq2 = make_square((vector_t){1.5, 0.5});
+  list_t *sq3 = make_square((vector_t){3, 0});
+
+  collision_info_t info = find_collision(sq1, sq2);
+  assert(info.collided);
+  assert(isclose(fabs(info.axis.x), 1));
+  assert(isclose(info.axis.y, 0));
+  assert(!find_collision(sq1, sq3).collided);
+  assert(find_collision(sq2, sq3).collided);
+
+  list_free(sq1);
+  list_free(sq2);
+  list_free(sq3);
+}
+
+void test_body_collision_matches_shapes() {
+  body_t *body1 = body_init(make_square(VEC_ZERO), 1, (rgb_color_t){0, 0, 0});
+  body_t *body2 = body_init(make_square(VEC_ZERO), 1, (rgb_color_t){0, 0, 0});
+  for (int i = 0; i < 40; i++) {
+    body_set_centroid(body2, (vector_t){i * 0.1, 0.5});
+    body_set_rotation(body2, 0.1);
+
+    list_t *shape1 = body_get_shape(body1);
+    list_t *shape2 = body_get_shape(body2);
+    collision_info_t expected = find_collision(shape1, shape2);
+    collision_info_t actual = find_body_collision(body1, body2);
+    assert(actual.collided == expected.collided);
+    if (expected.collided) {
+      assert(vec_isclose(actual.axis, expected.axis));
+    }
+    list_free(shape1);
+    list_free(shape2);
+  }
+  assert(find_body_collision(body1, body2).collided == false);
+  body_free(body1);
+  body_free(body2);
+}
+
+void test_bounds_overlap() {
+  aabb_t box = {(vector_t){0, 0}, (vector_t){2, 2}};
+  assert(aabb_overlaps(box, box));
+  assert(aabb_overlaps(box, aabb_translate(box, (vector_t){1, 1})));
+  // Touching edges count as overlapping, matching find_collision()
+  assert(aabb_overlaps(box, aabb_translate(box, (vector_t){2, 0})));
+  assert(!aabb_overlaps(box, aabb_translate(box, (vector_t){2.5, 0})));
+  assert(!aabb_overlaps(box, aabb_translate(box, (vector_t){0, -3})));
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_squares_collision)
+  DO_TEST(test_body_collision_matches_shapes)
+  DO_TEST(test_bounds_overlap)
+
+  puts("collision_test PASS");
+}
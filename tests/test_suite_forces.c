@@ -150,6 +150,115 @@ void test_forces_removed() {
   scene_free(scene);
 }
 
+// Tests that Barnes-Hut gravity with theta = 0 conserves momentum,
+// and that it pulls each body towards the others
+void test_barnes_hut_gravity() {
+  const double G = 1e3;
+  const double DT = 1e-3;
+  const int NUM_MASSES = 20;
+  scene_t *scene = scene_init();
+  create_barnes_hut_gravity(scene, G, 0);
+  for (int i = 0; i < NUM_MASSES; i++) {
+    body_t *body = body_init(make_shape(), 1 + i % 5, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){cos(i) * 10 * i, sin(i) * 10 * i});
+    scene_add_body(scene, body);
+  }
+
+  scene_tick(scene, DT);
+  body_t *outer = scene_get_body(scene, NUM_MASSES - 1);
+  assert(vec_dot(body_get_velocity(outer), body_get_centroid(outer)) < 0);
+
+  for (int i = 0; i < 100; i++) {
+    scene_tick(scene, DT);
+  }
+  vector_t momentum = VEC_ZERO;
+  double max_momentum = 0;
+  for (int i = 0; i < NUM_MASSES; i++) {
+    body_t *body = scene_get_body(scene, i);
+    vector_t p = vec_multiply(body_get_mass(body), body_get_velocity(body));
+    momentum = vec_add(momentum, p);
+    max_momentum = fmax(max_momentum, sqrt(vec_dot(p, p)));
+  }
+  assert(max_momentum > 0);
+  assert(sqrt(vec_dot(momentum, momentum)) < 1e-9 * max_momentum);
+  scene_free(scene);
+}
+
+bool is_heavy(body_t *body) { return body_get_mass(body) > 1; }
+
+// Tests that a uniform field accelerates every selected body by g
+void test_uniform_field() {
+  const vector_t G = {0, -9.8};
+  const double DT = 0.01;
+  scene_t *scene = scene_init();
+  body_t *light = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, light);
+  body_t *heavy = body_init(make_shape(), 5, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, heavy);
+  body_t *fixed = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, fixed);
+  create_uniform_field(scene, G);
+  create_filtered_uniform_field(scene, G, is_heavy);
+
+  for (int i = 0; i < 100; i++) {
+    scene_tick(scene, DT);
+  }
+  // The heavy body feels both fields
+  assert(vec_isclose(body_get_velocity(light), vec_multiply(100 * DT, G)));
+  assert(vec_isclose(body_get_velocity(heavy), vec_multiply(200 * DT, G)));
+  assert(vec_equal(body_get_velocity(fixed), VEC_ZERO));
+  assert(vec_isclose(body_get_centroid(light),
+                     vec_multiply(0.5 * (100 * DT) * (100 * DT), G)));
+  scene_free(scene);
+}
+
+bool is_any_body(body_t *body) { return true; }
+
+// Tests that collisions registered by type behave like per-pair collisions
+void test_type_collisions() {
+  const double DT = 0.1;
+  const double V = 1.23;
+  const double SEPARATION_AT_COLLISION = 1.5;
+  const int TICKS_TO_COLLISION = 10;
+
+  // Try no broad phase, a spatial hash, and sweep-and-prune
+  for (int broad_phase = 0; broad_phase < 3; broad_phase++) {
+    scene_t *scene = scene_init();
+    if (broad_phase == 1) {
+      scene_enable_spatial_hash(scene, 1);
+    } else if (broad_phase == 2) {
+      scene_enable_sweep_prune(scene);
+    }
+    create_type_collision(scene, is_any_body, is_any_body,
+                          destructive_collision_handler, NULL, NULL);
+
+    body_t *body1 = make_triangle_body();
+    vector_t initial_separation = {
+        SEPARATION_AT_COLLISION + V * DT * (TICKS_TO_COLLISION - 0.5), 0};
+    body_set_centroid(body1, vec_negate(initial_separation));
+    body_set_velocity(body1, (vector_t){+V, 0});
+    scene_add_body(scene, body1);
+
+    body_t *body2 = make_triangle_body();
+    scene_add_body(scene, body2);
+
+    body_t *body3 = make_triangle_body();
+    body_set_velocity(body3, (vector_t){-V, 0});
+    body_set_centroid(body3, initial_separation);
+    scene_add_body(scene, body3);
+
+    for (int i = 0; i < TICKS_TO_COLLISION * 2; i++) {
+      scene_tick(scene, DT);
+      if (i < TICKS_TO_COLLISION) {
+        assert(scene_bodies(scene) == 3);
+      } else {
+        assert(scene_bodies(scene) == 0);
+      }
+    }
+    scene_free(scene);
+  }
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -163,6 +272,9 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_energy_conservation)
   DO_TEST(test_collisions)
   DO_TEST(test_forces_removed)
+  DO_TEST(test_type_collisions)
+  DO_TEST(test_barnes_hut_gravity)
+  DO_TEST(test_uniform_field)
 
   puts("forces_test PASS");
 }
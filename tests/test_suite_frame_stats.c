@@ -0,0 +1,63 @@
+#include "../include/frame_stats.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+void test_empty() {
+  frame_stats_t *stats = frame_stats_init(10);
+  frame_summary_t summary = frame_stats_summarize(stats);
+  assert(summary.num_frames == 0);
+  assert(summary.min == 0 && summary.max == 0);
+  assert(summary.mean == 0 && summary.p99 == 0);
+  frame_stats_free(stats);
+}
+
+void test_summary() {
+  frame_stats_t *stats = frame_stats_init(1000);
+  // Frames of 1 through 200 ms, in a scrambled order
+  for (size_t i = 0; i < 200; i++) {
+    frame_stats_record(stats, ((i * 37) % 200 + 1) / 1000.0);
+  }
+  frame_summary_t summary = frame_stats_summarize(stats);
+  assert(summary.num_frames == 200);
+  assert(isclose(summary.min, 0.001));
+  assert(isclose(summary.max, 0.2));
+  assert(isclose(summary.mean, 0.1005));
+  assert(isclose(summary.p99, 0.198));
+  frame_stats_free(stats);
+}
+
+void test_window() {
+  const size_t WINDOW = 8;
+  frame_stats_t *stats = frame_stats_init(WINDOW);
+  // A slow frame falls out of the window once enough fast frames follow it
+  frame_stats_record(stats, 1.0);
+  for (size_t i = 0; i < WINDOW - 1; i++) {
+    frame_stats_record(stats, 0.01);
+  }
+  assert(isclose(frame_stats_summarize(stats).max, 1.0));
+  frame_stats_record(stats, 0.02);
+  frame_summary_t summary = frame_stats_summarize(stats);
+  assert(summary.num_frames == WINDOW);
+  assert(isclose(summary.max, 0.02));
+  assert(isclose(summary.min, 0.01));
+  assert(isclose(summary.p99, 0.02));
+  frame_stats_free(stats);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_empty)
+  DO_TEST(test_summary)
+  DO_TEST(test_window)
+
+  puts("frame_stats_test PASS");
+}
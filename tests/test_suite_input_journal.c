@@ -0,0 +1,98 @@
+#include "../include/input_journal.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const char *JOURNAL_FILE = "input_journal_test.bin";
+
+void test_round_trip() {
+  input_recorder_t *recorder = input_recorder_init(JOURNAL_FILE, 1.0 / 60);
+  assert(recorder);
+  input_recorder_mouse(recorder, 0, (vector_t){10, 20});
+  input_recorder_key(recorder, 3, 'q', 0, 0.25);
+  input_recorder_key(recorder, 3, 'q', 1, 0.5);
+  // The mouse didn't move, so nothing is recorded
+  input_recorder_mouse(recorder, 3, (vector_t){10, 20});
+  input_recorder_mouse(recorder, 1000, (vector_t){-5.5, 7});
+  input_recorder_free(recorder, 2000);
+
+  input_player_t *player = input_player_init(JOURNAL_FILE);
+  assert(player);
+  assert(isclose(input_player_dt(player), 1.0 / 60));
+  assert(input_player_num_frames(player) == 2000);
+  journal_event_t event;
+  assert(input_player_next(player, 0, &event));
+  assert(event.kind == JOURNAL_MOUSE && event.frame == 0);
+  assert(vec_equal(event.mouse_pos, (vector_t){10, 20}));
+  assert(!input_player_next(player, 0, &event));
+  assert(!input_player_next(player, 2, &event));
+  assert(input_player_next(player, 3, &event));
+  assert(event.kind == JOURNAL_KEY && event.key == 'q' && event.type == 0);
+  assert(event.held_time == 0.25);
+  assert(input_player_next(player, 3, &event));
+  assert(event.kind == JOURNAL_KEY && event.type == 1);
+  assert(event.held_time == 0.5);
+  assert(!input_player_next(player, 3, &event));
+  assert(input_player_next(player, 1000, &event));
+  assert(event.kind == JOURNAL_MOUSE && event.frame == 1000);
+  assert(vec_equal(event.mouse_pos, (vector_t){-5.5, 7}));
+  assert(!input_player_next(player, 1999, &event));
+  input_player_free(player);
+  remove(JOURNAL_FILE);
+}
+
+void test_skipped_frames() {
+  input_recorder_t *recorder = input_recorder_init(JOURNAL_FILE, 0.01);
+  input_recorder_key(recorder, 1, 'a', 0, 0);
+  input_recorder_key(recorder, 2, 'b', 0, 0);
+  input_recorder_free(recorder, 3);
+
+  input_player_t *player = input_player_init(JOURNAL_FILE);
+  journal_event_t event;
+  // Frame 1 is never played, so its event is dropped
+  assert(input_player_next(player, 2, &event));
+  assert(event.key == 'b');
+  assert(!input_player_next(player, 2, &event));
+  input_player_free(player);
+  remove(JOURNAL_FILE);
+}
+
+void test_invalid_journal() {
+  assert(input_player_init("no_such_journal.bin") == NULL);
+
+  FILE *file = fopen(JOURNAL_FILE, "wb");
+  fputs("not a journal", file);
+  fclose(file);
+  assert(input_player_init(JOURNAL_FILE) == NULL);
+
+  // A journal that was never finished has no end record
+  input_recorder_t *recorder = input_recorder_init(JOURNAL_FILE, 0.01);
+  input_recorder_key(recorder, 1, 'a', 0, 0);
+  input_recorder_free(recorder, 5);
+  char contents[100];
+  file = fopen(JOURNAL_FILE, "rb");
+  size_t size = fread(contents, 1, sizeof(contents), file);
+  fclose(file);
+  file = fopen(JOURNAL_FILE, "wb");
+  fwrite(contents, 1, size - 2, file);
+  fclose(file);
+  assert(input_player_init(JOURNAL_FILE) == NULL);
+  remove(JOURNAL_FILE);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_round_trip)
+  DO_TEST(test_skipped_frames)
+  DO_TEST(test_invalid_journal)
+
+  puts("input_journal_test PASS");
+}
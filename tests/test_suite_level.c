@@ -0,0 +1,202 @@
+#include "../include/level.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char *TEXT_LEVEL_FILE = "level_test.lvl";
+const char *BINARY_LEVEL_FILE = "level_test.bin";
+
+const char *LEVEL_TEXT = "# A small level\n"
+                         "\n"
+                         "background assets/images/level_0.png  \n"
+                         "gravity\n"
+                         "  wall 32 624 64 160\n"
+                         "platform 448 416 -25 2 38 23 447 340\n"
+                         "platform 576 392 0 2 0 48 598 340\n"
+                         "button 512 64 0 1\n"
+                         "portal_surface_polygon 104 330 64 352 64 320 "
+                         "128 256 160 256\n"
+                         "player 100 96 -1\n"
+                         "exit 864 480\n"
+                         "timer 60";
+
+void write_file(const char *filename, const char *contents, size_t size) {
+  FILE *file = fopen(filename, "wb");
+  assert(file);
+  assert(fwrite(contents, 1, size, file) == size);
+  fclose(file);
+}
+
+void get_record_past_end(void *level) {
+  level_get_record(level, level_num_records(level));
+}
+
+void check_level(level_t *level) {
+  assert(level_num_records(level) == 10);
+
+  level_record_t record = level_get_record(level, 0);
+  assert(record.kind == LEVEL_BACKGROUND);
+  assert(record.num_values == 0);
+  assert(strcmp(record.string, "assets/images/level_0.png") == 0);
+
+  record = level_get_record(level, 1);
+  assert(record.kind == LEVEL_GRAVITY);
+  assert(record.num_values == 0 && record.string == NULL);
+
+  record = level_get_record(level, 2);
+  assert(record.kind == LEVEL_WALL);
+  assert(record.num_values == 4);
+  assert(record.values[0] == 32 && record.values[3] == 160);
+
+  record = level_get_record(level, 3);
+  assert(record.kind == LEVEL_PLATFORM);
+  assert(record.num_values == 8 && record.values[2] == -25);
+
+  record = level_get_record(level, 5);
+  assert(record.kind == LEVEL_BUTTON);
+  assert(record.num_values == 4);
+  assert(record.values[2] == 0 && record.values[3] == 1);
+
+  record = level_get_record(level, 6);
+  assert(record.kind == LEVEL_PORTAL_SURFACE_POLYGON);
+  assert(record.num_values == 10 && record.values[9] == 256);
+
+  record = level_get_record(level, 7);
+  assert(record.kind == LEVEL_PLAYER && record.values[2] == -1);
+
+  record = level_get_record(level, 8);
+  assert(record.kind == LEVEL_EXIT && record.num_values == 2);
+
+  // The last line doesn't need to end in a newline
+  record = level_get_record(level, 9);
+  assert(record.kind == LEVEL_TIMER && record.values[0] == 60);
+  assert(test_assert_fail(get_record_past_end, level));
+}
+
+void test_parse_text() {
+  level_t *level = level_parse(LEVEL_TEXT, "test");
+  assert(level);
+  check_level(level);
+  level_free(level);
+
+  // level_load() reads the text form from a file
+  write_file(TEXT_LEVEL_FILE, LEVEL_TEXT, strlen(LEVEL_TEXT));
+  level = level_load(TEXT_LEVEL_FILE);
+  assert(level);
+  check_level(level);
+  level_free(level);
+  remove(TEXT_LEVEL_FILE);
+}
+
+void test_binary_round_trip() {
+  level_t *level = level_parse(LEVEL_TEXT, "test");
+  assert(level);
+  assert(level_write_binary(level, BINARY_LEVEL_FILE));
+  level_free(level);
+
+  level = level_load(BINARY_LEVEL_FILE);
+  assert(level);
+  check_level(level);
+  level_free(level);
+
+  // Cutting off the end of a binary level makes it invalid
+  char contents[1000];
+  FILE *file = fopen(BINARY_LEVEL_FILE, "rb");
+  size_t size = fread(contents, 1, sizeof(contents), file);
+  fclose(file);
+  assert(size < sizeof(contents));
+  write_file(BINARY_LEVEL_FILE, contents, size - 1);
+  assert(level_load(BINARY_LEVEL_FILE) == NULL);
+  remove(BINARY_LEVEL_FILE);
+}
+
+void test_invalid_text() {
+  assert(level_parse("ladder 1 2\n", "unknown keyword") == NULL);
+  assert(level_parse("wall 1 2 3\n", "too few values") == NULL);
+  assert(level_parse("exit 1 2 3\n", "too many values") == NULL);
+  assert(level_parse("wall 1 2 x 4\n", "not a number") == NULL);
+  assert(level_parse("wall 1 2 0 4\n", "empty wall") == NULL);
+  assert(level_parse("background\n", "missing path") == NULL);
+  assert(level_parse("portal 3 0 0 1 0\n", "bad portal") == NULL);
+  assert(level_parse("portal_surface_polygon 0 0 1 1 2 2 3\n",
+                     "odd number of coordinates") == NULL);
+  // Buttons can only move platforms that come before them
+  assert(level_parse("button 0 0 0\n"
+                     "platform 0 0 0 1 0 0 0 0\n",
+                     "platform after button") == NULL);
+  assert(level_parse("platform 0 0 0 1 0 0 0 0\n"
+                     "button 0 0 0.5\n",
+                     "fractional platform") == NULL);
+  assert(level_load("no_such_level.lvl") == NULL);
+}
+
+void test_incomplete_level() {
+  const char *PLAYER = "player 0 0 1\n";
+  const char *EXIT = "exit 0 0\n";
+  const char *TIMER = "timer 60\n";
+  char text[200];
+  snprintf(text, sizeof(text), "%s%s%s", PLAYER, EXIT, TIMER);
+  level_t *level = level_parse(text, "complete");
+  assert(level);
+  level_free(level);
+
+  assert(level_parse("", "empty") == NULL);
+  snprintf(text, sizeof(text), "%s%s", EXIT, TIMER);
+  assert(level_parse(text, "no player") == NULL);
+  snprintf(text, sizeof(text), "%s%s", PLAYER, TIMER);
+  assert(level_parse(text, "no exit") == NULL);
+  snprintf(text, sizeof(text), "%s%s", PLAYER, EXIT);
+  assert(level_parse(text, "no timer") == NULL);
+  snprintf(text, sizeof(text), "%s%s%s%s", PLAYER, EXIT, TIMER, PLAYER);
+  assert(level_parse(text, "two players") == NULL);
+  snprintf(text, sizeof(text), "%s%s%s%s", PLAYER, EXIT, TIMER, TIMER);
+  assert(level_parse(text, "two timers") == NULL);
+
+  // More than one exit is allowed
+  snprintf(text, sizeof(text), "%s%s%s%s", PLAYER, EXIT, EXIT, TIMER);
+  level = level_parse(text, "two exits");
+  assert(level);
+  level_free(level);
+
+  // Boxes and the portal gun are attached to the player
+  snprintf(text, sizeof(text), "box 0 0\n%s%s%s", PLAYER, EXIT, TIMER);
+  assert(level_parse(text, "box before player") == NULL);
+  snprintf(text, sizeof(text), "portal_gun\n%s%s%s", PLAYER, EXIT, TIMER);
+  assert(level_parse(text, "portal gun before player") == NULL);
+  snprintf(text, sizeof(text), "%sbox 0 0\nportal_gun\n%s%s", PLAYER, EXIT,
+           TIMER);
+  level = level_parse(text, "box and portal gun after player");
+  assert(level);
+  level_free(level);
+}
+
+void test_game_levels() {
+  // Every level shipped with the game is valid
+  char filename[100];
+  for (size_t i = 0; i < 6; i++) {
+    snprintf(filename, sizeof(filename), "assets/levels/level_%zu.lvl", i);
+    level_t *level = level_load(filename);
+    assert(level);
+    level_free(level);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_parse_text)
+  DO_TEST(test_binary_round_trip)
+  DO_TEST(test_invalid_text)
+  DO_TEST(test_incomplete_level)
+  DO_TEST(test_game_levels)
+
+  puts("level_test PASS");
+}
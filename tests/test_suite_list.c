@@ -275,6 +275,59 @@ void test_null_values() {
   list_free(l);
 }
 
+// Makes a list of pointers to the numbers 0 through size - 1
+list_t *make_int_list(size_t size) {
+  list_t *l = list_init(size, free);
+  for (size_t i = 0; i < size; i++) {
+    int *value = malloc(sizeof(*value));
+    *value = i;
+    list_add(l, value);
+  }
+  return l;
+}
+
+void test_swap_remove() {
+  list_t *l = make_int_list(5);
+  // The last element takes the removed one's place
+  int *removed = list_swap_remove(l, 1);
+  assert(*removed == 1);
+  free(removed);
+  assert(list_size(l) == 4);
+  assert(*(int *)list_get(l, 1) == 4);
+  assert(*(int *)list_get(l, 3) == 3);
+  // Removing the last element leaves the rest alone
+  removed = list_swap_remove(l, 3);
+  assert(*removed == 3);
+  free(removed);
+  assert(list_size(l) == 3);
+  assert(*(int *)list_get(l, 0) == 0);
+  assert(*(int *)list_get(l, 1) == 4);
+  assert(*(int *)list_get(l, 2) == 2);
+  list_free(l);
+}
+
+bool is_multiple(void *value, void *divisor) {
+  return *(int *)value % *(int *)divisor == 0;
+}
+
+void test_compact() {
+  const size_t size = 100;
+  list_t *l = make_int_list(size);
+  int divisor = 3;
+  // The freer releases the removed elements, so ASan would catch a leak
+  assert(list_compact(l, is_multiple, &divisor) == 34);
+  assert(list_size(l) == size - 34);
+  for (size_t i = 0; i < list_size(l); i++) {
+    int value = *(int *)list_get(l, i);
+    assert(value == (int)(i + i / 2 + 1));
+  }
+  divisor = 1;
+  assert(list_compact(l, is_multiple, &divisor) == size - 34);
+  assert(list_size(l) == 0);
+  assert(list_compact(l, is_multiple, &divisor) == 0);
+  list_free(l);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -294,6 +347,8 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_full_add)
   DO_TEST(test_empty_remove)
   DO_TEST(test_null_values)
+  DO_TEST(test_swap_remove)
+  DO_TEST(test_compact)
 
   puts("list_test PASS");
 }
@@ -1,4 +1,5 @@
 #include "../include/polygon.h"
+#include "../include/shapes.h"
 #include "test_util.h"
 #include <assert.h>
 #include <math.h>
@@ -218,6 +219,116 @@ void test_weird_rotate() {
   list_free(w);
 }
 
+void test_packed_matches_list() {
+  list_t *w = make_weird();
+  polygon_t *packed = polygon_from_list(w);
+  assert(polygon_size(packed) == list_size(w));
+  assert(isclose(polygon_area_packed(packed), polygon_area(w)));
+  assert(vec_isclose(polygon_centroid_packed(packed), polygon_centroid(w)));
+
+  polygon_translate(w, (vector_t){-10, -20});
+  polygon_rotate(w, M_PI / 3, (vector_t){1, 2});
+  polygon_translate_packed(packed, (vector_t){-10, -20});
+  polygon_rotate_packed(packed, M_PI / 3, (vector_t){1, 2});
+  vector_t *vertices = polygon_vertices(packed);
+  for (size_t i = 0; i < list_size(w); i++) {
+    assert(vec_isclose(vertices[i], *(vector_t *)list_get(w, i)));
+  }
+
+  list_t *round_trip = polygon_to_list(packed);
+  polygon_t *copy = polygon_copy(packed);
+  polygon_free(packed);
+  for (size_t i = 0; i < list_size(w); i++) {
+    assert(vec_equal(polygon_vertices(copy)[i],
+                     *(vector_t *)list_get(round_trip, i)));
+  }
+  polygon_free(copy);
+  list_free(round_trip);
+  list_free(w);
+}
+
+void test_transform() {
+  list_t *w = make_weird();
+  polygon_t *source = polygon_from_list(w);
+  polygon_t *polygon = polygon_from_list(w);
+  polygon_translate_packed(polygon, (vector_t){3, -1});
+  polygon_t *expected = polygon_copy(source);
+
+  // Transforming from another polygon rotates about (0, 0), then translates
+  polygon_transform_packed(polygon, source, rotation_from_angle(-M_PI / 3),
+                           (vector_t){-1, 0});
+  polygon_rotate_packed(expected, -M_PI / 3, VEC_ZERO);
+  polygon_translate_packed(expected, (vector_t){-1, 0});
+  for (size_t j = 0; j < polygon_size(expected); j++) {
+    assert(vec_isclose(polygon_vertices(polygon)[j],
+                       polygon_vertices(expected)[j]));
+  }
+  polygon_free(source);
+  polygon_free(polygon);
+  polygon_free(expected);
+  list_free(w);
+}
+
+/** Checks that a polygon's cached shape data matches computing it again */
+void check_shape_data(polygon_t *polygon) {
+  list_t *list = polygon_to_list(polygon);
+  polygon_t *fresh = polygon_from_list(list);
+  list_free(list);
+  assert(isclose(polygon_area_packed(polygon), polygon_area_packed(fresh)));
+  assert(vec_isclose(polygon_centroid_packed(polygon),
+                     polygon_centroid_packed(fresh)));
+  assert(isclose(polygon_radius(polygon), polygon_radius(fresh)));
+  assert(isclose(polygon_moment_of_inertia(polygon),
+                 polygon_moment_of_inertia(fresh)));
+  for (size_t i = 0; i < polygon_size(polygon); i++) {
+    assert(vec_isclose(polygon_edge_normals(polygon)[i],
+                       polygon_edge_normals(fresh)[i]));
+  }
+  polygon_free(fresh);
+}
+
+void test_shape_data() {
+  // A 2x2 square centered at (3, 4)
+  polygon_t *sq = polygon_init(4);
+  vector_t *v = polygon_vertices(sq);
+  v[0] = (vector_t){2, 3};
+  v[1] = (vector_t){4, 3};
+  v[2] = (vector_t){4, 5};
+  v[3] = (vector_t){2, 5};
+  assert(isclose(polygon_area_packed(sq), 4));
+  assert(vec_isclose(polygon_centroid_packed(sq), (vector_t){3, 4}));
+  assert(isclose(polygon_radius(sq), sqrt(2)));
+  // (width^2 + height^2) / 12 for a rectangle
+  assert(isclose(polygon_moment_of_inertia(sq), 8.0 / 12.0));
+  const vector_t *normals = polygon_edge_normals(sq);
+  assert(vec_isclose(normals[0], (vector_t){0, -1}));
+  assert(vec_isclose(normals[1], (vector_t){1, 0}));
+  assert(vec_isclose(normals[2], (vector_t){0, 1}));
+  assert(vec_isclose(normals[3], (vector_t){-1, 0}));
+
+  // Moving the polygon keeps its shape data up to date
+  polygon_translate_packed(sq, (vector_t){-10, 7});
+  check_shape_data(sq);
+  polygon_rotate_packed(sq, 0.7, (vector_t){1, -2});
+  check_shape_data(sq);
+  polygon_t *copy = polygon_copy(sq);
+  polygon_transform_packed(copy, sq, rotation_from_angle(2), (vector_t){5, 5});
+  check_shape_data(copy);
+  polygon_free(copy);
+
+  // Writing the vertices directly requires recomputing it
+  polygon_vertices(sq)[2] = (vector_t){10, 20};
+  polygon_vertices_changed(sq);
+  check_shape_data(sq);
+  polygon_free(sq);
+
+  // A circle's moment of inertia per unit mass approaches radius^2 / 2
+  polygon_t *circle = make_circ_polygon(3, 360);
+  assert(fabs(polygon_moment_of_inertia(circle) - 4.5) < 1e-3);
+  assert(isclose(polygon_radius(circle), 3));
+  polygon_free(circle);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests? True if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -239,6 +350,9 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_weird_area_centroid)
   DO_TEST(test_weird_translate)
   DO_TEST(test_weird_rotate)
+  DO_TEST(test_packed_matches_list)
+  DO_TEST(test_transform)
+  DO_TEST(test_shape_data)
 
   puts("polygon_test PASS");
 }
@@ -0,0 +1,154 @@
+#include "../include/raster_backend.h"
+#include "../include/scene.h"
+#include "../include/shapes.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t WIDTH = 100;
+const size_t HEIGHT = 50;
+const vector_t MIN = {0, 0};
+const vector_t MAX = {200, 100};
+
+const uint8_t *get_pixel(render_backend_t *backend, size_t x, size_t y) {
+  return &raster_backend_pixels(backend)[4 * (y * WIDTH + x)];
+}
+
+bool pixel_is(render_backend_t *backend, size_t x, size_t y, uint8_t r,
+              uint8_t g, uint8_t b) {
+  const uint8_t *pixel = get_pixel(backend, x, y);
+  return pixel[0] == r && pixel[1] == g && pixel[2] == b && pixel[3] == 255;
+}
+
+void test_polygon() {
+  render_backend_t *backend = raster_backend_init(WIDTH, HEIGHT, MIN, MAX);
+  render_set_backend(backend);
+  scene_t *scene = scene_init();
+  // A 40x20 rectangle centered in the scene, which is 20x10 pixels
+  body_t *body = body_init(make_rect_shape(40, 20), 1, (rgb_color_t){1, 0, 0});
+  body_set_centroid(body, (vector_t){100, 50});
+  scene_add_body(scene, body);
+  render_scene(scene);
+  assert(raster_backend_frames(backend) == 1);
+
+  assert(pixel_is(backend, 40, 20, 255, 0, 0));
+  assert(pixel_is(backend, 59, 29, 255, 0, 0));
+  assert(pixel_is(backend, 39, 20, 255, 255, 255));
+  assert(pixel_is(backend, 60, 29, 255, 255, 255));
+  assert(pixel_is(backend, 40, 19, 255, 255, 255));
+  assert(pixel_is(backend, 40, 30, 255, 255, 255));
+  // The boundary of the scene is outlined
+  assert(pixel_is(backend, 0, 0, 0, 0, 0));
+  assert(pixel_is(backend, WIDTH - 1, HEIGHT - 1, 0, 0, 0));
+
+  // Moving the body and drawing again clears the old position
+  body_set_centroid(body, (vector_t){30, 50});
+  render_scene(scene);
+  assert(pixel_is(backend, 50, 25, 255, 255, 255));
+  assert(pixel_is(backend, 15, 25, 255, 0, 0));
+
+  scene_free(scene);
+  render_set_backend(NULL);
+  render_backend_free(backend);
+}
+
+void test_concave_polygon() {
+  render_backend_t *backend = raster_backend_init(WIDTH, HEIGHT, MIN, MAX);
+  render_set_backend(backend);
+  scene_t *scene = scene_init();
+  // A U shape open at the top
+  vector_t v[] = {{40, 20}, {160, 20}, {160, 80}, {120, 80},
+                  {120, 40}, {80, 40},  {80, 80},  {40, 80}};
+  list_t *shape = list_init(8, free);
+  for (size_t i = 0; i < sizeof(v) / sizeof(*v); i++) {
+    vector_t *vertex = malloc(sizeof(*vertex));
+    *vertex = v[i];
+    list_add(shape, vertex);
+  }
+  scene_add_body(scene, body_init(shape, 1, (rgb_color_t){0, 0, 1}));
+  render_scene(scene);
+  // The arms and the base are filled, the gap between the arms is not
+  assert(pixel_is(backend, 25, 15, 0, 0, 255));
+  assert(pixel_is(backend, 75, 15, 0, 0, 255));
+  assert(pixel_is(backend, 50, 35, 0, 0, 255));
+  assert(pixel_is(backend, 50, 15, 255, 255, 255));
+
+  scene_free(scene);
+  render_set_backend(NULL);
+  render_backend_free(backend);
+}
+
+void test_image_rect() {
+  render_backend_t *backend = raster_backend_init(WIDTH, HEIGHT, MIN, MAX);
+  render_set_backend(backend);
+  scene_t *scene = scene_init();
+  body_t *body1 = body_init_with_polygon(make_circ_polygon(10, 20), 1,
+                                         (rgb_color_t){0, 0, 0}, NULL, NULL,
+                                         "assets/sprite.png");
+  body_set_centroid(body1, (vector_t){50, 50});
+  body_t *body2 = body_init_with_polygon(make_circ_polygon(10, 20), 1,
+                                         (rgb_color_t){0, 0, 0}, NULL, NULL,
+                                         "assets/sprite.png");
+  body_set_centroid(body2, (vector_t){150, 50});
+  assert(body_get_image(body1) == body_get_image(body2));
+  scene_add_body(scene, body1);
+  scene_add_body(scene, body2);
+  render_scene(scene);
+  // Both bodies are drawn as their bounding boxes in the same color,
+  // so a circle's corners are filled too
+  const uint8_t *corner = get_pixel(backend, 21, 21);
+  assert(memcmp(corner, get_pixel(backend, 25, 25), 4) == 0);
+  assert(memcmp(corner, get_pixel(backend, 71, 21), 4) == 0);
+  assert(!pixel_is(backend, 21, 21, 255, 255, 255));
+
+  scene_free(scene);
+  render_set_backend(NULL);
+  render_backend_free(backend);
+}
+
+void test_write_ppm() {
+  render_backend_t *backend = raster_backend_init(WIDTH, HEIGHT, MIN, MAX);
+  render_set_backend(backend);
+  scene_t *scene = scene_init();
+  render_scene(scene);
+  const char *filename = "raster_test.ppm";
+  assert(raster_backend_write_ppm(backend, filename));
+
+  FILE *file = fopen(filename, "rb");
+  assert(file);
+  size_t width, height, max_value;
+  assert(fscanf(file, "P6 %zu %zu %zu", &width, &height, &max_value) == 3);
+  assert(width == WIDTH && height == HEIGHT && max_value == 255);
+  assert(fgetc(file) == '\n');
+  uint8_t pixel[3];
+  assert(fread(pixel, 1, 3, file) == 3);
+  // The top left pixel is on the boundary
+  assert(pixel[0] == 0 && pixel[1] == 0 && pixel[2] == 0);
+  fseek(file, 0, SEEK_END);
+  assert((size_t)ftell(file) == strlen("P6\n100 50\n255\n") + 3 * 100 * 50);
+  fclose(file);
+  remove(filename);
+
+  scene_free(scene);
+  render_set_backend(NULL);
+  render_backend_free(backend);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_polygon)
+  DO_TEST(test_concave_polygon)
+  DO_TEST(test_image_rect)
+  DO_TEST(test_write_ppm)
+
+  puts("raster_backend_test PASS");
+}
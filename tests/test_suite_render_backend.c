@@ -0,0 +1,129 @@
+#include "../include/render_backend.h"
+#include "../include/scene.h"
+#include "../include/shapes.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+// Images handed out by the recording backend below
+struct image {
+  size_t refcount;
+};
+
+image_t *recording_acquire_image(void *aux, const char *image_filename) {
+  image_t *image = aux;
+  image->refcount++;
+  return image;
+}
+
+void recording_retain_image(void *aux, image_t *image) { image->refcount++; }
+
+void recording_release_image(void *aux, image_t *image) {
+  assert(image->refcount > 0);
+  image->refcount--;
+}
+
+void recording_render_scene(void *aux, scene_t *scene) {}
+
+void test_no_backend() {
+  render_set_backend(NULL);
+  body_t *body = body_init_with_polygon(make_rect_polygon(1, 1), 1,
+                                        (rgb_color_t){0, 0, 0}, NULL, NULL,
+                                        "assets/missing.png");
+  assert(body_get_image(body) == NULL);
+  scene_t *scene = scene_init();
+  scene_add_body(scene, body);
+  render_scene(scene);
+  scene_free(scene);
+}
+
+void test_null_backend() {
+  render_backend_t *backend = null_backend_init();
+  render_set_backend(backend);
+  assert(render_get_backend() == backend);
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < 3; i++) {
+    scene_add_body(scene, body_init_with_polygon(make_rect_polygon(1, 1), 1,
+                                                 (rgb_color_t){0, 0, 0}, NULL,
+                                                 NULL, "assets/missing.png"));
+  }
+  for (size_t i = 0; i < 10; i++) {
+    scene_tick(scene, 0.01);
+    render_scene(scene);
+  }
+  assert(null_backend_frames(backend) == 10);
+  assert(null_backend_bodies_drawn(backend) == 30);
+  scene_free(scene);
+  render_set_backend(NULL);
+  render_backend_free(backend);
+}
+
+void test_image_references() {
+  image_t image = {0};
+  render_backend_t backend = {.acquire_image = recording_acquire_image,
+                              .retain_image = recording_retain_image,
+                              .release_image = recording_release_image,
+                              .render_scene = recording_render_scene,
+                              .aux = &image,
+                              .aux_freer = NULL};
+  render_set_backend(&backend);
+  body_t *body1 = body_init_with_polygon(make_rect_polygon(1, 1), 1,
+                                         (rgb_color_t){0, 0, 0}, NULL, NULL,
+                                         "assets/image.png");
+  assert(body_get_image(body1) == &image);
+  assert(image.refcount == 1);
+  body_t *body2 = body_init(make_rect_shape(1, 1), 1, (rgb_color_t){0, 0, 0});
+  body_set_image(body2, body_get_image(body1));
+  assert(image.refcount == 2);
+  body_free(body1);
+  assert(image.refcount == 1);
+  body_set_image(body2, NULL);
+  assert(image.refcount == 0);
+  body_free(body2);
+  render_set_backend(NULL);
+}
+
+void counting_play_sound(void *aux, const char *sound_filename) {
+  (*(int *)aux)++;
+}
+
+void test_sounds() {
+  // Without a backend, or with a silent one, playing a sound does nothing
+  render_set_backend(NULL);
+  render_preload_sound("assets/sounds/portal.wav");
+  render_play_sound("assets/sounds/portal.wav");
+  render_backend_t *null_backend = null_backend_init();
+  render_set_backend(null_backend);
+  render_preload_sound("assets/sounds/portal.wav");
+  render_play_sound("assets/sounds/portal.wav");
+  render_set_backend(NULL);
+  render_backend_free(null_backend);
+
+  int num_played = 0;
+  render_backend_t backend = {.render_scene = recording_render_scene,
+                              .play_sound = counting_play_sound,
+                              .aux = &num_played};
+  render_set_backend(&backend);
+  render_preload_sound("assets/sounds/portal.wav");
+  render_play_sound("assets/sounds/portal.wav");
+  render_play_sound("assets/sounds/portal.wav");
+  assert(num_played == 2);
+  render_set_backend(NULL);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_no_backend)
+  DO_TEST(test_null_backend)
+  DO_TEST(test_image_references)
+  DO_TEST(test_sounds)
+
+  puts("render_backend_test PASS");
+}
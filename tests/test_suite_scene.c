@@ -230,6 +230,274 @@ void test_reaping() {
   scene_free(scene);
 }
 
+void count_forced(void *aux) { (*(int *)aux)++; }
+
+void test_reaping_many() {
+  const int NUM_BODIES = 100;
+  scene_t *scene = scene_init();
+  int *counts = calloc(NUM_BODIES, sizeof(int));
+  for (int i = 0; i < NUM_BODIES; i++) {
+    body_t *body = body_init(make_shape(), i + 1, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, body);
+    list_t *bodies = list_init(1, NULL);
+    list_add(bodies, body);
+    scene_add_bodies_force_creator(scene, count_forced, &counts[i], bodies,
+                                   NULL);
+  }
+  // Remove every third body in one tick
+  for (int i = 0; i < NUM_BODIES; i += 3) {
+    scene_remove_body(scene, i);
+  }
+  scene_tick(scene, 1);
+  scene_tick(scene, 1);
+
+  // The survivors keep their order and their forces
+  size_t index = 0;
+  for (int i = 0; i < NUM_BODIES; i++) {
+    if (i % 3 == 0) {
+      assert(counts[i] == 1);
+    } else {
+      assert(body_get_mass(scene_get_body(scene, index)) == i + 1);
+      assert(counts[i] == 2);
+      index++;
+    }
+  }
+  assert(scene_bodies(scene) == index);
+  free(counts);
+  scene_free(scene);
+}
+
+// Tests that forces shared between bodies are removed with the first of them
+void test_reaping_shared_forces() {
+  const int NUM_BODIES = 60;
+  scene_t *scene = scene_init();
+  int *counts = calloc(NUM_BODIES, sizeof(int));
+  for (int i = 0; i < NUM_BODIES; i++) {
+    scene_add_body(scene, body_init(make_shape(), 1, (rgb_color_t){0, 0, 0}));
+  }
+  // Force i acts on bodies i and i + 1, wrapping around
+  for (int i = 0; i < NUM_BODIES; i++) {
+    list_t *bodies = list_init(2, NULL);
+    list_add(bodies, scene_get_body(scene, i));
+    list_add(bodies, scene_get_body(scene, (i + 1) % NUM_BODIES));
+    scene_add_bodies_force_creator(scene, count_forced, &counts[i], bodies,
+                                   NULL);
+  }
+
+  // Removing body 10 kills forces 9 and 10
+  scene_remove_body(scene, 10);
+  scene_tick(scene, 1);
+  // Removing body 11 afterwards kills only force 11
+  scene_remove_body(scene, 10);
+  scene_tick(scene, 1);
+  // Removing neighbors together kills each shared force once
+  scene_remove_body(scene, 20);
+  scene_remove_body(scene, 21);
+  scene_tick(scene, 1);
+  scene_tick(scene, 1);
+
+  for (int i = 0; i < NUM_BODIES; i++) {
+    int expected = 4;
+    if (i == 9 || i == 10) {
+      expected = 1;
+    } else if (i == 11) {
+      expected = 2;
+    } else if (i >= 21 && i <= 23) {
+      expected = 3;
+    }
+    assert(counts[i] == expected);
+  }
+  assert(scene_bodies(scene) == (size_t)NUM_BODIES - 4);
+  free(counts);
+  scene_free(scene);
+}
+
+/** Adds up the time passed to a tick handler */
+void sum_tick_time(void *aux, double dt) { *(double *)aux += dt; }
+
+void test_fixed_timestep() {
+  const double DT = 0.01;
+  scene_t *scene = scene_init();
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_velocity(body, (vector_t){1, 0});
+  scene_add_body(scene, body);
+  int ticks = 0;
+  scene_add_bodies_force_creator(scene, count_forced, &ticks,
+                                 list_init(0, NULL), NULL);
+
+  // Without a fixed timestep, each frame is one tick
+  double handled_time = 0;
+  assert(scene_advance(scene, 0.025, sum_tick_time, &handled_time) == 1);
+  assert(ticks == 1);
+  assert(handled_time == 0.025);
+  assert(scene_get_interpolation_alpha(scene) == 1);
+
+  // Frame times accumulate into whole ticks,
+  // and the tick handler only ever sees whole ticks
+  scene_set_fixed_timestep(scene, DT, 4);
+  handled_time = 0;
+  assert(scene_advance(scene, 0.025, sum_tick_time, &handled_time) == 2);
+  assert(ticks == 3);
+  assert(fabs(handled_time - 2 * DT) < 1e-12);
+  assert(fabs(scene_get_interpolation_alpha(scene) - 0.5) < 1e-9);
+  assert(scene_advance(scene, 0.004, sum_tick_time, &handled_time) == 0);
+  assert(fabs(handled_time - 2 * DT) < 1e-12);
+  assert(fabs(scene_get_interpolation_alpha(scene) - 0.9) < 1e-9);
+  assert(scene_advance(scene, 0.002, NULL, NULL) == 1);
+  assert(ticks == 4);
+  assert(vec_isclose(body_get_centroid(body), (vector_t){0.025 + 3 * DT, 0}));
+
+  // A long frame takes at most max_substeps ticks and drops the rest
+  handled_time = 0;
+  assert(scene_advance(scene, 1, sum_tick_time, &handled_time) == 4);
+  assert(ticks == 8);
+  assert(fabs(handled_time - 4 * DT) < 1e-12);
+  double alpha = scene_get_interpolation_alpha(scene);
+  assert(0 <= alpha && alpha < 1);
+  scene_free(scene);
+}
+
+void test_snapshot_restore() {
+  scene_t *scene = scene_init();
+  body_t *body1 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_t *body2 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(body1, (vector_t){1, 2});
+  scene_add_body(scene, body1);
+  scene_add_body(scene, body2);
+  scene_snapshot_t *snapshot = scene_snapshot(scene);
+
+  // Move, turn, and hide the bodies, and add another
+  body_set_velocity(body1, (vector_t){3, 0});
+  body_set_rotation(body1, M_PI / 2);
+  body_set_visibility(body2, false);
+  scene_tick(scene, 1);
+  body_t *body3 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, body3);
+
+  assert(scene_restore(scene, snapshot));
+  assert(vec_isclose(body_get_centroid(body1), (vector_t){1, 2}));
+  assert(vec_isclose(body_get_velocity(body1), VEC_ZERO));
+  assert(body_get_rotation(body1) == 0);
+  list_t *shape = body_get_shape(body1);
+  assert(vec_isclose(*(vector_t *)list_get(shape, 0), (vector_t){0, 1}));
+  list_free(shape);
+  assert(body_get_is_visible(body2));
+  assert(body_is_removed(body3));
+  scene_tick(scene, 0);
+  assert(scene_bodies(scene) == 2);
+
+  // A snapshot can be restored again
+  body_set_velocity(body2, (vector_t){0, 1});
+  scene_tick(scene, 1);
+  assert(scene_restore(scene, snapshot));
+  assert(vec_isclose(body_get_centroid(body2), VEC_ZERO));
+
+  // Once a saved body is freed, the scene can't be restored
+  scene_remove_body(scene, 0);
+  scene_tick(scene, 0);
+  assert(!scene_restore(scene, snapshot));
+  assert(scene_bodies(scene) == 1);
+  assert(scene_get_body(scene, 0) == body2);
+
+  scene_snapshot_free(snapshot);
+  scene_free(scene);
+}
+
+void count_pairs(body_t *body1, body_t *body2, void *aux) {
+  (*(int *)aux)++;
+}
+
+void test_broad_phase_sees_moved_bodies() {
+  for (int broad_phase = 0; broad_phase < 2; broad_phase++) {
+    scene_t *scene = scene_init();
+    if (broad_phase == 0) {
+      scene_enable_spatial_hash(scene, 1);
+    } else {
+      scene_enable_sweep_prune(scene);
+    }
+    body_t *body1 = make_rect_body((vector_t){0, 0}, 1, 1);
+    body_t *body2 = make_rect_body((vector_t){10, 0}, 1, 1);
+    scene_add_body(scene, body1);
+    scene_add_body(scene, body2);
+    int num_pairs = 0;
+    scene_for_each_pair(scene, count_pairs, &num_pairs);
+    assert(num_pairs == 0);
+
+    // Moving a body within a tick, as a force creator might,
+    // is seen by the next search without waiting for the tick to end
+    body_set_centroid(body2, (vector_t){0.5, 0});
+    scene_for_each_pair(scene, count_pairs, &num_pairs);
+    assert(num_pairs == 1);
+    num_pairs = 0;
+    body_set_rotation_around_point(body2, M_PI, (vector_t){5, 0});
+    scene_for_each_pair(scene, count_pairs, &num_pairs);
+    assert(num_pairs == 0);
+    scene_free(scene);
+  }
+}
+
+void test_body_store() {
+  const size_t NUM_BODIES = 101;
+  const double DT = 0.1;
+  scene_t *scene = scene_init();
+  body_t *alone[NUM_BODIES];
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    // Give each body a different mass, position, velocity, and push,
+    // with some bodies that can't be pushed
+    double mass = i % 10 == 0 ? INFINITY : i + 1;
+    body_t *body = body_init(make_shape(), mass, (rgb_color_t){0, 0, 0});
+    alone[i] = body_init(make_shape(), mass, (rgb_color_t){0, 0, 0});
+    vector_t centroid = {i, -(double)i};
+    vector_t velocity = {1, i};
+    body_set_centroid(body, centroid);
+    body_set_centroid(alone[i], centroid);
+    body_set_velocity(body, velocity);
+    body_set_velocity(alone[i], velocity);
+    scene_add_body(scene, body);
+    body_add_force(body, (vector_t){i, 2});
+    body_add_force(alone[i], (vector_t){i, 2});
+    body_add_impulse(body, (vector_t){-1, i});
+    body_add_impulse(alone[i], (vector_t){-1, i});
+  }
+
+  // Ticking the scene moves its bodies exactly like body_tick()
+  scene_tick(scene, DT);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    body_t *body = scene_get_body(scene, i);
+    body_tick(alone[i], DT);
+    assert(vec_equal(body_get_centroid(body), body_get_centroid(alone[i])));
+    assert(vec_equal(body_get_velocity(body), body_get_velocity(alone[i])));
+    list_t *shape = body_get_shape(body);
+    list_t *expected_shape = body_get_shape(alone[i]);
+    for (size_t j = 0; j < list_size(shape); j++) {
+      assert(vec_isclose(*(vector_t *)list_get(shape, j),
+                         *(vector_t *)list_get(expected_shape, j)));
+    }
+    list_free(shape);
+    list_free(expected_shape);
+  }
+
+  // Bodies keep their positions when removed bodies are reaped
+  for (size_t i = 0; i < NUM_BODIES; i += 3) {
+    scene_remove_body(scene, i);
+  }
+  scene_tick(scene, DT);
+  size_t index = 0;
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    if (i % 3 == 0) {
+      body_free(alone[i]);
+      continue;
+    }
+    body_tick(alone[i], DT);
+    body_t *body = scene_get_body(scene, index++);
+    assert(vec_equal(body_get_centroid(body), body_get_centroid(alone[i])));
+    assert(vec_equal(body_get_velocity(body), body_get_velocity(alone[i])));
+    body_free(alone[i]);
+  }
+  assert(index == scene_bodies(scene));
+  scene_free(scene);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -244,6 +512,12 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_force_creator)
   DO_TEST(test_force_creator_aux)
   DO_TEST(test_reaping)
+  DO_TEST(test_reaping_many)
+  DO_TEST(test_reaping_shared_forces)
+  DO_TEST(test_fixed_timestep)
+  DO_TEST(test_snapshot_restore)
+  DO_TEST(test_broad_phase_sees_moved_bodies)
+  DO_TEST(test_body_store)
 
   puts("scene_test PASS");
 }
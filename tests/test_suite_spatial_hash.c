@@ -0,0 +1,104 @@
+#include "../include/spatial_hash.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define NUM_BODIES 60
+
+// Small boxes, a few long ones, and one far too big to bin
+void make_bodies(body_t *bodies[NUM_BODIES]) {
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    vector_t center = {rand_range(-20, 20), rand_range(-20, 20)};
+    double width = i % 10 == 0 ? 30 : rand_range(0.5, 3);
+    double height = rand_range(0.5, 3);
+    if (i == NUM_BODIES - 1) {
+      width = height = 1e6;
+    }
+    bodies[i] = make_rect_body(center, width, height);
+  }
+}
+
+void test_pairs_match_brute_force() {
+  srand(1);
+  body_t *bodies[NUM_BODIES];
+  make_bodies(bodies);
+  spatial_hash_t *hash = spatial_hash_init(2);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    spatial_hash_insert(hash, bodies[i]);
+  }
+  assert(spatial_hash_size(hash) == NUM_BODIES);
+
+  pair_counts_t *pair_counts = pair_counts_init(bodies, NUM_BODIES);
+  spatial_hash_for_each_pair(hash, count_pair, pair_counts);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    for (size_t j = i + 1; j < NUM_BODIES; j++) {
+      bool overlaps =
+          aabb_overlaps(body_get_bounds(bodies[i]), body_get_bounds(bodies[j]));
+      assert(pair_counts_get(pair_counts, i, j) == (overlaps ? 1 : 0));
+    }
+  }
+
+  pair_counts_free(pair_counts);
+  spatial_hash_free(hash);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    body_free(bodies[i]);
+  }
+}
+
+void test_query_matches_brute_force() {
+  srand(2);
+  body_t *bodies[NUM_BODIES];
+  make_bodies(bodies);
+  spatial_hash_t *hash = spatial_hash_init(2);
+  list_t *results = list_init(NUM_BODIES, NULL);
+
+  // Rebuilding after a clear should give the same answers
+  for (int round = 0; round < 2; round++) {
+    spatial_hash_clear(hash);
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+      spatial_hash_insert(hash, bodies[i]);
+    }
+    for (int q = 0; q < 50; q++) {
+      vector_t min = {rand_range(-25, 20), rand_range(-25, 20)};
+      vector_t size = {rand_range(0, q < 40 ? 8 : 200), rand_range(0, 8)};
+      aabb_t query = {min, vec_add(min, size)};
+
+      while (list_size(results) > 0) {
+        list_remove(results, 0);
+      }
+      spatial_hash_query(hash, query, results);
+      bool found[NUM_BODIES] = {false};
+      for (size_t i = 0; i < list_size(results); i++) {
+        size_t index = find_body_index(bodies, NUM_BODIES,
+                                       list_get(results, i));
+        assert(!found[index]);
+        found[index] = true;
+      }
+      for (size_t i = 0; i < NUM_BODIES; i++) {
+        assert(found[i] == aabb_overlaps(query, body_get_bounds(bodies[i])));
+      }
+    }
+  }
+
+  list_free(results);
+  spatial_hash_free(hash);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    body_free(bodies[i]);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_pairs_match_brute_force)
+  DO_TEST(test_query_matches_brute_force)
+
+  puts("spatial_hash_test PASS");
+}
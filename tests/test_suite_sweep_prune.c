@@ -0,0 +1,149 @@
+#include "../include/sweep_prune.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define NUM_BODIES 40
+
+// Checks the reported pairs against every pair of tracked bodies
+void check_pairs(sweep_prune_t *sap, body_t *bodies[NUM_BODIES],
+                 bool tracked[NUM_BODIES]) {
+  pair_counts_t *pair_counts = pair_counts_init(bodies, NUM_BODIES);
+  sweep_prune_for_each_pair(sap, count_pair, pair_counts);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    for (size_t j = i + 1; j < NUM_BODIES; j++) {
+      bool overlaps = tracked[i] && tracked[j] &&
+                      aabb_overlaps(body_get_bounds(bodies[i]),
+                                    body_get_bounds(bodies[j]));
+      assert(pair_counts_get(pair_counts, i, j) == (overlaps ? 1 : 0));
+    }
+  }
+  pair_counts_free(pair_counts);
+}
+
+void test_pairs_follow_movement() {
+  srand(3);
+  body_t *bodies[NUM_BODIES];
+  bool tracked[NUM_BODIES];
+  sweep_prune_t *sap = sweep_prune_init();
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    vector_t center = {rand_range(-20, 20), rand_range(-5, 5)};
+    bodies[i] = make_rect_body(center, rand_range(0.5, 4), rand_range(0.5, 4));
+    body_set_velocity(bodies[i], (vector_t){rand_range(-3, 3), 0});
+    sweep_prune_add(sap, bodies[i]);
+    tracked[i] = true;
+  }
+  assert(sweep_prune_size(sap) == NUM_BODIES);
+
+  for (int tick = 0; tick < 100; tick++) {
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+      body_tick(bodies[i], 0.1);
+    }
+    // Occasionally drop a body and add it back later
+    size_t toggled = rand() % NUM_BODIES;
+    if (tracked[toggled]) {
+      sweep_prune_remove(sap, bodies[toggled]);
+    } else {
+      sweep_prune_add(sap, bodies[toggled]);
+    }
+    tracked[toggled] = !tracked[toggled];
+
+    sweep_prune_update(sap);
+    check_pairs(sap, bodies, tracked);
+  }
+
+  sweep_prune_free(sap);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    body_free(bodies[i]);
+  }
+}
+
+void test_remove_marked() {
+  srand(5);
+  body_t *bodies[NUM_BODIES];
+  bool tracked[NUM_BODIES];
+  sweep_prune_t *sap = sweep_prune_init();
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    vector_t center = {rand_range(-10, 10), rand_range(-5, 5)};
+    bodies[i] = make_rect_body(center, rand_range(0.5, 4), rand_range(0.5, 4));
+    sweep_prune_add(sap, bodies[i]);
+    tracked[i] = true;
+  }
+  sweep_prune_update(sap);
+
+  // Marked bodies stay tracked until they are swept out together
+  for (size_t i = 0; i < NUM_BODIES; i += 4) {
+    body_remove(bodies[i]);
+  }
+  check_pairs(sap, bodies, tracked);
+  sweep_prune_remove_marked(sap);
+  for (size_t i = 0; i < NUM_BODIES; i += 4) {
+    tracked[i] = false;
+  }
+  assert(sweep_prune_size(sap) == NUM_BODIES - NUM_BODIES / 4);
+  check_pairs(sap, bodies, tracked);
+  sweep_prune_update(sap);
+  check_pairs(sap, bodies, tracked);
+
+  sweep_prune_free(sap);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    body_free(bodies[i]);
+  }
+}
+
+void test_query() {
+  srand(4);
+  body_t *bodies[NUM_BODIES];
+  sweep_prune_t *sap = sweep_prune_init();
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    vector_t center = {rand_range(-20, 20), rand_range(-20, 20)};
+    bodies[i] = make_rect_body(center, rand_range(0.5, 4), rand_range(0.5, 4));
+    sweep_prune_add(sap, bodies[i]);
+  }
+  sweep_prune_update(sap);
+
+  list_t *results = list_init(NUM_BODIES, NULL);
+  for (int q = 0; q < 50; q++) {
+    vector_t min = {rand_range(-25, 20), rand_range(-25, 20)};
+    vector_t size = {rand_range(0, 10), rand_range(0, 10)};
+    aabb_t query = {min, vec_add(min, size)};
+
+    while (list_size(results) > 0) {
+      list_remove(results, 0);
+    }
+    sweep_prune_query(sap, query, results);
+    bool found[NUM_BODIES] = {false};
+    for (size_t i = 0; i < list_size(results); i++) {
+      size_t index = find_body_index(bodies, NUM_BODIES,
+                                     list_get(results, i));
+      assert(!found[index]);
+      found[index] = true;
+    }
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+      assert(found[i] == aabb_overlaps(query, body_get_bounds(bodies[i])));
+    }
+  }
+
+  list_free(results);
+  sweep_prune_free(sap);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    body_free(bodies[i]);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_pairs_follow_movement)
+  DO_TEST(test_remove_marked)
+  DO_TEST(test_query)
+
+  puts("sweep_prune_test PASS");
+}
@@ -73,6 +73,10 @@ void test_vec_rotate() {
                      (vector_t){4, 3}));
   // Rotate (0, 0)
   assert(vec_isclose(vec_rotate(VEC_ZERO, 1.0), VEC_ZERO));
+  // A precomputed rotation gives exactly the same result
+  rotation_t rotation = rotation_from_angle(0.3);
+  assert(vec_equal(vec_rotate_by((vector_t){5, 7}, rotation),
+                   vec_rotate((vector_t){5, 7}, 0.3)));
 }
 
 int main(int argc, char *argv[]) {